@@ -12,6 +12,7 @@
 #include "iomanager/Receiver.hpp"
 #include "iomanager/SchemaUtils.hpp"
 #include "iomanager/Sender.hpp"
+#include "iomanager/network/NetworkManager.hpp"
 #include "opmonlib/OpMonManager.hpp"
 
 #include "confmodel/ConnectivityService.hpp"
@@ -50,15 +51,31 @@ public:
   IOManager(IOManager&&) = delete;                 ///< IOManager is not move-constructible
   IOManager& operator=(IOManager&&) = delete;      ///< IOManager is not move-assignable
 
+  /**
+   * @brief Configure queues and network connections
+   * @param warmup Optional list of network connections to resolve and connect in parallel before returning,
+   * so that the first message on each connection does not absorb the connection latency
+   */
   void configure(std::string session,
                  std::vector<const confmodel::Queue*> queues,
                  std::vector<const confmodel::NetworkConnection*> connections,
                  const confmodel::ConnectivityService* connection_service,
-                 opmonlib::OpMonManager&);
+                 opmonlib::OpMonManager&,
+                 ConnectionWarmup const& warmup = ConnectionWarmup());
 
   void reset();
   void shutdown();
 
+  /**
+   * @brief Set options (e.g. message coalescing) for network connections matching pattern
+   *
+   * Applies to Senders and Receivers created after the call; see NetworkManager::set_connection_options.
+   */
+  void set_connection_options(ConnectionId const& pattern, ConnectionOptions const& options)
+  {
+    NetworkManager::get().set_connection_options(pattern, options);
+  }
+
   template<typename Datatype>
   std::shared_ptr<SenderConcept<Datatype>> get_sender(ConnectionId id);
 
@@ -85,14 +102,24 @@ public:
 
   std::set<std::string> get_datatypes(std::string const& uid);
 
+  /**
+   * @brief Per-connection setup times measured by the warm-up phase of the last configure
+   */
+  std::vector<WarmupResult> get_warmup_results() const { return m_warmup_results; }
+
 private:
   IOManager() {}
 
+  // How long shutdown and reset wait for each Sender to send held-back messages
+  static constexpr Sender::timeout_t s_shutdown_flush_timeout{ 100 };
+  void flush_senders();
+
   using SenderMap = std::map<ConnectionId, std::shared_ptr<Sender>>;
   using ReceiverMap = std::map<ConnectionId, std::shared_ptr<Receiver>>;
   SenderMap m_senders;
   ReceiverMap m_receivers;
   std::string m_session;
+  std::vector<WarmupResult> m_warmup_results;
 
   static std::shared_ptr<IOManager> s_instance;
 };
@@ -0,0 +1,141 @@
+/**
+ * @file Instrumentation.hpp
+ *
+ * Probe points on the hot paths of Senders and Receivers, selected at build time
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_INSTRUMENTATION_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_INSTRUMENTATION_HPP_
+
+#include "opmonlib/MonitorableObject.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/**
+ * Instrumentation level, set by the CMake option IOMANAGER_INSTRUMENTATION:
+ * 0 ("none") compiles the probes away, 1 ("counters") counts probe hits and amounts, 2 ("tracing")
+ * additionally fires a static USDT probe, provider "iomanager", for perf, bpftrace or SystemTap.
+ */
+#ifndef IOMANAGER_INSTRUMENTATION_LEVEL
+#define IOMANAGER_INSTRUMENTATION_LEVEL 0
+#endif
+
+#if IOMANAGER_INSTRUMENTATION_LEVEL >= 2
+#include <sys/sdt.h>
+#endif
+
+namespace dunedaq::iomanager {
+
+enum class InstrumentationLevel
+{
+  kNone,
+  kCounters,
+  kTracing,
+};
+
+constexpr InstrumentationLevel s_instrumentation_level =
+  static_cast<InstrumentationLevel>(IOMANAGER_INSTRUMENTATION_LEVEL);
+
+/**
+ * Probe points. Each probe has two arguments, the uid of the connection and an amount: elements
+ * for queue_push and queue_pop, serialized bytes for sender_send and receiver_receive, and
+ * nanoseconds spent in the callback for callback_invoke.
+ */
+constexpr std::array<std::string_view, 5> s_probe_names = {
+  "queue_push", "queue_pop", "sender_send", "receiver_receive", "callback_invoke"
+};
+
+constexpr size_t
+get_probe_index(std::string_view name)
+{
+  for (size_t ii = 0; ii < s_probe_names.size(); ++ii) {
+    if (s_probe_names[ii] == name) {
+      return ii;
+    }
+  }
+  return s_probe_names.size();
+}
+
+/**
+ * @brief Hits and amounts of every probe point in the process, published in opmon by IOManager under "probes"
+ *
+ * Threads add to one of s_shards cache-line-aligned copies of the counters, like NetworkMetrics.
+ */
+class ProbeCounters : public opmonlib::MonitorableObject
+{
+public:
+  static std::shared_ptr<ProbeCounters> const& get()
+  {
+    static const std::shared_ptr<ProbeCounters> s_instance = std::make_shared<ProbeCounters>();
+    return s_instance;
+  }
+
+  template<size_t Probe>
+  void count(uint64_t amount)
+  {
+    static_assert(Probe < s_probe_names.size(), "Unknown probe point");
+    auto& shard = m_shards[get_thread_shard()];
+    shard.hits[Probe].fetch_add(1, std::memory_order_relaxed);
+    shard.amounts[Probe].fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  uint64_t get_hits(size_t probe) const;
+
+protected:
+  void generate_opmon_data() override;
+
+private:
+  static constexpr size_t s_shards = 16;
+
+  struct alignas(64) Shard
+  {
+    std::array<std::atomic<uint64_t>, s_probe_names.size()> hits{};
+    std::array<std::atomic<uint64_t>, s_probe_names.size()> amounts{};
+  };
+
+  static size_t get_thread_shard()
+  {
+    static std::atomic<size_t> s_next_shard{ 0 };
+    thread_local size_t shard = s_next_shard.fetch_add(1, std::memory_order_relaxed) % s_shards;
+    return shard;
+  }
+
+  std::array<Shard, s_shards> m_shards{};
+};
+
+} // namespace dunedaq::iomanager
+
+#if IOMANAGER_INSTRUMENTATION_LEVEL >= 2
+#define IOMANAGER_PROBE_SDT(name, uid, amount) DTRACE_PROBE2(iomanager, name, (uid).c_str(), amount)
+#else
+#define IOMANAGER_PROBE_SDT(name, uid, amount)
+#endif
+
+/**
+ * IOMANAGER_PROBE(name, uid, amount) marks a probe point; name is one of s_probe_names, uid a
+ * std::string. The amount is evaluated once, and with level "none" no argument is evaluated.
+ */
+#if IOMANAGER_INSTRUMENTATION_LEVEL >= 1
+#define IOMANAGER_PROBE(name, uid, amount)                                                                             \
+  do {                                                                                                                 \
+    const auto iomanager_probe_amount = static_cast<uint64_t>(amount);                                                 \
+    ::dunedaq::iomanager::ProbeCounters::get()->count<::dunedaq::iomanager::get_probe_index(#name)>(                   \
+      iomanager_probe_amount);                                                                                         \
+    IOMANAGER_PROBE_SDT(name, uid, iomanager_probe_amount);                                                            \
+  } while (0)
+#else
+#define IOMANAGER_PROBE(name, uid, amount)                                                                             \
+  do {                                                                                                                 \
+  } while (0)
+#endif
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_INSTRUMENTATION_HPP_
@@ -126,7 +126,7 @@ get_uri_for_connection(const confmodel::NetworkConnection* netCon)
         }
       }
       uri = std::string(service->get_protocol() + "://" + ipaddr + ":" + port);
-    } else if (service->get_protocol() == "inproc") {
+    } else if (service->get_protocol() == "inproc" || service->get_protocol() == "shm") {
       uri = std::string(service->get_protocol() + "://" + service->get_path());
     }
   }
@@ -15,6 +15,9 @@
 #include "logging/Logging.hpp"
 #include "utilities/NamedObject.hpp"
 
+#include <cstddef>
+#include <optional>
+
 namespace dunedaq::iomanager {
 
 // Typeless
@@ -34,6 +37,12 @@ public:
 
   ConnectionId id() const { return m_conn; }
 
+  // Send any messages the implementation is holding back (e.g. for coalescing)
+  virtual void flush(timeout_t /*timeout*/) {} // NOLINT
+
+  // Number of messages which can be sent without waiting for flow control credit, if flow controlled
+  virtual std::optional<size_t> available_credit() { return std::nullopt; }
+
 protected:
   ConnectionId m_conn;
 };
@@ -0,0 +1,161 @@
+/**
+ * @file TraceContext.hpp
+ *
+ * Context of a traced message, carried across network and queue hops
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_TRACECONTEXT_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_TRACECONTEXT_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Identity and timing of a sampled message, see "Message tracing" in the documentation
+ *
+ * Timestamps are nanoseconds since the epoch of the system clock, so that they can be compared
+ * between hosts. hops holds the time of each network send of the message, oldest first; once
+ * s_max_hops have been recorded the oldest ones are dropped.
+ */
+struct TraceContext
+{
+  static constexpr uint8_t s_max_hops = 16;
+
+  uint64_t trace_id{ 0 }; // 0 if the message is not traced
+  uint64_t origin_ns{ 0 };
+  uint8_t hop_count{ 0 };
+  std::array<uint64_t, s_max_hops> hops{};
+
+  bool is_active() const noexcept { return trace_id != 0; }
+
+  static uint64_t now_ns() noexcept
+  {
+    return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count());
+  }
+
+  // A new trace with a random id, originating now
+  static TraceContext start()
+  {
+    thread_local std::mt19937_64 generator{ std::random_device{}() };
+    TraceContext context;
+    while (context.trace_id == 0) {
+      context.trace_id = generator();
+    }
+    context.origin_ns = now_ns();
+    return context;
+  }
+
+  void add_hop(uint64_t timestamp_ns) noexcept
+  {
+    if (hop_count == s_max_hops) {
+      std::memmove(hops.data(), hops.data() + 1, (s_max_hops - 1) * sizeof(uint64_t));
+      --hop_count;
+    }
+    hops[hop_count++] = timestamp_ns;
+  }
+
+  uint64_t last_hop_ns() const noexcept { return hop_count == 0 ? origin_ns : hops[hop_count - 1]; }
+};
+
+/**
+ * @brief Whether a data type carries its trace context in a member named trace_context
+ *
+ * Queues hand over the objects themselves rather than serialized messages, so a trace can only
+ * follow a message through a queue if its type has such a member. Senders fill it in from the
+ * current trace of the sending thread, and receivers make it the current trace of the receiving
+ * thread. Network Receivers also fill it in for the traced messages they deserialize. The
+ * member does not need to be serialized.
+ */
+template<typename T, typename = void>
+struct has_trace_context : std::false_type
+{};
+
+template<typename T>
+struct has_trace_context<T, std::void_t<decltype(std::declval<T&>().trace_context)>>
+  : std::is_same<std::decay_t<decltype(std::declval<T&>().trace_context)>, TraceContext>
+{};
+
+namespace detail {
+
+// Trace of the message most recently received on this thread, continued by the thread's sends
+inline thread_local TraceContext t_current_trace;
+
+} // namespace detail
+
+inline TraceContext const&
+get_current_trace() noexcept
+{
+  return detail::t_current_trace;
+}
+
+inline void
+set_current_trace(TraceContext const& context) noexcept
+{
+  detail::t_current_trace = context;
+}
+
+// Stop continuing the trace of the last received message in this thread's sends
+inline void
+clear_current_trace() noexcept
+{
+  detail::t_current_trace.trace_id = 0;
+}
+
+// Attach the current trace of this thread to data, unless it carries one already
+template<typename T>
+inline void
+attach_current_trace(T& data) noexcept
+{
+  if constexpr (has_trace_context<T>::value) {
+    if (!data.trace_context.is_active() && detail::t_current_trace.is_active()) {
+      data.trace_context = detail::t_current_trace;
+    }
+  }
+}
+
+// Make the trace carried by data current on this thread
+template<typename T>
+inline void
+adopt_trace(T const& data) noexcept
+{
+  if constexpr (has_trace_context<T>::value) {
+    set_current_trace(data.trace_context);
+  }
+}
+
+/**
+ * @brief Make a trace current for the lifetime of the guard, restoring the previous one afterwards
+ */
+class ScopedTraceContext
+{
+public:
+  explicit ScopedTraceContext(TraceContext const& context)
+    : m_previous(detail::t_current_trace)
+  {
+    detail::t_current_trace = context;
+  }
+  ~ScopedTraceContext() { detail::t_current_trace = m_previous; }
+
+  ScopedTraceContext(ScopedTraceContext const&) = delete;
+  ScopedTraceContext& operator=(ScopedTraceContext const&) = delete;
+
+private:
+  TraceContext m_previous;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_TRACECONTEXT_HPP_
@@ -61,7 +61,9 @@ IOManager::get_receiver(ConnectionId id)
     } else {
       TLOG("IOManager") << "Creating NetworkReceiverModel for uid " << id.uid << ", datatype " << id.data_type
                         << " in session " << id.session;
-      m_receivers[id] = std::make_shared<NetworkReceiverModel<Datatype>>(id);
+      auto receiver = std::make_shared<NetworkReceiverModel<Datatype>>(id);
+      NetworkManager::get().register_receiver_model(id, receiver);
+      m_receivers[id] = receiver;
     }
   }
   return std::dynamic_pointer_cast<ReceiverConcept<Datatype>>(m_receivers[id]); // NOLINT
@@ -101,7 +103,9 @@ IOManager::get_sender(ConnectionId id)
     } else {
       TLOG("IOManager") << "Creating NetworkSenderModel for uid " << id.uid << ", datatype " << id.data_type
                         << " in session " << id.session;
-      m_senders[id] = std::make_shared<NetworkSenderModel<Datatype>>(id);
+      auto sender = std::make_shared<NetworkSenderModel<Datatype>>(id);
+      NetworkManager::get().register_sender_model(id, sender);
+      m_senders[id] = sender;
     }
   }
   return std::dynamic_pointer_cast<SenderConcept<Datatype>>(m_senders[id]);
@@ -0,0 +1,64 @@
+/**
+ * @file Backoff.hpp
+ *
+ * Exponential backoff with jitter for connection retries
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_BACKOFF_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_BACKOFF_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Delays between successive retries, doubling from initial up to max
+ *
+ * Each delay is varied by up to +/- jitter (a fraction of the delay), so that many clients
+ * retrying against the same peer, for example after it restarted, spread their attempts out
+ * instead of retrying in lockstep.
+ */
+class ExponentialBackoff
+{
+public:
+  static constexpr std::chrono::milliseconds s_default_initial{ 10 };
+  static constexpr std::chrono::milliseconds s_default_max{ 1000 };
+  static constexpr double s_default_jitter = 0.2;
+
+  explicit ExponentialBackoff(std::chrono::milliseconds initial = s_default_initial,
+                              std::chrono::milliseconds max = s_default_max,
+                              double jitter = s_default_jitter);
+
+  /**
+   * @brief The delay before the next retry; each call doubles the following one
+   */
+  std::chrono::milliseconds next();
+
+  /**
+   * @brief Start again from the initial delay, after a successful attempt
+   */
+  void reset();
+
+  /**
+   * @brief Number of delays handed out since construction or the last reset
+   */
+  size_t get_retries() const { return m_retries; }
+
+private:
+  std::chrono::milliseconds m_initial;
+  std::chrono::milliseconds m_max;
+  double m_jitter;
+  std::chrono::milliseconds m_current;
+  size_t m_retries{ 0 };
+  std::minstd_rand m_random;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_BACKOFF_HPP_
@@ -0,0 +1,108 @@
+/**
+ * @file CallbackPipeline.hpp
+ *
+ * Parallel deserialization of received messages for receive callbacks
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CALLBACKPIPELINE_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CALLBACKPIPELINE_HPP_
+
+#include "iomanager/network/ConnectionOptions.hpp"
+
+#include "ers/Issue.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Hands serialized messages to a pool of workers which decode them and invoke a callback
+ *
+ * push() is called from a single receiving thread. With preserve_order, decoded messages wait
+ * in a reorder buffer until all earlier messages have been delivered; whichever worker finds
+ * the next message ready delivers it, so the callback is never invoked concurrently. Messages
+ * which fail to decode are reported and skipped without holding up later ones. Exceptions from
+ * the decoder or the callback are passed to the error handler as ers Issues, so the error
+ * handler itself must not throw.
+ */
+template<typename Datatype>
+class CallbackPipeline
+{
+public:
+  using decoder_t = std::function<Datatype(std::vector<uint8_t>&&)>;
+  using callback_t = std::function<void(Datatype&)>;
+  using error_handler_t = std::function<void(ers::Issue const&)>;
+
+  CallbackPipeline(ReceivePipelineOptions const& options,
+                   decoder_t decoder,
+                   callback_t callback,
+                   error_handler_t error_handler);
+  ~CallbackPipeline() { stop(); }
+
+  CallbackPipeline(CallbackPipeline const&) = delete;
+  CallbackPipeline(CallbackPipeline&&) = delete;
+  CallbackPipeline& operator=(CallbackPipeline const&) = delete;
+  CallbackPipeline& operator=(CallbackPipeline&&) = delete;
+
+  /**
+   * @brief Queue a serialized message, waiting while max_in_flight messages are undelivered
+   */
+  void push(std::vector<uint8_t>&& message);
+
+  /**
+   * @brief Deliver all queued messages, then stop the workers
+   */
+  void stop();
+
+private:
+  struct WorkItem
+  {
+    uint64_t sequence;
+    std::vector<uint8_t> message;
+  };
+
+  void worker();
+  void deliver(uint64_t sequence, std::optional<Datatype>&& data);
+  void invoke(Datatype& data);
+  void release();
+
+  ReceivePipelineOptions m_options;
+  decoder_t m_decoder;
+  callback_t m_callback;
+  error_handler_t m_error_handler;
+
+  std::mutex m_queue_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_space_cv;
+  std::deque<WorkItem> m_queue;        // Protected by m_queue_mutex
+  size_t m_in_flight{ 0 };             // Protected by m_queue_mutex
+  bool m_running{ true };              // Protected by m_queue_mutex
+  uint64_t m_next_sequence{ 0 };       // Only used by the pushing thread
+
+  std::mutex m_reorder_mutex;
+  std::map<uint64_t, std::optional<Datatype>> m_reorder_buffer; // Protected by m_reorder_mutex
+  uint64_t m_next_delivery{ 0 };                                 // Protected by m_reorder_mutex
+  bool m_delivering{ false };                                    // Protected by m_reorder_mutex
+
+  std::vector<std::thread> m_workers;
+};
+
+} // namespace dunedaq::iomanager
+
+#include "detail/CallbackPipeline.hxx"
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CALLBACKPIPELINE_HPP_
@@ -0,0 +1,106 @@
+/**
+ * @file ConnectionEstablisher.hpp
+ *
+ * Background worker pool which resolves and connects network connections on
+ * behalf of the network Sender/Receiver models
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONESTABLISHER_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONESTABLISHER_HPP_
+
+#include "iomanager/network/Backoff.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief The ConnectionEstablisher accepts connection intents and works on them
+ * concurrently in a bounded pool of worker threads.
+ *
+ * An intent consists of an attempt function, which returns true once the
+ * connection has been established, and an abandon function which is called if
+ * the intent's deadline passes (or the establisher is stopped) before an attempt
+ * succeeds. Failed attempts are retried with exponential backoff, starting at the
+ * configured retry interval and growing up to the maximum retry interval.
+ * The ConnectionEstablisher does not know about ipm; NetworkManager uses it to
+ * fulfil the readiness futures handed out to the network models.
+ */
+class ConnectionEstablisher
+{
+public:
+  using clock_t = std::chrono::steady_clock;
+
+  static constexpr size_t s_default_worker_count = 4;
+  static constexpr std::chrono::milliseconds s_default_retry_interval{ 10 };
+  static constexpr std::chrono::milliseconds s_default_max_retry_interval{ 200 };
+
+  explicit ConnectionEstablisher(size_t worker_count = s_default_worker_count,
+                                 std::chrono::milliseconds retry_interval = s_default_retry_interval,
+                                 std::chrono::milliseconds max_retry_interval = s_default_max_retry_interval);
+  ~ConnectionEstablisher() { stop(); }
+
+  ConnectionEstablisher(ConnectionEstablisher const&) = delete;
+  ConnectionEstablisher(ConnectionEstablisher&&) = delete;
+  ConnectionEstablisher& operator=(ConnectionEstablisher const&) = delete;
+  ConnectionEstablisher& operator=(ConnectionEstablisher&&) = delete;
+
+  /**
+   * @brief Queue a connection intent for the worker pool
+   * @param name Name used in log messages
+   * @param attempt Function performing one connection attempt, returns true on success
+   * @param abandon Function called if no attempt succeeded before the deadline
+   * @param give_up_after How long to keep retrying failed attempts
+   * @param delay How long to wait before the first attempt
+   */
+  void submit(std::string const& name,
+              std::function<bool()> attempt,
+              std::function<void()> abandon,
+              std::chrono::milliseconds give_up_after,
+              std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+
+  /**
+   * @brief Stop the worker threads and abandon all outstanding intents
+   */
+  void stop();
+
+  size_t get_worker_count() const { return m_workers.size(); }
+  size_t get_pending_count() const;
+
+private:
+  struct Intent
+  {
+    std::string name;
+    std::function<bool()> attempt;
+    std::function<void()> abandon;
+    clock_t::time_point deadline;
+    clock_t::time_point next_attempt;
+    ExponentialBackoff backoff;
+  };
+
+  void worker();
+
+  std::chrono::milliseconds m_retry_interval;
+  std::chrono::milliseconds m_max_retry_interval;
+  std::list<Intent> m_intents;
+  std::vector<std::thread> m_workers;
+  bool m_running{ true };
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONESTABLISHER_HPP_
@@ -0,0 +1,179 @@
+/**
+ * @file ConnectionOptions.hpp
+ *
+ * Optional per-connection tuning of the network Sender/Receiver models
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONOPTIONS_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONOPTIONS_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Pack small messages into batch frames on the sending side
+ *
+ * A batch is sent once it holds at least max_batch_bytes, or max_delay after its first
+ * message was added, whichever comes first. Messages which are at least max_batch_bytes
+ * on their own are sent directly.
+ */
+struct CoalescingOptions
+{
+  bool enabled{ false };
+  size_t max_batch_bytes{ 64 * 1024 };
+  std::chrono::microseconds max_delay{ 1000 };
+};
+
+enum class CompressionAlgorithm
+{
+  kNone,
+  kLZ4,  // Fast, for links which are only moderately bandwidth-bound
+  kZstd, // Better ratio at higher CPU cost
+};
+
+inline std::string
+to_string(CompressionAlgorithm algorithm)
+{
+  switch (algorithm) {
+    case CompressionAlgorithm::kLZ4:
+      return "lz4";
+    case CompressionAlgorithm::kZstd:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+/**
+ * @brief Compress outgoing messages (or batches) of at least min_size bytes
+ *
+ * The algorithm is recorded in each compressed frame, so receivers need no configuration.
+ * A level below 0 selects the algorithm's default level.
+ */
+struct CompressionOptions
+{
+  CompressionAlgorithm algorithm{ CompressionAlgorithm::kNone };
+  int level{ -1 };
+  size_t min_size{ 4096 };
+};
+
+/**
+ * @brief Hand messages to a dedicated I/O thread instead of sending them in the caller's thread
+ *
+ * send() returns once the message is queued; its timeout bounds the wait for queue space
+ * when queue_capacity messages are already waiting, and is then used by the I/O thread for
+ * the network send. Messages are serialized and sent in the order they were queued.
+ */
+struct AsyncSendOptions
+{
+  bool enabled{ false };
+  size_t queue_capacity{ 1024 };
+};
+
+/**
+ * @brief Credit-based flow control, must be enabled on both ends of a connection
+ *
+ * The receiver grants credit for window messages beyond those it has delivered; the sender
+ * only sends while it has credit, so a slow receiver makes sends time out (or producers see
+ * no credit) instead of filling the network buffers. Credits travel on a separate kSendRecv
+ * connection of data type "flow_credit_t", named credit_connection (default: the data
+ * connection's uid followed by "_credits"), which must be configured like any other
+ * connection. The receiver repeats its grant every grant_interval. Flow control assumes a
+ * single sender per connection.
+ */
+struct FlowControlOptions
+{
+  bool enabled{ false };
+  size_t window{ 1000 };
+  std::chrono::milliseconds grant_interval{ 100 };
+  std::string credit_connection;
+};
+
+/**
+ * @brief Deserialize messages for a receive callback on several threads
+ *
+ * With decode_threads > 0, the callback thread only receives; messages are deserialized by a
+ * pool of decode_threads workers. If preserve_order is set, the callback is invoked for one
+ * message at a time, in arrival order. Otherwise it is invoked concurrently from the workers, in
+ * no particular order, and must be thread-safe. At most max_in_flight messages are received
+ * but not yet delivered; beyond that, receiving pauses.
+ */
+struct ReceivePipelineOptions
+{
+  size_t decode_threads{ 0 };
+  bool preserve_order{ true };
+  size_t max_in_flight{ 1024 };
+};
+
+/**
+ * @brief Share one subscriber socket among the pub/sub receivers of the same publishers
+ *
+ * Receivers with this option whose connections resolve to the same set of publishers use a
+ * single ipm Subscriber, which receives each message once and routes it by topic to the
+ * receivers subscribed to it. Each receiver buffers up to queue_capacity messages; beyond that,
+ * its messages are dropped. Topics are matched exactly, where a subscriber of its own would
+ * also receive topics starting with a subscribed one.
+ */
+struct SubscriberSharingOptions
+{
+  bool enabled{ false };
+  size_t queue_capacity{ 1000 };
+};
+
+/**
+ * @brief Re-establishing a sender's connection after a send timed out
+ *
+ * The broken connection is replaced in the background: first after initial_backoff, then,
+ * while sends on the replacements keep failing, after twice as long each time up to
+ * max_backoff. Each delay is varied by up to +/- jitter (a fraction), so that the senders of a
+ * restarted peer do not all reconnect at once. Until the replacement is connected, sends fail
+ * immediately with ConnectionReconnecting instead of waiting for their timeout.
+ */
+struct ReconnectOptions
+{
+  std::chrono::milliseconds initial_backoff{ 10 };
+  std::chrono::milliseconds max_backoff{ 5000 };
+  double jitter{ 0.2 };
+};
+
+/**
+ * @brief Trace one in every sample_interval messages sent on the connection, 0 disables sampling
+ *
+ * Sampled messages start a new trace. Messages sent while a trace is current on the sending
+ * thread (because it was received with the message being handled) continue that trace whatever
+ * the sample interval.
+ */
+struct TracingOptions
+{
+  size_t sample_interval{ 0 };
+};
+
+/**
+ * @brief Options applied to network connections whose ConnectionId matches a pattern
+ *
+ * Coalescing, compression, asynchronous sends, reconnection and tracing are only consulted by the sending side;
+ * receivers understand every frame type. The receive pipeline only applies to receivers with
+ * a callback, subscriber sharing to pub/sub receivers. Flow control is consulted by both sides.
+ */
+struct ConnectionOptions
+{
+  CoalescingOptions coalescing;
+  CompressionOptions compression;
+  AsyncSendOptions async_send;
+  ReceivePipelineOptions receive_pipeline;
+  FlowControlOptions flow_control;
+  ReconnectOptions reconnect;
+  SubscriberSharingOptions shared_subscriber;
+  TracingOptions tracing;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_CONNECTIONOPTIONS_HPP_
@@ -0,0 +1,150 @@
+/**
+ * @file FlowControl.hpp
+ *
+ * Credit-based flow control between network senders and receivers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_FLOWCONTROL_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_FLOWCONTROL_HPP_
+
+#include "iomanager/SchemaUtils.hpp"
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/RawSerialization.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include "ipm/Receiver.hpp"
+#include "ipm/Sender.hpp"
+#include "serialization/Serialization.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace dunedaq {
+namespace iomanager {
+
+/**
+ * @brief Credit grant sent from a receiver to its sender
+ *
+ * Grants are cumulative: the sender may have sent consumed + window messages in total since
+ * the receiver (identified by epoch) was created. Lost or repeated grants are therefore harmless.
+ */
+struct FlowCredit
+{
+  uint64_t epoch;
+  uint64_t consumed;
+  uint64_t window;
+};
+
+} // namespace iomanager
+
+// Must be in dunedaq namespace only
+DUNE_DAQ_TYPESTRING(iomanager::FlowCredit, "flow_credit_t");
+DUNE_DAQ_RAW_SERIALIZABLE(iomanager::FlowCredit, 1);
+
+namespace iomanager {
+
+/**
+ * @brief The connection carrying credits for a data connection
+ */
+ConnectionId
+get_credit_connection_id(ConnectionId const& conn_id, FlowControlOptions const& options);
+
+/**
+ * @brief Receiving side of flow control: grants credits as messages are delivered
+ */
+class CreditGrantor
+{
+public:
+  CreditGrantor(ConnectionId const& conn_id, FlowControlOptions const& options);
+
+  /**
+   * @brief Whether the credit connection is configured; if not, flow control is disabled
+   */
+  bool is_enabled() const { return m_enabled; }
+
+  void on_delivered(size_t count = 1) { m_delivered += count; }
+
+  /**
+   * @brief Send a grant if a quarter of the window has been consumed or grant_interval has passed
+   *
+   * Never blocks; grants which cannot be sent yet are sent by a later call.
+   */
+  void update();
+
+private:
+  bool get_sender();
+
+  ConnectionId m_conn_id;
+  ConnectionId m_credit_conn_id;
+  FlowControlOptions m_options;
+  bool m_enabled{ false };
+  uint64_t m_epoch;
+  std::atomic<uint64_t> m_delivered{ 0 };
+
+  std::mutex m_mutex;
+  uint64_t m_last_granted{ 0 };                        // Protected by m_mutex
+  std::chrono::steady_clock::time_point m_last_grant; // Protected by m_mutex
+  bool m_granted{ false };                             // Protected by m_mutex
+  NetworkManager::SenderFuture m_sender_future;        // Protected by m_mutex
+  std::shared_ptr<ipm::Sender> m_sender;               // Protected by m_mutex
+  SerializationBuffer m_buffer;                        // Protected by m_mutex
+};
+
+/**
+ * @brief Sending side of flow control: tracks the credit granted by the receiver
+ *
+ * No messages may be sent before the first grant arrives.
+ */
+class CreditTracker
+{
+public:
+  CreditTracker(ConnectionId const& conn_id, FlowControlOptions const& options);
+
+  bool is_enabled() const { return m_enabled; }
+
+  /**
+   * @brief Number of messages which may be sent now, after reading any pending grants
+   *
+   * Never blocks; while another thread waits for credit, the last known value is returned.
+   */
+  size_t available();
+
+  /**
+   * @brief Wait up to timeout for credit to become available
+   */
+  bool wait_for_credit(std::chrono::milliseconds timeout);
+
+  void on_sent(size_t count = 1);
+
+private:
+  // Read grants, waiting up to timeout for the first one; must be called with m_mutex held
+  void receive_grants(std::chrono::milliseconds timeout);
+  size_t credit() const;
+  bool get_receiver();
+
+  ConnectionId m_conn_id;
+  ConnectionId m_credit_conn_id;
+  bool m_enabled{ false };
+
+  std::mutex m_mutex;
+  bool m_granted{ false }; // Protected by m_mutex
+  uint64_t m_epoch{ 0 };   // Protected by m_mutex
+  uint64_t m_limit{ 0 };   // Protected by m_mutex
+  uint64_t m_sent{ 0 };    // Protected by m_mutex
+  std::atomic<size_t> m_available{ 0 };
+  NetworkManager::ReceiverFuture m_receiver_future;
+  std::shared_ptr<ipm::Receiver> m_receiver;
+};
+
+} // namespace iomanager
+} // namespace dunedaq
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_FLOWCONTROL_HPP_
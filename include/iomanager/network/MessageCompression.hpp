@@ -0,0 +1,91 @@
+/**
+ * @file MessageCompression.hpp
+ *
+ * Compression of outgoing network frames
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGECOMPRESSION_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGECOMPRESSION_HPP_
+
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include "opmonlib/MonitorableObject.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace folly::io {
+class Codec;
+class StreamCodec;
+} // namespace folly::io
+
+namespace dunedaq::iomanager {
+
+/**
+ * Compressed frame: 'Z', uint8 CompressionAlgorithm, uint64 uncompressed size, then the
+ * compressed bytes of a serialized message or another frame.
+ */
+constexpr uint8_t s_compressed_frame_type = 'Z';
+
+/**
+ * @brief Compresses outgoing frames for one sending connection and publishes compression statistics
+ */
+class MessageCompressor : public opmonlib::MonitorableObject
+{
+public:
+  static constexpr size_t s_header_size = 1 + 1 + sizeof(uint64_t);
+
+  /**
+   * @param name Connection name, used in log messages
+   * If the algorithm is not available in this build, a warning is issued and messages are sent uncompressed.
+   */
+  MessageCompressor(std::string const& name, CompressionOptions const& options);
+  ~MessageCompressor();
+
+  MessageCompressor(MessageCompressor const&) = delete;
+  MessageCompressor(MessageCompressor&&) = delete;
+  MessageCompressor& operator=(MessageCompressor const&) = delete;
+  MessageCompressor& operator=(MessageCompressor&&) = delete;
+
+  bool is_enabled() const { return m_codec != nullptr; }
+
+  /**
+   * @brief Write a compressed frame holding the given bytes to frame
+   * @return false if the bytes should be sent as they are: below the size threshold, or not smaller compressed
+   */
+  bool compress(const uint8_t* data, size_t size, SerializationBuffer& frame);
+
+protected:
+  void generate_opmon_data() override;
+
+private:
+  std::string m_name;
+  CompressionOptions m_options;
+  std::unique_ptr<folly::io::Codec> m_codec;
+  folly::io::StreamCodec* m_stream_codec{ nullptr }; // m_codec, if it can compress into the frame directly
+
+  std::atomic<uint64_t> m_messages_compressed{ 0 };
+  std::atomic<uint64_t> m_messages_not_compressed{ 0 };
+  std::atomic<uint64_t> m_bytes_in{ 0 };
+  std::atomic<uint64_t> m_bytes_out{ 0 };
+  std::atomic<uint64_t> m_compression_time_ns{ 0 };
+};
+
+/**
+ * @brief Decompress the contents of a compressed frame
+ */
+std::vector<uint8_t>
+decompress_frame(std::vector<uint8_t> const& frame);
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGECOMPRESSION_HPP_
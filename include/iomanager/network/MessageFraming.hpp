@@ -0,0 +1,125 @@
+/**
+ * @file MessageFraming.hpp
+ *
+ * Frame formats wrapping serialized messages on the wire
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGEFRAMING_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGEFRAMING_HPP_
+
+#include "iomanager/network/MessageCompression.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * A serialized message starts with its serialization type byte ('M' for msgpack). Frames
+ * wrapping one or more messages start with a different byte, so a receiver can tell a
+ * plain message from a frame by its first byte. Integers in frame headers are in host byte
+ * order, like the rest of the DAQ.
+ *
+ * Batch frame: 'B', uint32 message count, then for each message a uint32 length followed by
+ * the serialized message.
+ *
+ * Compressed frame: see MessageCompression.hpp. The compressed content is either a single
+ * serialized message or a batch frame.
+ */
+constexpr uint8_t s_batch_frame_type = 'B';
+
+/**
+ * @brief Accumulates serialized messages into a batch frame
+ */
+class BatchFrameBuilder
+{
+public:
+  static constexpr size_t s_header_size = 1 + sizeof(uint32_t);
+
+  void append(const uint8_t* message, size_t size)
+  {
+    if (m_count == 0) {
+      m_frame.clear();
+      const char header[s_header_size] = { static_cast<char>(s_batch_frame_type) };
+      m_frame.write(header, s_header_size);
+    }
+    auto length = static_cast<uint32_t>(size);
+    m_frame.write(reinterpret_cast<const char*>(&length), sizeof(length)); // NOLINT
+    m_frame.write(reinterpret_cast<const char*>(message), size);           // NOLINT
+    ++m_count;
+    std::memcpy(m_frame.data() + 1, &m_count, sizeof(m_count));
+  }
+
+  void clear() noexcept
+  {
+    m_frame.clear();
+    m_count = 0;
+  }
+
+  bool empty() const noexcept { return m_count == 0; }
+  uint32_t message_count() const noexcept { return m_count; }
+  size_t size() const noexcept { return m_count == 0 ? 0 : m_frame.size(); }
+  const uint8_t* data() const noexcept { return m_frame.data(); }
+
+private:
+  SerializationBuffer m_frame;
+  uint32_t m_count{ 0 };
+};
+
+/**
+ * @brief Split a received frame into the serialized messages it carries
+ *
+ * Plain messages are passed through without copying.
+ */
+inline void
+unpack_frame(std::vector<uint8_t>&& frame, std::deque<std::vector<uint8_t>>& messages)
+{
+  if (!frame.empty() && frame[0] == s_compressed_frame_type) {
+    auto contents = decompress_frame(frame);
+    if (!contents.empty() && contents[0] == s_compressed_frame_type) {
+      throw MessageDecodeFailed(ERS_HERE, "compressed", "nested compressed frame");
+    }
+    unpack_frame(std::move(contents), messages);
+    return;
+  }
+
+  if (frame.empty() || frame[0] != s_batch_frame_type) {
+    messages.push_back(std::move(frame));
+    return;
+  }
+
+  if (frame.size() < BatchFrameBuilder::s_header_size) {
+    throw MessageDecodeFailed(ERS_HERE, "batch", "truncated header");
+  }
+  uint32_t count = 0;
+  std::memcpy(&count, frame.data() + 1, sizeof(count));
+  size_t offset = BatchFrameBuilder::s_header_size;
+  for (uint32_t ii = 0; ii < count; ++ii) {
+    uint32_t length = 0;
+    if (frame.size() - offset < sizeof(length)) {
+      throw MessageDecodeFailed(ERS_HERE, "batch", "truncated length of message " + std::to_string(ii));
+    }
+    std::memcpy(&length, frame.data() + offset, sizeof(length));
+    offset += sizeof(length);
+    if (frame.size() - offset < length) {
+      throw MessageDecodeFailed(ERS_HERE, "batch", "truncated message " + std::to_string(ii));
+    }
+    messages.emplace_back(frame.begin() + offset, frame.begin() + offset + length);
+    offset += length;
+  }
+}
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGEFRAMING_HPP_
@@ -0,0 +1,99 @@
+/**
+ * @file MessageTracing.hpp
+ *
+ * Trace envelope of sampled network messages, and the latencies recorded from it
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGETRACING_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGETRACING_HPP_
+
+#include "iomanager/TraceContext.hpp"
+#include "iomanager/network/NetworkMetrics.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include "opmonlib/MonitorableObject.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * Trace envelope: 'T', uint8 version, uint8 hop count, uint8 reserved, uint64 trace id,
+ * uint64 origin timestamp, one uint64 timestamp per hop, then the serialized message. Like the
+ * other frame headers (see MessageFraming.hpp), it is in host byte order. Envelopes wrap a
+ * single message; batches and compressed frames contain the envelopes of their traced messages.
+ */
+constexpr uint8_t s_trace_frame_type = 'T';
+constexpr uint8_t s_trace_envelope_version = 1;
+constexpr size_t s_trace_header_size = 4 + 2 * sizeof(uint64_t);
+
+/**
+ * @brief Write the envelope of context followed by message (including its external segments) into frame
+ */
+void
+wrap_trace_envelope(TraceContext const& context, SerializationBuffer const& message, SerializationBuffer& frame);
+
+/**
+ * @brief Remove the trace envelope from a received message
+ * @return The trace context, inactive if the message was not traced
+ */
+TraceContext
+unwrap_trace_envelope(std::vector<uint8_t>& message);
+
+/**
+ * @brief Latencies of the traced messages received on one connection
+ *
+ * The hop latency runs from the last network send of a message to its reception, the
+ * end-to-end latency from the origin of its trace. Both are computed from system clock
+ * timestamps taken on different hosts, so they are only as accurate as the clock
+ * synchronization; negative latencies are counted separately.
+ */
+class TraceStatistics : public opmonlib::MonitorableObject
+{
+public:
+  // Same log2 microsecond buckets as NetworkMetrics
+  static constexpr size_t s_histogram_buckets = NetworkMetrics::s_histogram_buckets;
+
+  TraceStatistics() = default;
+
+  TraceStatistics(TraceStatistics const&) = delete;
+  TraceStatistics(TraceStatistics&&) = delete;
+  TraceStatistics& operator=(TraceStatistics const&) = delete;
+  TraceStatistics& operator=(TraceStatistics&&) = delete;
+
+  void record(TraceContext const& context, uint64_t received_ns = TraceContext::now_ns());
+
+  uint64_t get_traced_message_count() const { return m_traced_messages.load(); }
+
+protected:
+  void generate_opmon_data() override;
+
+private:
+  struct Latencies
+  {
+    std::atomic<uint64_t> total_ns{ 0 };
+    std::array<std::atomic<uint64_t>, s_histogram_buckets> histogram{};
+
+    void record(uint64_t ns);
+  };
+
+  std::atomic<uint64_t> m_traced_messages{ 0 }; // Since creation
+  std::atomic<uint64_t> m_interval_messages{ 0 };
+  std::atomic<uint64_t> m_negative_latencies{ 0 };
+  Latencies m_hop;
+  Latencies m_end_to_end;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_MESSAGETRACING_HPP_
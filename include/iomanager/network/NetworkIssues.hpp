@@ -47,6 +47,47 @@ ERS_DECLARE_ISSUE(iomanager,
                       "Caught exception <" << exc << "> while trying to publish",
                       ((std::string)exc))
 
+    ERS_DECLARE_ISSUE(iomanager,
+                      MessageDecodeFailed,
+                      "Failed to decode received " << format << " message: " << reason,
+                      ((std::string)format)((std::string)reason))
+    ERS_DECLARE_ISSUE(iomanager,
+                      CallbackReceiveFailed,
+                      "Failed to receive or deliver message to callback on connection " << name,
+                      ((std::string)name))
+    ERS_DECLARE_ISSUE(iomanager,
+                      AsyncSendFailed,
+                      "Failed to send queued message on connection " << name,
+                      ((std::string)name))
+    ERS_DECLARE_ISSUE(iomanager,
+                      FlowControlUnavailable,
+                      "Flow control requested for " << name << " but credit connection " << credit_name
+                                                     << " is not configured, disabling it",
+                      ((std::string)name)((std::string)credit_name))
+    ERS_DECLARE_ISSUE_BASE(iomanager,
+                           ConnectionReconnecting,
+                           iomanager::TimeoutExpired,
+                           name << ": Unable to " << func_name << ", the connection is being re-established",
+                           ((std::string)name)((std::string)func_name)((int)timeout), // NOLINT(readability/casting)
+                           ERS_EMPTY)
+    ERS_DECLARE_ISSUE(iomanager,
+                      SubscriberQueueFull,
+                      "Queue of " << capacity << " messages for shared subscriber " << name
+                                  << " is full, dropping messages until it is read",
+                      ((std::string)name)((size_t)capacity))
+    ERS_DECLARE_ISSUE(iomanager,
+                      SharedMemoryFailure,
+                      "Shared memory ring " << name << ": " << operation << " failed: " << reason,
+                      ((std::string)name)((std::string)operation)((std::string)reason))
+    ERS_DECLARE_ISSUE(iomanager,
+                      BatchDropped,
+                      "Failed to send batch of " << count << " coalesced messages on connection " << name,
+                      ((std::string)name)((size_t)count))
+    ERS_DECLARE_ISSUE(iomanager,
+                      CompressionUnavailable,
+                      "Compression algorithm " << algorithm << " is not available, sending on " << name
+                                               << " uncompressed",
+                      ((std::string)algorithm)((std::string)name))
 
 // Re-enable coverage collection LCOV_EXCL_STOP
 
@@ -11,7 +11,13 @@
 #define IOMANAGER_INCLUDE_IOMANAGER_NETWORKMANAGER_HPP_
 
 #include "iomanager/network/ConfigClient.hpp"
+#include "iomanager/network/ConnectionEstablisher.hpp"
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/MessageCompression.hpp"
 #include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/MessageTracing.hpp"
+#include "iomanager/network/SerializationProfile.hpp"
+#include "iomanager/network/SharedSubscriber.hpp"
 
 #include "ipm/Receiver.hpp"
 #include "ipm/Sender.hpp"
@@ -24,8 +30,11 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -34,10 +43,37 @@
 
 namespace dunedaq::iomanager {
 
+/**
+ * @brief Connections to resolve and connect while configuring, before the first message is sent
+ *
+ * IOManager cannot tell which end of a connection a module will use, so the connections
+ * to warm up are listed separately for the sending and receiving side.
+ */
+struct ConnectionWarmup
+{
+  std::vector<ConnectionId> senders;
+  std::vector<ConnectionId> receivers;
+  size_t worker_count{ ConnectionEstablisher::s_default_worker_count };
+  std::chrono::milliseconds timeout{ 5000 };
+
+  bool empty() const { return senders.empty() && receivers.empty(); }
+};
+
+struct WarmupResult
+{
+  ConnectionId id;
+  bool is_sender{ false };
+  bool success{ false };
+  std::chrono::microseconds setup_time{ 0 };
+};
+
 class NetworkManager
 {
 
 public:
+  using SenderFuture = std::shared_future<std::shared_ptr<ipm::Sender>>;
+  using ReceiverFuture = std::shared_future<std::shared_ptr<ipm::Receiver>>;
+
   static NetworkManager& get();
   ~NetworkManager() { reset(); }
 
@@ -50,10 +86,63 @@ public:
   std::shared_ptr<ipm::Receiver> get_receiver(ConnectionId const& conn_id);
   std::shared_ptr<ipm::Sender> get_sender(ConnectionId const& conn_id);
 
+  /**
+   * @brief Request that a connection be established in the background
+   * @param conn_id Connection to establish
+   * @param give_up_after How long the background workers should keep retrying
+   * @param delay How long to wait before the first attempt (senders use this to back off before reconnecting)
+   * @return Future which becomes ready with the connected plugin, or nullptr if the connection could not be
+   * established in time
+   *
+   * Concurrent requests for the same connection share a single future.
+   */
+  SenderFuture request_sender(ConnectionId const& conn_id,
+                              std::chrono::milliseconds give_up_after,
+                              std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+  ReceiverFuture request_receiver(ConnectionId const& conn_id, std::chrono::milliseconds give_up_after);
+
   void remove_sender(ConnectionId const& conn_id);
 
+  /**
+   * @brief Resolve and connect the given connections in parallel on a bounded worker pool
+   * @return Per-connection outcome and setup time
+   */
+  std::vector<WarmupResult> warm_up(ConnectionWarmup const& warmup);
+  bool is_warm_sender(ConnectionId const& conn_id) const;
+
   bool is_pubsub_connection(ConnectionId const& conn_id) const;
 
+  /**
+   * @brief Set the options for connections matching pattern (uid regex and data type, as for get_connections)
+   *
+   * Options apply to Senders/Receivers created afterwards. If several patterns match a connection,
+   * the most recently set one is used. Options are cleared by reset().
+   */
+  void set_connection_options(ConnectionId const& pattern, ConnectionOptions const& options);
+  ConnectionOptions get_connection_options(ConnectionId const& conn_id) const;
+
+  /**
+   * @brief Publish the statistics of a sender's compressor in opmon, under "compression"
+   */
+  void register_compressor(ConnectionId const& conn_id, std::shared_ptr<MessageCompressor> compressor);
+
+  /**
+   * @brief Publish the statistics of network Senders and Receivers in opmon, under "sender_models" and
+   * "receiver_models"
+   */
+  void register_sender_model(ConnectionId const& conn_id, std::shared_ptr<opmonlib::MonitorableObject> model);
+  void register_receiver_model(ConnectionId const& conn_id, std::shared_ptr<opmonlib::MonitorableObject> model);
+
+  /**
+   * @brief The serialization profile of a data type, published in opmon under "serialization"
+   */
+  std::shared_ptr<SerializationProfile> get_serialization_profile(std::string const& data_type);
+
+  /**
+   * @brief The latencies of traced messages received on a connection, published in opmon under "tracing"
+   */
+  std::shared_ptr<TraceStatistics> get_trace_statistics(ConnectionId const& conn_id);
+
   ConnectionResponse get_connections(ConnectionId const& conn_id, bool restrict_single = false) const;
   ConnectionResponse get_preconfigured_connections(ConnectionId const& conn_id) const;
 
@@ -71,9 +160,23 @@ private:
 
   std::shared_ptr<ipm::Receiver> create_receiver(std::vector<ConnectionInfo> connections, ConnectionId const& conn_id);
   std::shared_ptr<ipm::Sender> create_sender(ConnectionInfo connection);
+  // Receiver for topic on the shared subscriber of the given publishers, creating it if needed
+  std::shared_ptr<ipm::Receiver> create_subscriber_channel(ConnectionId const& conn_id,
+                                                           std::string const& topic,
+                                                           std::vector<std::string> uris,
+                                                           SubscriberSharingOptions const& options);
+  // Track a subscriber so that it is connected to publishers which appear later
+  void register_subscriber(ConnectionId const& conn_id, std::shared_ptr<ipm::Subscriber> subscriber);
 
   void update_subscribers();
 
+  ConnectionEstablisher& get_establisher();
+  void stop_establisher();
+  static std::shared_ptr<std::mutex> get_creation_mutex(
+    std::unordered_map<ConnectionId, std::shared_ptr<std::mutex>>& mutexes,
+    std::mutex& map_mutex,
+    ConnectionId const& conn_id);
+
   std::unordered_map<ConnectionId, const confmodel::NetworkConnection*> m_preconfigured_connections;
   std::unordered_map<ConnectionId, std::shared_ptr<ipm::Receiver>> m_receiver_plugins;
   std::unordered_map<ConnectionId, std::shared_ptr<ipm::Sender>> m_sender_plugins;
@@ -81,18 +184,57 @@ private:
   std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_receiver_opmon_link{
     std::make_shared<dunedaq::opmonlib::OpMonLink>()
   };
+  std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_compression_opmon_link{
+    std::make_shared<dunedaq::opmonlib::OpMonLink>()
+  };
+  std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_sender_model_opmon_link{
+    std::make_shared<dunedaq::opmonlib::OpMonLink>()
+  };
+  std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_receiver_model_opmon_link{
+    std::make_shared<dunedaq::opmonlib::OpMonLink>()
+  };
+  std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_serialization_opmon_link{
+    std::make_shared<dunedaq::opmonlib::OpMonLink>()
+  };
+  std::shared_ptr<dunedaq::opmonlib::OpMonLink> m_tracing_opmon_link{
+    std::make_shared<dunedaq::opmonlib::OpMonLink>()
+  };
   static void register_monitorable_node(std::shared_ptr<opmonlib::MonitorableObject> conn,
                                         std::shared_ptr<opmonlib::OpMonLink> link,
                                         const std::string& name,
                                         bool is_pubsub);
 
   std::unordered_map<ConnectionId, std::shared_ptr<ipm::Subscriber>> m_subscriber_plugins;
+  // Shared subscribers by session and publisher URIs; owned by their channels
+  std::map<std::string, std::weak_ptr<SharedSubscriber>> m_shared_subscribers;
+  std::mutex m_shared_subscribers_mutex;
+  std::map<std::string, std::shared_ptr<SerializationProfile>> m_serialization_profiles;
+  std::mutex m_serialization_profiles_mutex;
+  std::map<std::string, std::shared_ptr<TraceStatistics>> m_trace_statistics;
+  std::mutex m_trace_statistics_mutex;
   std::unique_ptr<std::thread> m_subscriber_update_thread;
   std::atomic<bool> m_subscriber_update_thread_running{ false };
 
   std::unique_ptr<ConfigClient> m_config_client;
   std::chrono::milliseconds m_config_client_interval{1000};
 
+  std::unique_ptr<ConnectionEstablisher> m_establisher;
+  std::unordered_map<ConnectionId, SenderFuture> m_pending_senders;
+  std::unordered_map<ConnectionId, ReceiverFuture> m_pending_receivers;
+  std::mutex m_establisher_mutex;
+
+  // Plugin creation is serialized per connection rather than per plugin map, so that
+  // independent connections can be resolved and connected concurrently
+  std::unordered_map<ConnectionId, std::shared_ptr<std::mutex>> m_sender_creation_mutexes;
+  std::unordered_map<ConnectionId, std::shared_ptr<std::mutex>> m_receiver_creation_mutexes;
+  std::mutex m_creation_mutex_map_mutex;
+
+  std::vector<std::pair<ConnectionId, ConnectionOptions>> m_connection_options;
+  mutable std::mutex m_connection_options_mutex;
+
+  std::set<ConnectionId> m_warm_senders;
+  mutable std::mutex m_warm_senders_mutex;
+
   mutable std::mutex m_receiver_plugin_map_mutex;
   mutable std::mutex m_sender_plugin_map_mutex;
   mutable std::mutex m_subscriber_plugin_map_mutex;
@@ -0,0 +1,101 @@
+/**
+ * @file NetworkMetrics.hpp
+ *
+ * Low-overhead counters for the network sender and receiver models
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_NETWORKMETRICS_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_NETWORKMETRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Counters and a duration histogram of one network connection end
+ *
+ * Updated on every message by any number of threads. Each thread adds to one of s_shards
+ * cache-line-aligned copies of the counters, chosen once per thread, so threads sending on the
+ * same connection do not contend for a cache line and updates are plain relaxed additions.
+ * collect() sums and clears the shards; it runs once per opmon interval.
+ */
+class NetworkMetrics
+{
+public:
+  enum Counter : size_t
+  {
+    kMessages,
+    kBytes,
+    kFailures,            // Timed out or otherwise failed sends/receives
+    kTotalTimeNs,         // Time spent in send calls, from entry to return
+    kTransportTimeNs,     // Time spent in the ipm send/receive
+    kSerializationTimeNs, // Time spent (de)serializing
+    kLockWaitNs,          // Time blocked acquiring the send/receive mutex
+    kLockContentions,     // Times the mutex was not free
+    kCallbackTimeNs,      // Time spent in receive callbacks
+    kReconnectAttempts,
+    kReconnects,
+    kCounterCount
+  };
+
+  // Bucket 0 counts durations below 1 us, bucket i those in [2^(i-1), 2^i) us, the last one the rest
+  static constexpr size_t s_histogram_buckets = 24;
+
+  struct Snapshot
+  {
+    std::array<uint64_t, kCounterCount> counters{};
+    std::array<uint64_t, s_histogram_buckets> histogram{};
+  };
+
+  void add(Counter counter, uint64_t value = 1)
+  {
+    get_shard().values[counter].fetch_add(value, std::memory_order_relaxed);
+  }
+
+  void add_time(Counter counter, std::chrono::steady_clock::duration duration)
+  {
+    add(counter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+  }
+
+  // Count a duration in the histogram
+  void record(std::chrono::steady_clock::duration duration)
+  {
+    add(static_cast<Counter>(kCounterCount + get_bucket(duration)));
+  }
+
+  static size_t get_bucket(std::chrono::steady_clock::duration duration);
+
+  // Sum of all updates since the previous call
+  Snapshot collect();
+
+private:
+  static constexpr size_t s_shards = 16;
+
+  struct alignas(64) Shard
+  {
+    std::array<std::atomic<uint64_t>, kCounterCount + s_histogram_buckets> values{};
+  };
+
+  static size_t get_thread_shard()
+  {
+    static std::atomic<size_t> s_next_shard{ 0 };
+    thread_local size_t shard = s_next_shard.fetch_add(1, std::memory_order_relaxed) % s_shards;
+    return shard;
+  }
+
+  Shard& get_shard() { return m_shards[get_thread_shard()]; }
+
+  std::array<Shard, s_shards> m_shards{};
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_NETWORKMETRICS_HPP_
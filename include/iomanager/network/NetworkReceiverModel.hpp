@@ -10,10 +10,24 @@
 #define IOMANAGER_INCLUDE_IOMANAGER_NRECEIVER_HPP_
 
 #include "iomanager/Receiver.hpp"
+#include "iomanager/TraceContext.hpp"
+#include "iomanager/network/CallbackPipeline.hpp"
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/FlowControl.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/MessageTracing.hpp"
+#include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/NetworkMetrics.hpp"
+#include "iomanager/network/SerializationProfile.hpp"
+#include "iomanager/network/SharedBuffer.hpp"
 
 #include "ipm/Subscriber.hpp"
+#include "opmonlib/MonitorableObject.hpp"
 #include "serialization/Serialization.hpp"
 
+#include <deque>
+#include <optional>
+#include <vector>
 
 namespace dunedaq {
 
@@ -21,7 +35,9 @@ namespace iomanager {
 
 // NImpl
 template<typename Datatype>
-class NetworkReceiverModel : public ReceiverConcept<Datatype>
+class NetworkReceiverModel
+  : public ReceiverConcept<Datatype>
+  , public opmonlib::MonitorableObject
 {
 public:
   explicit NetworkReceiverModel(ConnectionId const& conn_id);
@@ -42,8 +58,31 @@ public:
   void subscribe(std::string topic) override;
   void unsubscribe(std::string topic) override;
 
+protected:
+  void generate_opmon_data() override;
+
 private:
-  void get_receiver(Receiver::timeout_t timeout);
+  // How long the constructor waits for the background connection attempt before returning
+  static constexpr Receiver::timeout_t s_initial_wait{ 10 };
+  // Total time allowed for the initial connection, the first receive may wait for the remainder
+  static constexpr Receiver::timeout_t s_initial_connection_budget{ 1000 };
+  // Timeout of each receive in the callback loop, which bounds how long remove_callback waits for the loop
+  // (ipm receives cannot be interrupted, so the loop polls rather than being woken)
+  static constexpr Receiver::timeout_t s_callback_receive_timeout{ 10 };
+
+  void get_receiver(Receiver::timeout_t timeout, bool use_initial_budget = true);
+  // Lock m_receive_mutex, accounting the time blocked on it
+  std::unique_lock<std::mutex> lock_receive_mutex();
+  // Deserialize a received message, accounting it and making its trace current on the calling thread;
+  // may be called from several threads
+  template<typename MessageType>
+  MessageType decode_message(std::vector<uint8_t>&& message);
+  // Next serialized message, from a previously received frame if one is pending
+  std::optional<std::vector<uint8_t>> receive_message(Receiver::timeout_t const& timeout, bool no_tmoexcept_mode);
+  // Receive one frame, granting flow control credit while waiting if enabled
+  ipm::Receiver::Response receive_frame(ipm::Receiver& receiver,
+                                        Receiver::timeout_t const& timeout,
+                                        bool no_tmoexcept_mode);
 
   template<typename MessageType>
   typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, MessageType>::type read_network(
@@ -69,11 +108,21 @@ private:
   template<typename MessageType>
   typename std::enable_if<!dunedaq::serialization::is_serializable<MessageType>::value, void>::type add_callback_impl(
     std::function<void(MessageType&)>);
+  void callback_loop();
 
   std::atomic<bool> m_with_callback{ false };
   std::function<void(Datatype&)> m_callback;
   std::unique_ptr<std::thread> m_event_loop_runner;
   std::shared_ptr<ipm::Receiver> m_network_receiver_ptr{ nullptr };
+  NetworkManager::ReceiverFuture m_receiver_future;
+  std::chrono::steady_clock::time_point m_initial_deadline;
+  std::deque<std::vector<uint8_t>> m_pending_messages; // Protected by m_receive_mutex
+  ReceivePipelineOptions m_receive_pipeline;
+  FlowControlOptions m_flow_control;
+  std::unique_ptr<CreditGrantor> m_credit_grantor; // Null if flow control is disabled
+  NetworkMetrics m_metrics;
+  std::shared_ptr<SerializationProfile> m_serialization_profile; // Null unless s_serialization_profiling
+  std::shared_ptr<TraceStatistics> m_trace_statistics;
   std::mutex m_callback_mutex;
   std::mutex m_receive_mutex;
 };
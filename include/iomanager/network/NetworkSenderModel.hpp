@@ -10,19 +10,42 @@
 #define IOMANAGER_INCLUDE_IOMANAGER_NSENDER_HPP_
 
 #include "iomanager/Sender.hpp"
-
+#include "iomanager/TraceContext.hpp"
+#include "iomanager/network/Backoff.hpp"
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/FlowControl.hpp"
+#include "iomanager/network/MessageCompression.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/MessageTracing.hpp"
+#include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/NetworkMetrics.hpp"
+#include "iomanager/network/RawSerialization.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+#include "iomanager/network/SerializationProfile.hpp"
+#include "iomanager/network/VectoredSender.hpp"
+
+#include "folly/concurrency/DynamicBoundedQueue.h"
 #include "ipm/Sender.hpp"
+#include "opmonlib/MonitorableObject.hpp"
 #include "serialization/Serialization.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 
 namespace dunedaq::iomanager {
 
 // NImpl
 template<typename Datatype>
-class NetworkSenderModel : public SenderConcept<Datatype>
+class NetworkSenderModel
+  : public SenderConcept<Datatype>
+  , public opmonlib::MonitorableObject
 {
 public:
   using SenderConcept<Datatype>::send;
@@ -30,6 +53,7 @@ public:
   explicit NetworkSenderModel(ConnectionId const& conn_id);
 
   NetworkSenderModel(NetworkSenderModel&& other);
+  ~NetworkSenderModel();
 
   void send(Datatype&& data, Sender::timeout_t timeout) override;
 
@@ -39,8 +63,38 @@ public:
 
   bool is_ready_for_sending(Sender::timeout_t timeout) override;
 
+  void flush(Sender::timeout_t timeout) override;
+
+  std::optional<size_t> available_credit() override;
+
+
+protected:
+  void generate_opmon_data() override;
+
 private:
-  void get_sender(Sender::timeout_t const& timeout);
+  // How long the constructor waits for the background connection attempt before returning
+  static constexpr Sender::timeout_t s_initial_wait{ 10 };
+  // Total time allowed for the initial connection, the first send may wait for the remainder
+  static constexpr Sender::timeout_t s_initial_connection_budget{ 1000 };
+  // Payloads at least this large are sent in place when the transport supports vectored sends
+  static constexpr size_t s_gather_threshold = 64 * 1024;
+  // How often the asynchronous send thread checks whether it should stop while its queue is empty
+  static constexpr std::chrono::milliseconds s_async_poll_interval{ 10 };
+
+  void get_sender(Sender::timeout_t const& timeout, bool use_initial_budget = true);
+  // What is left of timeout after the time since start; s_block is left as it is
+  static Sender::timeout_t remaining(std::chrono::steady_clock::time_point start, Sender::timeout_t const& timeout);
+  // Lock m_send_mutex, accounting the time blocked on it
+  std::unique_lock<std::mutex> lock_send_mutex();
+  // Account a send which started at start, after it succeeded or failed
+  void record_send(std::chrono::steady_clock::time_point start, bool sent);
+  // Drop a connection whose send timed out and reconnect it in the background after a backoff delay
+  void drop_sender();
+  void schedule_reconnect();
+  // Swap in the replacement connection if it is ready within timeout
+  void poll_reconnect(Sender::timeout_t const& timeout);
+  // Wait up to timeout for flow control credit; always true without flow control
+  bool wait_for_credit(Sender::timeout_t const& timeout);
 
   template<typename MessageType>
   typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, void>::type write_network(
@@ -73,12 +127,84 @@ private:
     MessageType&,
     Sender::timeout_t const&, std::string);
   
+  // Trace to continue or start with message, inactive if it is not traced; call with m_send_mutex held
+  template<typename MessageType>
+  TraceContext get_trace_context(MessageType const& message);
+  template<typename MessageType>
+  void serialize_message(MessageType const& message);
+  bool send_serialized(Sender::timeout_t const& timeout, std::string const& topic, bool no_tmoexcept_mode = false);
+  // Send one frame, compressing it if configured
+  bool send_frame(const uint8_t* data,
+                  size_t size,
+                  Sender::timeout_t const& timeout,
+                  std::string const& topic,
+                  bool no_tmoexcept_mode);
+  bool dispatch_serialized(Sender::timeout_t const& timeout,
+                           std::string const& topic,
+                           bool no_tmoexcept_mode = false);
+
+  // Asynchronous sends; returns false if there was no queue space within timeout
+  bool enqueue_async(Datatype&& data, Sender::timeout_t const& timeout, std::optional<std::string> topic);
+  void start_async_thread();
+  void stop_async_thread();
+  void async_thread();
+
+  // Coalescing; the batch functions must be called with m_send_mutex held
+  bool flush_batch(Sender::timeout_t const& timeout, bool no_tmoexcept_mode);
+  void start_flush_thread();
+  void stop_flush_thread();
+  void flush_thread();
+
   Sender::timeout_t extend_first_timeout(Sender::timeout_t timeout);
 
   std::shared_ptr<ipm::Sender> m_network_sender_ptr;
+  VectoredSender* m_vectored_sender{ nullptr }; // Non-null if m_network_sender_ptr supports vectored sends
+  NetworkManager::SenderFuture m_sender_future;
+  std::chrono::steady_clock::time_point m_initial_deadline;
   std::mutex m_send_mutex;
+  SerializationBuffer m_serialization_buffer; // Protected by m_send_mutex
   std::string m_topic{ "" };
   std::atomic<bool> m_first{ true };
+
+  ReconnectOptions m_reconnect;
+  ExponentialBackoff m_reconnect_backoff;
+  std::atomic<bool> m_reconnecting{ false }; // Sends fail fast while set
+
+  CoalescingOptions m_coalescing;
+  BatchFrameBuilder m_batch; // Protected by m_send_mutex
+  std::string m_batch_topic;
+  Sender::timeout_t m_batch_timeout{ 0 };
+  std::chrono::steady_clock::time_point m_batch_deadline;
+  std::condition_variable m_flush_cv;
+  bool m_flush_thread_running{ false }; // Protected by m_send_mutex
+  std::unique_ptr<std::thread> m_flush_thread;
+
+  std::unique_ptr<CreditTracker> m_credit_tracker; // Null if flow control is disabled
+
+  NetworkMetrics m_metrics;
+  std::shared_ptr<SerializationProfile> m_serialization_profile; // Null unless s_serialization_profiling
+
+  std::shared_ptr<MessageCompressor> m_compressor{ nullptr }; // Null if compression is disabled
+  SerializationBuffer m_compression_buffer;                   // Protected by m_send_mutex
+
+  size_t m_trace_sample_interval{ 0 }; // 0 if this sender does not start traces
+  size_t m_messages_until_trace{ 0 };  // Protected by m_send_mutex
+  SerializationBuffer m_trace_buffer;  // Protected by m_send_mutex
+
+  struct AsyncSendItem
+  {
+    std::optional<Datatype> data;
+    Sender::timeout_t timeout{ 0 };
+    std::optional<std::string> topic; // Connection topic if not set
+    TraceContext trace;               // Current trace of the thread which queued the message
+  };
+  AsyncSendOptions m_async;
+  std::unique_ptr<folly::DMPMCQueue<AsyncSendItem, true>> m_async_queue; // Null if asynchronous sends are disabled
+  std::atomic<bool> m_async_thread_running{ false };
+  std::unique_ptr<std::thread> m_async_thread;
+  std::mutex m_async_mutex;
+  std::condition_variable m_async_idle_cv;
+  size_t m_async_pending{ 0 }; // Messages queued or being sent, protected by m_async_mutex
 };
 
 } // namespace dunedaq::iomanager
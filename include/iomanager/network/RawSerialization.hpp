@@ -0,0 +1,219 @@
+/**
+ * @file RawSerialization.hpp
+ *
+ * Serialization of fixed-layout types as their raw bytes
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_RAWSERIALIZATION_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_RAWSERIALIZATION_HPP_
+
+#include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include "serialization/Serialization.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * Raw message: 'R', uint8 flags, uint16 type version, uint32 type hash, uint32 element size,
+ * uint64 element count, then the bytes of the element(s). The type hash is taken from the
+ * connection data type name (datatype_to_string), so both ends must agree on the type and on
+ * its version before any bytes are copied into it.
+ */
+constexpr uint8_t s_raw_message_type = 'R';
+
+/**
+ * @brief Trait marking types which are sent over the network as their raw bytes
+ *
+ * Specialize (using DUNE_DAQ_RAW_SERIALIZABLE) for trivially copyable, standard-layout records
+ * with a fixed layout (no pointers, no padding whose contents matter). std::vectors of such
+ * types are sent as one contiguous block. Both ends must be built with the same layout: the
+ * version, element size and type name are checked on receipt, byte order is not.
+ */
+template<typename T>
+struct is_raw_serializable : std::false_type
+{
+};
+
+/**
+ * @brief Layout version of a raw serializable type, to be incremented whenever its layout changes
+ */
+template<typename T>
+struct raw_serialization_version : std::integral_constant<uint16_t, 0>
+{
+};
+
+template<typename T>
+struct is_raw_serializable<std::vector<T>> : is_raw_serializable<T>
+{
+};
+
+namespace detail {
+
+constexpr uint8_t s_raw_flag_array = 0x1;
+constexpr size_t s_raw_header_size = 1 + 1 + sizeof(uint16_t) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+
+template<typename T>
+struct raw_element
+{
+  using type = T;
+  static constexpr bool is_array = false;
+};
+
+template<typename T>
+struct raw_element<std::vector<T>>
+{
+  using type = T;
+  static constexpr bool is_array = true;
+};
+
+inline uint32_t
+raw_type_hash(std::string const& name)
+{
+  // 32-bit FNV-1a
+  uint32_t hash = 2166136261U;
+  for (auto c : name) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+template<typename T>
+uint32_t
+raw_type_hash()
+{
+  static const uint32_t hash = raw_type_hash(datatype_to_string<T>());
+  return hash;
+}
+
+} // namespace detail
+
+/**
+ * @brief Write a raw message holding obj to buffer
+ *
+ * The buffer is cleared first. Large arrays are referenced in place if the buffer has a gather threshold.
+ */
+template<typename T>
+void
+serialize_raw(T const& obj, SerializationBuffer& buffer)
+{
+  static_assert(is_raw_serializable<T>::value, "Type is not marked with DUNE_DAQ_RAW_SERIALIZABLE");
+  using element_t = typename detail::raw_element<T>::type;
+
+  const element_t* data = nullptr;
+  uint64_t count = 1;
+  if constexpr (detail::raw_element<T>::is_array) {
+    data = obj.data();
+    count = obj.size();
+  } else {
+    data = &obj;
+  }
+
+  uint8_t header[detail::s_raw_header_size] = { s_raw_message_type,
+                                                detail::raw_element<T>::is_array ? detail::s_raw_flag_array : uint8_t(0) };
+  uint16_t version = raw_serialization_version<element_t>::value;
+  uint32_t hash = detail::raw_type_hash<T>();
+  uint32_t element_size = sizeof(element_t);
+  std::memcpy(header + 2, &version, sizeof(version));
+  std::memcpy(header + 4, &hash, sizeof(hash));
+  std::memcpy(header + 8, &element_size, sizeof(element_size));
+  std::memcpy(header + 12, &count, sizeof(count));
+
+  buffer.clear();
+  buffer.write(reinterpret_cast<const char*>(header), detail::s_raw_header_size); // NOLINT
+  auto bytes = reinterpret_cast<const uint8_t*>(data);                            // NOLINT
+  auto size = count * sizeof(element_t);
+  if (size > 0 && !buffer.write_external(bytes, size)) {
+    buffer.write(reinterpret_cast<const char*>(bytes), size); // NOLINT
+  }
+}
+
+/**
+ * @brief Reconstruct an object from a raw message, after checking that it was sent as the same type
+ */
+template<typename T>
+T
+deserialize_raw(std::vector<uint8_t> const& message)
+{
+  static_assert(is_raw_serializable<T>::value, "Type is not marked with DUNE_DAQ_RAW_SERIALIZABLE");
+  using element_t = typename detail::raw_element<T>::type;
+  constexpr bool is_array = detail::raw_element<T>::is_array;
+
+  if (message.empty() || message[0] != s_raw_message_type) {
+    throw MessageDecodeFailed(ERS_HERE, "raw", "not a raw message, was " + datatype_to_string<T>() + " sent as raw?");
+  }
+  if (message.size() < detail::s_raw_header_size) {
+    throw MessageDecodeFailed(ERS_HERE, "raw", "truncated header");
+  }
+
+  uint16_t version = 0;
+  uint32_t hash = 0;
+  uint32_t element_size = 0;
+  uint64_t count = 0;
+  std::memcpy(&version, message.data() + 2, sizeof(version));
+  std::memcpy(&hash, message.data() + 4, sizeof(hash));
+  std::memcpy(&element_size, message.data() + 8, sizeof(element_size));
+  std::memcpy(&count, message.data() + 12, sizeof(count));
+
+  if (hash != detail::raw_type_hash<T>() || ((message[1] & detail::s_raw_flag_array) != 0) != is_array) {
+    throw MessageDecodeFailed(ERS_HERE, "raw", "message was not sent as " + datatype_to_string<T>());
+  }
+  if (version != raw_serialization_version<element_t>::value || element_size != sizeof(element_t)) {
+    throw MessageDecodeFailed(ERS_HERE,
+                              "raw",
+                              "layout mismatch for " + datatype_to_string<T>() + ": received version " +
+                                std::to_string(version) + " of size " + std::to_string(element_size) +
+                                ", expected version " + std::to_string(raw_serialization_version<element_t>::value) +
+                                " of size " + std::to_string(sizeof(element_t)));
+  }
+  auto payload_size = message.size() - detail::s_raw_header_size;
+  if ((!is_array && count != 1) || count > payload_size / sizeof(element_t) ||
+      count * sizeof(element_t) != payload_size) {
+    throw MessageDecodeFailed(ERS_HERE, "raw", "size does not match element count " + std::to_string(count));
+  }
+
+  T obj;
+  if constexpr (is_array) {
+    obj.resize(count);
+    if (count > 0) {
+      std::memcpy(obj.data(), message.data() + detail::s_raw_header_size, payload_size);
+    }
+  } else {
+    std::memcpy(&obj, message.data() + detail::s_raw_header_size, payload_size);
+  }
+  return obj;
+}
+
+} // namespace dunedaq::iomanager
+
+/**
+ * @brief Send Type as raw bytes, with the given layout version. Must be used in the dunedaq namespace, like
+ * DUNE_DAQ_SERIALIZABLE
+ */
+#define DUNE_DAQ_RAW_SERIALIZABLE(Type, version)                                                                       \
+  static_assert(std::is_trivially_copyable_v<Type> && std::is_standard_layout_v<Type> &&                               \
+                  std::is_default_constructible_v<Type>,                                                               \
+                #Type " must be trivially copyable, standard-layout and default constructible to be sent raw");       \
+  template<>                                                                                                           \
+  struct iomanager::is_raw_serializable<Type> : std::true_type                                                         \
+  {                                                                                                                    \
+  };                                                                                                                   \
+  template<>                                                                                                           \
+  struct iomanager::raw_serialization_version<Type> : std::integral_constant<uint16_t, version>                        \
+  {                                                                                                                    \
+  }
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_RAWSERIALIZATION_HPP_
@@ -0,0 +1,238 @@
+/**
+ * @file SerializationBuffer.hpp
+ *
+ * Reusable serialization buffer for network senders
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONBUFFER_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONBUFFER_HPP_
+
+#include "iomanager/CommonIssues.hpp"
+
+#include "serialization/Serialization.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief One contiguous piece of a message which is sent as several segments
+ */
+struct BufferSegment
+{
+  const uint8_t* data;
+  size_t size;
+};
+
+/**
+ * @brief Growable byte buffer whose capacity persists across messages
+ *
+ * SerializationBuffer implements the write() interface expected by msgpack::packer, so
+ * messages can be packed directly into it. Clearing the buffer keeps the allocation, so
+ * after the first few messages a sender no longer allocates (or page-faults) per send.
+ * Storage is not zero-initialized when it grows.
+ *
+ * With a non-zero gather threshold, large byte arrays written via write_external are not
+ * copied; segments() then describes the message as a list of pieces of the buffer and
+ * the referenced arrays, which must stay alive until the message has been sent.
+ */
+class SerializationBuffer
+{
+public:
+  static constexpr size_t s_default_initial_capacity = 4096;
+  static constexpr size_t s_default_max_retained_capacity = 64 * 1024 * 1024;
+
+  explicit SerializationBuffer(size_t max_retained_capacity = s_default_max_retained_capacity)
+    : m_max_retained_capacity(max_retained_capacity)
+  {
+  }
+
+  SerializationBuffer(SerializationBuffer const&) = delete;
+  SerializationBuffer& operator=(SerializationBuffer const&) = delete;
+  SerializationBuffer(SerializationBuffer&&) = default;
+  SerializationBuffer& operator=(SerializationBuffer&&) = default;
+
+  /**
+   * @brief Append bytes to the buffer (msgpack stream interface)
+   */
+  void write(const char* data, size_t size)
+  {
+    reserve(m_size + size);
+    std::memcpy(m_data.get() + m_size, data, size);
+    m_size += size;
+  }
+
+  /**
+   * @brief Reference size bytes at data in place of copying them, if gathering is enabled
+   * @return false if the bytes should be written normally instead
+   */
+  bool write_external(const uint8_t* data, size_t size)
+  {
+    if (m_gather_threshold == 0 || size < m_gather_threshold) {
+      return false;
+    }
+    m_external.push_back({ m_size, { data, size } });
+    m_external_size += size;
+    return true;
+  }
+
+  void reserve(size_t capacity)
+  {
+    if (capacity <= m_capacity) {
+      return;
+    }
+    auto new_capacity = std::max({ capacity, 2 * m_capacity, s_default_initial_capacity });
+    std::unique_ptr<uint8_t[]> new_data(new uint8_t[new_capacity]); // NOLINT(modernize-avoid-c-arrays)
+    if (m_size > 0) {
+      std::memcpy(new_data.get(), m_data.get(), m_size);
+    }
+    m_data = std::move(new_data);
+    m_capacity = new_capacity;
+  }
+
+  /**
+   * @brief Set the size, for writing directly into data(); bytes beyond the old size are not initialized
+   */
+  void resize(size_t size)
+  {
+    reserve(size);
+    m_size = size;
+  }
+
+  /**
+   * @brief Empty the buffer, keeping its storage unless it has grown beyond the retention limit
+   *
+   * The limit keeps a single exceptionally large message from pinning its allocation for the
+   * lifetime of the sender.
+   */
+  void clear() noexcept
+  {
+    m_size = 0;
+    m_external.clear();
+    m_external_size = 0;
+    if (m_capacity > m_max_retained_capacity) {
+      m_data.reset();
+      m_capacity = 0;
+    }
+  }
+
+  /**
+   * @brief The message as a list of segments, in order
+   *
+   * Without external segments this is a single segment covering data()/size().
+   */
+  std::vector<BufferSegment> segments() const
+  {
+    std::vector<BufferSegment> result;
+    size_t offset = 0;
+    for (auto& ext : m_external) {
+      if (ext.offset > offset) {
+        result.push_back({ m_data.get() + offset, ext.offset - offset });
+      }
+      result.push_back(ext.segment);
+      offset = ext.offset;
+    }
+    if (m_size > offset || result.empty()) {
+      result.push_back({ m_data.get() + offset, m_size - offset });
+    }
+    return result;
+  }
+
+  /**
+   * @brief Minimum size of byte arrays referenced rather than copied, 0 disables gathering
+   */
+  void set_gather_threshold(size_t threshold) noexcept { m_gather_threshold = threshold; }
+  size_t get_gather_threshold() const noexcept { return m_gather_threshold; }
+
+  /**
+   * @brief Whether the message references external segments, in which case data()/size() are not the whole message
+   */
+  bool has_external_segments() const noexcept { return !m_external.empty(); }
+  size_t external_size() const noexcept { return m_external_size; }
+
+  const uint8_t* data() const noexcept { return m_data.get(); }
+  uint8_t* data() noexcept { return m_data.get(); }
+  size_t size() const noexcept { return m_size; }
+  size_t capacity() const noexcept { return m_capacity; }
+  bool empty() const noexcept { return m_size == 0; }
+
+private:
+  struct ExternalSegment
+  {
+    size_t offset; // Position within m_data at which the segment is inserted
+    BufferSegment segment;
+  };
+
+  std::unique_ptr<uint8_t[]> m_data{ nullptr }; // NOLINT(modernize-avoid-c-arrays)
+  size_t m_size{ 0 };
+  size_t m_capacity{ 0 };
+  size_t m_max_retained_capacity;
+  size_t m_gather_threshold{ 0 };
+  std::vector<ExternalSegment> m_external;
+  size_t m_external_size{ 0 };
+};
+
+namespace detail {
+
+// Buffer currently being serialized into on this thread, consulted by adaptors of types which can be gathered
+inline thread_local SerializationBuffer* t_gather_target = nullptr;
+
+class GatherTargetGuard
+{
+public:
+  explicit GatherTargetGuard(SerializationBuffer* target)
+    : m_previous(t_gather_target)
+  {
+    t_gather_target = target;
+  }
+  ~GatherTargetGuard() { t_gather_target = m_previous; }
+
+  GatherTargetGuard(GatherTargetGuard const&) = delete;
+  GatherTargetGuard& operator=(GatherTargetGuard const&) = delete;
+
+private:
+  SerializationBuffer* m_previous;
+};
+
+} // namespace detail
+
+/**
+ * @brief Serialize an object into an existing buffer
+ *
+ * Produces exactly the same bytes as dunedaq::serialization::serialize, so the receiving
+ * side can use dunedaq::serialization::deserialize unchanged. The buffer is cleared first.
+ * If the buffer has a gather threshold, large SharedBuffer payloads are referenced in place
+ * and the message must be sent using buffer.segments().
+ */
+template<class T>
+void
+serialize_into(const T& obj,
+               SerializationBuffer& buffer,
+               serialization::SerializationType stype = serialization::kMsgPack)
+{
+  buffer.clear();
+  switch (stype) {
+    case serialization::kMsgPack: {
+      const char type_byte = static_cast<char>(serialization::serialization_type_byte(stype));
+      buffer.write(&type_byte, 1);
+      detail::GatherTargetGuard guard(buffer.get_gather_threshold() > 0 ? &buffer : nullptr);
+      msgpack::pack(buffer, obj);
+      break;
+    }
+    default:
+      throw OperationFailed(ERS_HERE, "Unsupported serialization type for serialize_into");
+  }
+}
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONBUFFER_HPP_
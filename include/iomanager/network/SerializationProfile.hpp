@@ -0,0 +1,87 @@
+/**
+ * @file SerializationProfile.hpp
+ *
+ * Optional per-datatype profiling of message serialization and deserialization
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONPROFILE_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONPROFILE_HPP_
+
+#include "opmonlib/MonitorableObject.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq::iomanager {
+
+/**
+ * Whether the network models profile (de)serialization. Set by building with the CMake option
+ * IOMANAGER_SERIALIZATION_PROFILING; otherwise the profiling code is discarded at compile time.
+ */
+#ifdef IOMANAGER_SERIALIZATION_PROFILING
+constexpr bool s_serialization_profiling = true;
+#else
+constexpr bool s_serialization_profiling = false;
+#endif
+
+/**
+ * @brief Histograms of the serialized sizes and the encode/decode times of one data type
+ *
+ * Shared by all network Senders and Receivers of the data type, and published in opmon by
+ * NetworkManager under "serialization".
+ */
+class SerializationProfile : public opmonlib::MonitorableObject
+{
+public:
+  // Bucket 0 counts zero values, bucket i values in [2^(i-1), 2^i), the last one all larger values
+  static constexpr size_t s_histogram_buckets = 32;
+
+  enum Direction
+  {
+    kEncode,
+    kDecode
+  };
+
+  explicit SerializationProfile(std::string data_type);
+
+  SerializationProfile(SerializationProfile const&) = delete;
+  SerializationProfile(SerializationProfile&&) = delete;
+  SerializationProfile& operator=(SerializationProfile const&) = delete;
+  SerializationProfile& operator=(SerializationProfile&&) = delete;
+
+  void record(Direction direction, size_t bytes, std::chrono::steady_clock::duration duration);
+
+  static size_t get_bucket(uint64_t value);
+
+  std::string const& get_data_type() const { return m_data_type; }
+  uint64_t get_message_count(Direction direction) const { return m_histograms[direction].messages.load(); }
+
+protected:
+  void generate_opmon_data() override;
+
+private:
+  struct Histograms
+  {
+    std::atomic<uint64_t> messages{ 0 }; // Since creation
+    std::atomic<uint64_t> interval_messages{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> time_ns{ 0 };
+    std::array<std::atomic<uint64_t>, s_histogram_buckets> sizes{};
+    std::array<std::atomic<uint64_t>, s_histogram_buckets> times{};
+  };
+
+  std::string m_data_type;
+  std::array<Histograms, 2> m_histograms;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SERIALIZATIONPROFILE_HPP_
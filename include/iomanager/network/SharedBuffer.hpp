@@ -0,0 +1,271 @@
+/**
+ * @file SharedBuffer.hpp
+ *
+ * Reference-counted view of received network data, used for zero-copy deserialization
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDBUFFER_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDBUFFER_HPP_
+
+#include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/RawSerialization.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include "serialization/Serialization.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Immutable view of a byte range whose storage is kept alive by a shared owner
+ *
+ * Copying a SharedBuffer only copies the view, never the bytes. A SharedBuffer which was
+ * delivered by a NetworkReceiverModel references the buffer the message was received into,
+ * so the received bytes stay allocated for as long as any view of them exists.
+ *
+ * SharedBuffer is serializable (as a msgpack bin) and can be used either as the message type
+ * of a connection or as a member of a DUNE_DAQ_SERIALIZE'd struct carrying a large payload.
+ * Senders whose transport supports vectored sends transmit large SharedBuffers in place.
+ */
+class SharedBuffer
+{
+public:
+  SharedBuffer() = default;
+
+  /**
+   * @brief Take ownership of a vector without copying its contents
+   */
+  explicit SharedBuffer(std::vector<uint8_t>&& data)
+  {
+    auto storage = std::make_shared<std::vector<uint8_t>>(std::move(data));
+    m_data = storage->data();
+    m_size = storage->size();
+    m_owner = std::move(storage);
+  }
+
+  /**
+   * @brief Copy size bytes starting at data into a new buffer
+   */
+  SharedBuffer(const uint8_t* data, size_t size)
+    : SharedBuffer(std::vector<uint8_t>(data, data + size))
+  {
+  }
+
+  /**
+   * @brief View size bytes at data, which remain valid for as long as owner is alive
+   */
+  SharedBuffer(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+    : m_owner(std::move(owner))
+    , m_data(data)
+    , m_size(size)
+  {
+  }
+
+  const uint8_t* data() const noexcept { return m_data; }
+  size_t size() const noexcept { return m_size; }
+  bool empty() const noexcept { return m_size == 0; }
+  const uint8_t* begin() const noexcept { return m_data; }
+  const uint8_t* end() const noexcept { return m_data + m_size; }
+
+  /**
+   * @brief View of a sub-range of this buffer, sharing its owner
+   */
+  SharedBuffer slice(size_t offset, size_t size) const
+  {
+    if (offset > m_size || size > m_size - offset) {
+      throw std::out_of_range("SharedBuffer::slice range [" + std::to_string(offset) + ", " +
+                              std::to_string(offset + size) + ") exceeds buffer size " + std::to_string(m_size));
+    }
+    return SharedBuffer(m_owner, m_data + offset, size);
+  }
+
+  /**
+   * @brief Whether the given byte range lies entirely within this buffer
+   */
+  bool contains(const void* ptr, size_t size) const noexcept
+  {
+    auto p = static_cast<const uint8_t*>(ptr);
+    return m_data != nullptr && p >= m_data && p <= end() && size <= static_cast<size_t>(end() - p);
+  }
+
+  /**
+   * @brief Copy the viewed bytes into a new vector
+   */
+  std::vector<uint8_t> to_vector() const { return std::vector<uint8_t>(begin(), end()); }
+
+  /**
+   * @brief Number of SharedBuffers (and other owners) keeping the storage alive
+   */
+  long use_count() const noexcept { return m_owner.use_count(); }
+
+  bool operator==(SharedBuffer const& other) const
+  {
+    return m_size == other.m_size && (m_data == other.m_data || std::equal(begin(), end(), other.begin()));
+  }
+  bool operator!=(SharedBuffer const& other) const { return !(*this == other); }
+
+private:
+  std::shared_ptr<const void> m_owner{ nullptr };
+  const uint8_t* m_data{ nullptr };
+  size_t m_size{ 0 };
+};
+
+/**
+ * @brief Trait marking types whose bin fields may reference the receive buffer
+ *
+ * Specialize (using DUNE_DAQ_ZERO_COPY_DESERIALIZABLE) for message types containing SharedBuffer
+ * members to have NetworkReceiverModel deliver them without copying those members. Types which
+ * are not marked are deserialized exactly as before, and SharedBuffer members of such types own
+ * a private copy of their bytes.
+ */
+template<typename T>
+struct is_zero_copy_deserializable : std::false_type
+{
+};
+
+template<>
+struct is_zero_copy_deserializable<SharedBuffer> : std::true_type
+{
+};
+
+namespace detail {
+
+// Buffer currently being deserialized on this thread, consulted by the SharedBuffer msgpack adaptor
+inline thread_local const SharedBuffer* t_zero_copy_source = nullptr;
+
+class ZeroCopySourceGuard
+{
+public:
+  explicit ZeroCopySourceGuard(const SharedBuffer* source)
+    : m_previous(t_zero_copy_source)
+  {
+    t_zero_copy_source = source;
+  }
+  ~ZeroCopySourceGuard() { t_zero_copy_source = m_previous; }
+
+  ZeroCopySourceGuard(ZeroCopySourceGuard const&) = delete;
+  ZeroCopySourceGuard& operator=(ZeroCopySourceGuard const&) = delete;
+
+private:
+  const SharedBuffer* m_previous;
+};
+
+// Keep bin objects pointing into the input buffer rather than copying them into the unpack zone
+inline bool
+reference_bin_objects(msgpack::type::object_type type, std::size_t, void*)
+{
+  return type == msgpack::type::BIN;
+}
+
+} // namespace detail
+
+/**
+ * @brief Deserialize a received message, taking ownership of its bytes
+ *
+ * For zero-copy types, every SharedBuffer within the message references data instead of a copy.
+ * Raw serializable types are copied out of their raw message. All other types (and messages not
+ * encoded as msgpack) use dunedaq::serialization::deserialize.
+ */
+template<typename T>
+T
+deserialize_shared(std::vector<uint8_t>&& data)
+{
+  if constexpr (is_raw_serializable<T>::value) {
+    return deserialize_raw<T>(data);
+  } else if constexpr (!is_zero_copy_deserializable<T>::value) {
+    return dunedaq::serialization::deserialize<T>(data);
+  } else {
+    if (data.empty() ||
+        data[0] != dunedaq::serialization::serialization_type_byte(dunedaq::serialization::kMsgPack)) {
+      return dunedaq::serialization::deserialize<T>(data);
+    }
+
+    SharedBuffer buffer(std::move(data));
+    try {
+      auto handle = msgpack::unpack(reinterpret_cast<const char*>(buffer.data() + 1), // NOLINT
+                                    buffer.size() - 1,
+                                    &detail::reference_bin_objects,
+                                    nullptr);
+      detail::ZeroCopySourceGuard guard(&buffer);
+      T obj;
+      handle.get().convert(obj);
+      return obj;
+    } catch (msgpack::type_error const& e) {
+      throw MessageDecodeFailed(ERS_HERE, "msgpack", e.what());
+    }
+  }
+}
+
+} // namespace dunedaq::iomanager
+
+namespace msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+{
+  namespace adaptor {
+
+  template<>
+  struct pack<dunedaq::iomanager::SharedBuffer>
+  {
+    template<typename Stream>
+    packer<Stream>& operator()(msgpack::packer<Stream>& o, dunedaq::iomanager::SharedBuffer const& buf) const
+    {
+      o.pack_bin(static_cast<uint32_t>(buf.size()));
+      auto target = dunedaq::iomanager::detail::t_gather_target;
+      if (target != nullptr && target->write_external(buf.data(), buf.size())) {
+        return o;
+      }
+      o.pack_bin_body(reinterpret_cast<const char*>(buf.data()), static_cast<uint32_t>(buf.size())); // NOLINT
+      return o;
+    }
+  };
+
+  template<>
+  struct convert<dunedaq::iomanager::SharedBuffer>
+  {
+    msgpack::object const& operator()(msgpack::object const& o, dunedaq::iomanager::SharedBuffer& buf) const
+    {
+      if (o.type != msgpack::type::BIN) {
+        throw msgpack::type_error();
+      }
+      auto ptr = reinterpret_cast<const uint8_t*>(o.via.bin.ptr); // NOLINT
+      auto source = dunedaq::iomanager::detail::t_zero_copy_source;
+      if (source != nullptr && source->contains(ptr, o.via.bin.size)) {
+        buf = source->slice(static_cast<size_t>(ptr - source->data()), o.via.bin.size);
+      } else {
+        buf = dunedaq::iomanager::SharedBuffer(ptr, o.via.bin.size);
+      }
+      return o;
+    }
+  };
+
+  } // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace msgpack
+
+namespace dunedaq {
+DUNE_DAQ_SERIALIZABLE(iomanager::SharedBuffer, "SharedBuffer");
+} // namespace dunedaq
+
+/**
+ * @brief Mark Type for zero-copy deserialization. Must be used in the dunedaq namespace, like DUNE_DAQ_SERIALIZABLE
+ */
+#define DUNE_DAQ_ZERO_COPY_DESERIALIZABLE(Type)                                                                        \
+  template<>                                                                                                           \
+  struct iomanager::is_zero_copy_deserializable<Type> : std::true_type                                                 \
+  {                                                                                                                    \
+  }
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDBUFFER_HPP_
@@ -0,0 +1,134 @@
+/**
+ * @file SharedSubscriber.hpp
+ *
+ * One subscriber socket shared by the pub/sub receivers of a set of publishers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDSUBSCRIBER_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDSUBSCRIBER_HPP_
+
+#include "ipm/Subscriber.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+class SharedSubscriber;
+
+/**
+ * @brief One receiver's view of a SharedSubscriber
+ *
+ * Implements ipm::Subscriber, so the network receiver models use it like a subscriber of their
+ * own: it receives the messages of the topics it subscribed to, from a queue filled by the
+ * SharedSubscriber. If the queue is full, further messages are dropped, as a slow subscriber's
+ * socket would.
+ */
+class SubscriberChannel : public ipm::Subscriber
+{
+public:
+  SubscriberChannel(std::shared_ptr<SharedSubscriber> shared, std::string name, size_t capacity);
+  ~SubscriberChannel() override;
+
+  SubscriberChannel(SubscriberChannel const&) = delete;
+  SubscriberChannel(SubscriberChannel&&) = delete;
+  SubscriberChannel& operator=(SubscriberChannel const&) = delete;
+  SubscriberChannel& operator=(SubscriberChannel&&) = delete;
+
+  /**
+   * @brief Connects the shared subscriber to any publishers in connection_info it is not yet connected to
+   */
+  std::string connect_for_receives(const nlohmann::json& connection_info) override;
+  bool can_receive() const noexcept override { return true; }
+
+  void subscribe(std::string const& topic) override;
+  void unsubscribe(std::string const& topic) override;
+
+  /**
+   * @brief Queue a message, called by the SharedSubscriber's receive thread
+   */
+  void deliver(Response&& response);
+
+  size_t get_dropped_count() const { return m_dropped.load(); }
+
+protected:
+  Response receive_(const duration_t& timeout, bool no_tmoexcept_mode) override;
+
+private:
+  std::shared_ptr<SharedSubscriber> m_shared;
+  std::string m_name;
+  size_t m_capacity;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<Response> m_queue;  // Protected by m_mutex
+  std::set<std::string> m_topics; // Protected by m_mutex
+  bool m_dropping{ false };       // Protected by m_mutex
+  std::atomic<size_t> m_dropped{ 0 };
+};
+
+/**
+ * @brief Receives from one ipm Subscriber on a dedicated thread and routes messages by topic
+ *
+ * Every message is received once and handed to the channels subscribed to its topic through a
+ * hash table, however many receivers and topics share the socket. The socket is subscribed to a
+ * topic while at least one channel is. Topics are matched exactly, not by prefix.
+ */
+class SharedSubscriber
+{
+public:
+  SharedSubscriber(std::shared_ptr<ipm::Subscriber> subscriber, std::vector<std::string> const& uris);
+  ~SharedSubscriber();
+
+  SharedSubscriber(SharedSubscriber const&) = delete;
+  SharedSubscriber(SharedSubscriber&&) = delete;
+  SharedSubscriber& operator=(SharedSubscriber const&) = delete;
+  SharedSubscriber& operator=(SharedSubscriber&&) = delete;
+
+  /**
+   * @brief Connect to the given publishers as well, if not done already
+   */
+  void connect(std::vector<std::string> const& uris);
+
+  void add_route(std::string const& topic, SubscriberChannel* channel);
+  void remove_route(std::string const& topic, SubscriberChannel* channel);
+
+  size_t get_route_count() const;
+
+private:
+  // Timeout of each receive, which bounds how long destruction waits for the receive thread
+  static constexpr std::chrono::milliseconds s_receive_timeout{ 10 };
+
+  void receive_loop();
+
+  std::shared_ptr<ipm::Subscriber> m_subscriber;
+
+  std::mutex m_connect_mutex;
+  std::set<std::string> m_uris; // Protected by m_connect_mutex
+
+  mutable std::mutex m_routes_mutex;
+  std::unordered_map<std::string, std::vector<SubscriberChannel*>> m_routes; // Protected by m_routes_mutex
+
+  std::atomic<bool> m_running{ true };
+  std::thread m_thread;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHAREDSUBSCRIBER_HPP_
@@ -0,0 +1,145 @@
+/**
+ * @file ShmTransport.hpp
+ *
+ * Shared-memory transport for connections between processes on the same host
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHMTRANSPORT_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHMTRANSPORT_HPP_
+
+#include "iomanager/network/SerializationBuffer.hpp"
+#include "iomanager/network/VectoredSender.hpp"
+
+#include "ipm/Receiver.hpp"
+#include "ipm/Sender.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+constexpr char s_shm_scheme[] = "shm://";
+
+/**
+ * @brief Whether uri selects the shared-memory transport (shm://name)
+ */
+bool
+is_shm_uri(std::string const& uri);
+
+namespace detail {
+struct ShmRingHeader;
+
+/**
+ * @brief A ring mapped from a POSIX shared memory object
+ */
+class ShmMapping
+{
+public:
+  ShmMapping() = default;
+  ~ShmMapping() { unmap(); }
+
+  ShmMapping(ShmMapping const&) = delete;
+  ShmMapping(ShmMapping&&) = delete;
+  ShmMapping& operator=(ShmMapping const&) = delete;
+  ShmMapping& operator=(ShmMapping&&) = delete;
+
+  // Create (replacing any previous one) and initialize a ring of the given capacity
+  void create(std::string const& name, size_t capacity);
+  // Map an existing, initialized ring; throws if there is none (yet)
+  void open(std::string const& name);
+  void unmap();
+
+  bool is_mapped() const { return m_header != nullptr; }
+  ShmRingHeader* header() const { return m_header; }
+  uint8_t* data() const { return m_data; }
+  std::string const& name() const { return m_name; }
+
+private:
+  std::string m_name;
+  ShmRingHeader* m_header{ nullptr };
+  uint8_t* m_data{ nullptr };
+  size_t m_size{ 0 };
+  uint64_t m_inode{ 0 };
+  bool m_owner{ false };
+};
+} // namespace detail
+
+/**
+ * @brief Receiving end of a shared-memory connection
+ *
+ * connect_for_receives creates the ring: a memory-mapped file in /dev/shm holding a lock-free
+ * single-consumer ring of length-prefixed messages. Waiting is done on futexes in the ring, so
+ * neither end makes a system call while the other keeps up. Several senders, also from
+ * different processes, may write to the same ring.
+ */
+class ShmReceiver : public ipm::Receiver
+{
+public:
+  static constexpr size_t s_default_capacity = 64 * 1024 * 1024;
+
+  explicit ShmReceiver(size_t capacity = s_default_capacity);
+  ~ShmReceiver() override;
+
+  std::string connect_for_receives(const nlohmann::json& connection_info) override;
+  bool can_receive() const noexcept override { return m_mapping.is_mapped(); }
+
+protected:
+  Response receive_(const duration_t& timeout, bool no_tmoexcept_mode) override;
+
+private:
+  size_t m_capacity;
+  std::mutex m_receive_mutex;
+  detail::ShmMapping m_mapping;
+};
+
+/**
+ * @brief Sending end of a shared-memory connection
+ *
+ * Copies each message straight into the receiver's ring, and segmented messages without
+ * concatenating them first. Sends fail (as timeouts) once the receiver has closed the ring or
+ * its process has exited, so that the connection is re-established.
+ */
+class ShmSender
+  : public ipm::Sender
+  , public VectoredSender
+{
+public:
+  ShmSender() = default;
+
+  std::string connect_for_sends(const nlohmann::json& connection_info) override;
+  bool can_send() const noexcept override { return m_mapping.is_mapped(); }
+
+  bool send_segments(std::vector<BufferSegment> const& segments,
+                     std::chrono::milliseconds timeout,
+                     std::string const& metadata = "",
+                     bool no_tmoexcept_mode = false) override;
+
+protected:
+  bool send_(const void* message,
+             message_size_t N,
+             const duration_t& timeout,
+             std::string const& topic,
+             bool no_tmoexcept_mode) override;
+
+private:
+  // Whether the receiver is still there, checked at most every s_liveness_interval
+  bool is_receiver_alive(bool force);
+
+  std::mutex m_send_mutex;
+  detail::ShmMapping m_mapping;
+  std::chrono::steady_clock::time_point m_last_liveness_check;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_SHMTRANSPORT_HPP_
@@ -0,0 +1,49 @@
+/**
+ * @file VectoredSender.hpp
+ *
+ * Interface for ipm Senders which can transmit a message from several buffers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_NETWORK_VECTOREDSENDER_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_NETWORK_VECTOREDSENDER_HPP_
+
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+/**
+ * @brief Optional capability of an ipm::Sender implementation
+ *
+ * ipm::Sender::send takes a single contiguous buffer. Transports which can write several
+ * buffers as one message (without first concatenating them) additionally derive from
+ * VectoredSender; NetworkSenderModel detects this and sends large SharedBuffer payloads in
+ * place. The receiving side must deliver exactly the bytes of the concatenated segments as
+ * one message, so receivers cannot tell how a message was sent. Of the transports in use, only
+ * ShmSender implements it; the ipm (ZeroMQ) tcp and inproc senders do not.
+ */
+class VectoredSender
+{
+public:
+  virtual ~VectoredSender() = default;
+
+  /**
+   * @brief Send the concatenation of segments as a single message
+   * @return Whether the message was sent (only false when no_tmoexcept_mode is set)
+   */
+  virtual bool send_segments(std::vector<BufferSegment> const& segments,
+                             std::chrono::milliseconds timeout,
+                             std::string const& metadata = "",
+                             bool no_tmoexcept_mode = false) = 0;
+};
+
+} // namespace dunedaq::iomanager
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_NETWORK_VECTOREDSENDER_HPP_
@@ -0,0 +1,157 @@
+#include "iomanager/CommonIssues.hpp"
+#include "iomanager/network/ConnectionOptions.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "ers/Issue.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+template<typename Datatype>
+inline CallbackPipeline<Datatype>::CallbackPipeline(ReceivePipelineOptions const& options,
+                                                    decoder_t decoder,
+                                                    callback_t callback,
+                                                    error_handler_t error_handler)
+  : m_options(options)
+  , m_decoder(std::move(decoder))
+  , m_callback(std::move(callback))
+  , m_error_handler(std::move(error_handler))
+{
+  m_options.decode_threads = std::max<size_t>(m_options.decode_threads, 1);
+  m_options.max_in_flight = std::max(m_options.max_in_flight, m_options.decode_threads);
+  for (size_t ii = 0; ii < m_options.decode_threads; ++ii) {
+    m_workers.emplace_back(&CallbackPipeline<Datatype>::worker, this);
+  }
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::push(std::vector<uint8_t>&& message)
+{
+  std::unique_lock<std::mutex> lk(m_queue_mutex);
+  m_space_cv.wait(lk, [&] { return m_in_flight < m_options.max_in_flight || !m_running; });
+  if (!m_running) {
+    return;
+  }
+  ++m_in_flight;
+  m_queue.push_back({ m_next_sequence++, std::move(message) });
+  lk.unlock();
+  m_work_cv.notify_one();
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_queue_mutex);
+    m_running = false;
+  }
+  m_work_cv.notify_all();
+  m_space_cv.notify_all();
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  m_workers.clear();
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::worker()
+{
+  while (true) {
+    WorkItem item;
+    {
+      std::unique_lock<std::mutex> lk(m_queue_mutex);
+      m_work_cv.wait(lk, [&] { return !m_queue.empty() || !m_running; });
+      // Queued messages are still delivered after stop()
+      if (m_queue.empty()) {
+        return;
+      }
+      item = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    // A message which fails to decode is delivered empty, so that its turn and its in-flight slot are released
+    std::optional<Datatype> data;
+    try {
+      data.emplace(m_decoder(std::move(item.message)));
+    } catch (ers::Issue const& ex) {
+      m_error_handler(ex);
+    } catch (std::exception const& ex) {
+      m_error_handler(MessageDecodeFailed(ERS_HERE, "received", ex.what()));
+    } catch (...) {
+      m_error_handler(MessageDecodeFailed(ERS_HERE, "received", "unknown exception"));
+    }
+    deliver(item.sequence, std::move(data));
+  }
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::deliver(uint64_t sequence, std::optional<Datatype>&& data)
+{
+  if (!m_options.preserve_order) {
+    if (data) {
+      invoke(*data);
+    }
+    release();
+    return;
+  }
+
+  std::unique_lock<std::mutex> lk(m_reorder_mutex);
+  m_reorder_buffer.emplace(sequence, std::move(data));
+  if (m_delivering) {
+    // The delivering worker will pick this message up once its turn comes
+    return;
+  }
+  m_delivering = true;
+  while (!m_reorder_buffer.empty() && m_reorder_buffer.begin()->first == m_next_delivery) {
+    auto node = m_reorder_buffer.extract(m_reorder_buffer.begin());
+    ++m_next_delivery;
+    lk.unlock();
+    if (node.mapped()) {
+      invoke(*node.mapped());
+    }
+    release();
+    lk.lock();
+  }
+  m_delivering = false;
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::invoke(Datatype& data)
+{
+  try {
+    m_callback(data);
+  } catch (ers::Issue const& ex) {
+    m_error_handler(ex);
+  } catch (std::exception const& ex) {
+    m_error_handler(OperationFailed(ERS_HERE, std::string("Callback threw: ") + ex.what()));
+  } catch (...) {
+    m_error_handler(OperationFailed(ERS_HERE, "Callback threw an unknown exception"));
+  }
+}
+
+template<typename Datatype>
+inline void
+CallbackPipeline<Datatype>::release()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_queue_mutex);
+    --m_in_flight;
+  }
+  m_space_cv.notify_one();
+}
+
+} // namespace dunedaq::iomanager
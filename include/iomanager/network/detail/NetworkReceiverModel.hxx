@@ -1,19 +1,32 @@
+#include "iomanager/Instrumentation.hpp"
 #include "iomanager/Receiver.hpp"
+#include "iomanager/TraceContext.hpp"
+#include "iomanager/network/CallbackPipeline.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/MessageTracing.hpp"
 #include "iomanager/network/NetworkIssues.hpp"
 #include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/SharedBuffer.hpp"
+#include "iomanager/queue/QueueIssues.hpp" // ReceiveCallbackConflict
+#include "iomanager/opmon/network.pb.h"
 
 #include "ipm/Subscriber.hpp"
 #include "logging/Logging.hpp"
 #include "serialization/Serialization.hpp"
 #include "utilities/ReusableThread.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
 #include <thread>
 #include <typeinfo>
 #include <utility>
+#include <vector>
 
 namespace dunedaq {
 
@@ -24,10 +37,26 @@ inline NetworkReceiverModel<Datatype>::NetworkReceiverModel(ConnectionId const&
   : ReceiverConcept<Datatype>(conn_id)
 {
   TLOG() << "NetworkReceiverModel created with DT! ID: " << conn_id.uid << " Addr: " << static_cast<void*>(this);
-  try {
-    get_receiver(std::chrono::milliseconds(1000));
-  } catch (ConnectionNotFound const& ex) {
-    TLOG() << "Initial connection attempt failed: " << ex;
+  // Connect in the background; connections which are immediately available are ready before we return, the
+  // others are waited for by the first receive (up to s_initial_connection_budget after construction)
+  m_initial_deadline = std::chrono::steady_clock::now() + s_initial_connection_budget;
+  if constexpr (s_serialization_profiling) {
+    m_serialization_profile = NetworkManager::get().get_serialization_profile(conn_id.data_type);
+  }
+  m_trace_statistics = NetworkManager::get().get_trace_statistics(conn_id);
+  auto options = NetworkManager::get().get_connection_options(conn_id);
+  m_receive_pipeline = options.receive_pipeline;
+  m_flow_control = options.flow_control;
+  if (m_flow_control.enabled) {
+    m_credit_grantor = std::make_unique<CreditGrantor>(conn_id, m_flow_control);
+    if (!m_credit_grantor->is_enabled()) {
+      m_credit_grantor.reset();
+    }
+  }
+  m_receiver_future = NetworkManager::get().request_receiver(conn_id, s_initial_connection_budget);
+  get_receiver(s_initial_wait, false);
+  if (m_network_receiver_ptr == nullptr) {
+    TLOG() << "Connection not yet established for " << conn_id.uid << ", continuing in background";
   }
 }
 
@@ -38,6 +67,14 @@ inline NetworkReceiverModel<Datatype>::NetworkReceiverModel(NetworkReceiverModel
   , m_callback(std::move(other.m_callback))
   , m_event_loop_runner(std::move(other.m_event_loop_runner))
   , m_network_receiver_ptr(std::move(other.m_network_receiver_ptr))
+  , m_receiver_future(std::move(other.m_receiver_future))
+  , m_initial_deadline(other.m_initial_deadline)
+  , m_pending_messages(std::move(other.m_pending_messages))
+  , m_receive_pipeline(other.m_receive_pipeline)
+  , m_flow_control(other.m_flow_control)
+  , m_credit_grantor(std::move(other.m_credit_grantor))
+  , m_serialization_profile(std::move(other.m_serialization_profile))
+  , m_trace_statistics(std::move(other.m_trace_statistics))
 {
 }
 
@@ -72,6 +109,13 @@ inline void
 NetworkReceiverModel<Datatype>::subscribe(std::string topic)
 {
   if (NetworkManager::get().is_pubsub_connection(this->m_conn)) {
+    {
+      std::lock_guard<std::mutex> lk(m_receive_mutex);
+      get_receiver(Receiver::s_no_block);
+    }
+    if (m_network_receiver_ptr == nullptr) {
+      throw ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
+    }
     std::dynamic_pointer_cast<ipm::Subscriber>(m_network_receiver_ptr)->subscribe(topic);
   }
 }
@@ -81,24 +125,171 @@ inline void
 NetworkReceiverModel<Datatype>::unsubscribe(std::string topic)
 {
   if (NetworkManager::get().is_pubsub_connection(this->m_conn)) {
+    {
+      std::lock_guard<std::mutex> lk(m_receive_mutex);
+      get_receiver(Receiver::s_no_block);
+    }
+    if (m_network_receiver_ptr == nullptr) {
+      throw ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
+    }
     std::dynamic_pointer_cast<ipm::Subscriber>(m_network_receiver_ptr)->unsubscribe(topic);
   }
 }
 
 template<typename Datatype>
 inline void
-NetworkReceiverModel<Datatype>::get_receiver(Receiver::timeout_t timeout)
+NetworkReceiverModel<Datatype>::get_receiver(Receiver::timeout_t timeout, bool use_initial_budget)
+{
+  if (m_network_receiver_ptr != nullptr) {
+    return;
+  }
+
+  // Never wait longer than the caller allows. The request made on construction gives up at the end of the
+  // initial budget, so there is no point waiting on it beyond that either
+  auto wait = timeout;
+  if (use_initial_budget && wait != Receiver::s_block) {
+    auto remaining =
+      std::chrono::duration_cast<Receiver::timeout_t>(m_initial_deadline - std::chrono::steady_clock::now());
+    if (remaining > Receiver::s_no_block) {
+      wait = std::min(wait, remaining);
+    }
+  }
+
+  // Re-request the connection if the previous request gave up. The background attempt keeps trying for at least
+  // s_initial_wait, so that non-blocking polls can still connect, and at most s_initial_connection_budget, so that
+  // a blocking call does not leave an attempt running forever
+  if (!m_receiver_future.valid() ||
+      (m_receiver_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+       m_receiver_future.get() == nullptr)) {
+    auto give_up_after = std::clamp(timeout, s_initial_wait, s_initial_connection_budget);
+    m_receiver_future = NetworkManager::get().request_receiver(this->id(), give_up_after);
+  }
+
+  if (wait == Receiver::s_block) {
+    m_receiver_future.wait();
+  } else if (m_receiver_future.wait_for(wait) != std::future_status::ready) {
+    return;
+  }
+  m_network_receiver_ptr = m_receiver_future.get();
+}
+
+template<typename Datatype>
+inline std::unique_lock<std::mutex>
+NetworkReceiverModel<Datatype>::lock_receive_mutex()
+{
+  // Only look at the clock if the mutex is held by someone else
+  std::unique_lock<std::mutex> lk(m_receive_mutex, std::try_to_lock);
+  if (!lk.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lk.lock();
+    m_metrics.add_time(NetworkMetrics::kLockWaitNs, std::chrono::steady_clock::now() - start);
+    m_metrics.add(NetworkMetrics::kLockContentions);
+  }
+  return lk;
+}
+
+template<typename Datatype>
+template<typename MessageType>
+inline MessageType
+NetworkReceiverModel<Datatype>::decode_message(std::vector<uint8_t>&& message)
 {
-  // get network resources
+  auto size = message.size();
+  TraceContext trace;
+  if (!message.empty() && message[0] == s_trace_frame_type) {
+    trace = unwrap_trace_envelope(message);
+    m_trace_statistics->record(trace);
+    set_current_trace(trace);
+  } else {
+    clear_current_trace();
+  }
+
   auto start = std::chrono::steady_clock::now();
-  while (m_network_receiver_ptr == nullptr &&
-         std::chrono::duration_cast<Receiver::timeout_t>(std::chrono::steady_clock::now() - start) < timeout) {
+  auto data = deserialize_shared<MessageType>(std::move(message));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  m_metrics.add_time(NetworkMetrics::kSerializationTimeNs, elapsed);
+  m_metrics.record(elapsed);
+  m_metrics.add(NetworkMetrics::kMessages);
+  m_metrics.add(NetworkMetrics::kBytes, size);
+  IOMANAGER_PROBE(receiver_receive, this->id().uid, size);
+  if constexpr (s_serialization_profiling) {
+    m_serialization_profile->record(SerializationProfile::kDecode, size, elapsed);
+  }
+  if constexpr (has_trace_context<MessageType>::value) {
+    if (trace.is_active()) {
+      data.trace_context = trace;
+    }
+  }
+  return data;
+}
 
-    try {
-      m_network_receiver_ptr = NetworkManager::get().get_receiver(this->id());
-    } catch (ConnectionNotFound const& ex) {
-      m_network_receiver_ptr = nullptr;
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+template<typename Datatype>
+inline void
+NetworkReceiverModel<Datatype>::generate_opmon_data()
+{
+  auto snapshot = m_metrics.collect();
+  auto& counters = snapshot.counters;
+  opmon::NetworkReceiverInfo info;
+  info.set_messages_received(counters[NetworkMetrics::kMessages]);
+  info.set_bytes_received(counters[NetworkMetrics::kBytes]);
+  info.set_receive_timeouts(counters[NetworkMetrics::kFailures]);
+  info.set_transport_time_us(counters[NetworkMetrics::kTransportTimeNs] / 1000);
+  info.set_deserialization_time_us(counters[NetworkMetrics::kSerializationTimeNs] / 1000);
+  info.set_lock_wait_time_us(counters[NetworkMetrics::kLockWaitNs] / 1000);
+  info.set_lock_contentions(counters[NetworkMetrics::kLockContentions]);
+  info.set_callback_time_us(counters[NetworkMetrics::kCallbackTimeNs] / 1000);
+  for (auto count : snapshot.histogram) {
+    info.add_deserialization_time_histogram(count);
+  }
+  publish(std::move(info));
+}
+
+template<typename Datatype>
+inline std::optional<std::vector<uint8_t>>
+NetworkReceiverModel<Datatype>::receive_message(Receiver::timeout_t const& timeout, bool no_tmoexcept_mode)
+{
+  if (m_pending_messages.empty()) {
+    auto response = receive_frame(*m_network_receiver_ptr, timeout, no_tmoexcept_mode);
+    if (response.data.size() == 0) {
+      return std::nullopt;
+    }
+    unpack_frame(std::move(response.data), m_pending_messages);
+    if (m_pending_messages.empty()) {
+      return std::nullopt;
+    }
+  }
+
+  auto message = std::move(m_pending_messages.front());
+  m_pending_messages.pop_front();
+  if (m_credit_grantor != nullptr) {
+    m_credit_grantor->on_delivered();
+  }
+  return message;
+}
+
+template<typename Datatype>
+inline ipm::Receiver::Response
+NetworkReceiverModel<Datatype>::receive_frame(ipm::Receiver& receiver,
+                                              Receiver::timeout_t const& timeout,
+                                              bool no_tmoexcept_mode)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (m_credit_grantor == nullptr) {
+    auto response = receiver.receive(timeout, ipm::Receiver::s_any_size, no_tmoexcept_mode);
+    m_metrics.add_time(NetworkMetrics::kTransportTimeNs, std::chrono::steady_clock::now() - start);
+    return response;
+  }
+
+  // Keep granting credit while waiting, the sender may be waiting for it
+  while (true) {
+    m_credit_grantor->update();
+    auto elapsed = std::chrono::duration_cast<Receiver::timeout_t>(std::chrono::steady_clock::now() - start);
+    auto remaining = timeout > elapsed ? timeout - elapsed : Receiver::s_no_block;
+    auto wait = std::min(remaining, m_flow_control.grant_interval);
+    bool last = wait == remaining;
+    auto response = receiver.receive(wait, ipm::Receiver::s_any_size, last ? no_tmoexcept_mode : true);
+    if (response.data.size() > 0 || last) {
+      m_metrics.add_time(NetworkMetrics::kTransportTimeNs, std::chrono::steady_clock::now() - start);
+      return response;
     }
   }
 }
@@ -108,18 +299,29 @@ template<typename MessageType>
 inline typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, MessageType>::type
 NetworkReceiverModel<Datatype>::read_network(Receiver::timeout_t const& timeout)
 {
-  std::lock_guard<std::mutex> lk(m_receive_mutex);
+  if (m_with_callback) {
+    TLOG() << "NetworkReceiverModel is equipped with callback! Ignoring receive call.";
+    throw ReceiveCallbackConflict(ERS_HERE, this->id().uid);
+  }
+  auto lk = lock_receive_mutex();
   get_receiver(timeout);
 
   if (m_network_receiver_ptr == nullptr) {
     throw ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
   }
 
-  auto response = m_network_receiver_ptr->receive(timeout);
-  if (response.data.size() > 0) {
-    return dunedaq::serialization::deserialize<MessageType>(response.data);
+  std::optional<std::vector<uint8_t>> message;
+  try {
+    message = receive_message(timeout, false);
+  } catch (ipm::ReceiveTimeoutExpired const&) {
+    m_metrics.add(NetworkMetrics::kFailures);
+    throw;
+  }
+  if (message && message->size() > 0) {
+    return decode_message<MessageType>(std::move(*message));
   }
 
+  m_metrics.add(NetworkMetrics::kFailures);
   throw TimeoutExpired(ERS_HERE, this->id().uid, "network receive", timeout.count());
   return MessageType();
 }
@@ -139,20 +341,24 @@ inline
   typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, std::optional<MessageType>>::type
   NetworkReceiverModel<Datatype>::try_read_network(Receiver::timeout_t const& timeout)
 {
-  std::lock_guard<std::mutex> lk(m_receive_mutex);
+  if (m_with_callback) {
+    TLOG() << "NetworkReceiverModel is equipped with callback! Ignoring receive call.";
+    ers::error(ReceiveCallbackConflict(ERS_HERE, this->id().uid));
+    return std::nullopt;
+  }
+  auto lk = lock_receive_mutex();
   get_receiver(timeout);
   if (m_network_receiver_ptr == nullptr) {
     TLOG() << ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
     return std::nullopt;
   }
 
-  ipm::Receiver::Response res;
-  res = m_network_receiver_ptr->receive(timeout, ipm::Receiver::s_any_size, true);
-
-  if (res.data.size() > 0) {
-    return std::make_optional<MessageType>(dunedaq::serialization::deserialize<MessageType>(res.data));
+  auto message = receive_message(timeout, true);
+  if (message && message->size() > 0) {
+    return std::make_optional<MessageType>(decode_message<MessageType>(std::move(*message)));
   }
 
+  m_metrics.add(NetworkMetrics::kFailures);
   return std::nullopt;
 }
 
@@ -179,19 +385,90 @@ NetworkReceiverModel<Datatype>::add_callback_impl(std::function<void(MessageType
   m_callback = callback;
   m_with_callback = true;
   // start event loop (thread that calls when receive happens)
-  m_event_loop_runner = std::make_unique<std::thread>([&]() {
-    std::optional<Datatype> message;
-    while (m_with_callback.load() || message) {
-      try {
-        message = try_read_network<Datatype>(std::chrono::milliseconds(1));
-        if (message) {
-          m_callback(*message);
+  m_event_loop_runner = std::make_unique<std::thread>(&NetworkReceiverModel<Datatype>::callback_loop, this);
+}
+
+template<typename Datatype>
+inline void
+NetworkReceiverModel<Datatype>::callback_loop()
+{
+  // The loop owns reception while the callback is registered, so it keeps the receiver and any
+  // pending messages to itself instead of taking m_receive_mutex for every message
+  std::shared_ptr<ipm::Receiver> receiver;
+  std::deque<std::vector<uint8_t>> messages;
+  while (m_with_callback.load() && receiver == nullptr) {
+    std::lock_guard<std::mutex> lk(m_receive_mutex);
+    get_receiver(s_callback_receive_timeout);
+    receiver = m_network_receiver_ptr;
+    if (receiver != nullptr) {
+      messages.swap(m_pending_messages);
+    }
+  }
+
+  // With decode threads, this thread only receives and the pipeline deserializes and invokes the callback
+  std::unique_ptr<CallbackPipeline<Datatype>> pipeline;
+  if (m_receive_pipeline.decode_threads > 0) {
+    pipeline = std::make_unique<CallbackPipeline<Datatype>>(
+      m_receive_pipeline,
+      [this](std::vector<uint8_t>&& message) { return decode_message<Datatype>(std::move(message)); },
+      [this](Datatype& data) {
+        // Workers deliver messages decoded by other workers, so the trace can only come with the message
+        TraceContext trace;
+        if constexpr (has_trace_context<Datatype>::value) {
+          trace = data.trace_context;
         }
-      } catch (const ers::Issue&) {
-        ;
+        ScopedTraceContext scope(trace);
+        auto start = std::chrono::steady_clock::now();
+        m_callback(data);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        m_metrics.add_time(NetworkMetrics::kCallbackTimeNs, elapsed);
+        IOMANAGER_PROBE(
+          callback_invoke, this->id().uid, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      },
+      [this](ers::Issue const& ex) { ers::warning(CallbackReceiveFailed(ERS_HERE, this->id().uid, ex)); });
+  }
+
+  while (m_with_callback.load() || !messages.empty()) {
+    try {
+      if (messages.empty()) {
+        auto response = receive_frame(*receiver, s_callback_receive_timeout, true);
+        if (response.data.size() == 0) {
+          continue;
+        }
+        unpack_frame(std::move(response.data), messages);
       }
+      // Messages already received are delivered even if the callback is being removed
+      while (!messages.empty()) {
+        auto message = std::move(messages.front());
+        messages.pop_front();
+        if (m_credit_grantor != nullptr) {
+          m_credit_grantor->on_delivered();
+        }
+        if (message.size() == 0) {
+          continue;
+        }
+        if (pipeline != nullptr) {
+          pipeline->push(std::move(message));
+          continue;
+        }
+        auto data = decode_message<Datatype>(std::move(message));
+        auto start = std::chrono::steady_clock::now();
+        m_callback(data);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        m_metrics.add_time(NetworkMetrics::kCallbackTimeNs, elapsed);
+        IOMANAGER_PROBE(
+          callback_invoke, this->id().uid, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+      }
+    } catch (const ers::Issue& ex) {
+      ers::warning(CallbackReceiveFailed(ERS_HERE, this->id().uid, ex));
+    } catch (const std::exception& ex) {
+      ers::warning(CallbackReceiveFailed(ERS_HERE, this->id().uid, OperationFailed(ERS_HERE, ex.what())));
     }
-  });
+  }
+
+  if (pipeline != nullptr) {
+    pipeline->stop();
+  }
 }
 
 template<typename Datatype>
@@ -1,11 +1,22 @@
+#include "iomanager/Instrumentation.hpp"
 #include "iomanager/Sender.hpp"
 #include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/MessageCompression.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/MessageTracing.hpp"
 #include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/RawSerialization.hpp"
+#include "iomanager/network/SerializationBuffer.hpp"
+#include "iomanager/network/VectoredSender.hpp"
+#include "iomanager/opmon/network.pb.h"
 
 #include "ipm/Sender.hpp"
 #include "logging/Logging.hpp"
 #include "serialization/Serialization.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <memory>
 #include <string>
 #include <typeinfo>
@@ -19,25 +30,120 @@ inline NetworkSenderModel<Datatype>::NetworkSenderModel(ConnectionId const& conn
 {
   TLOG("NetworkSenderModel") << "NetworkSenderModel created with DT! Addr: " << static_cast<void*>(this)
                              << ", uid=" << conn_id.uid << ", data_type=" << conn_id.data_type;
-  get_sender(std::chrono::milliseconds(1000));
+  // Connect in the background; connections which are immediately available are ready before we return, the
+  // others are waited for by the first send (up to s_initial_connection_budget after construction)
+  m_initial_deadline = std::chrono::steady_clock::now() + s_initial_connection_budget;
+  // Connections established during the configure warm-up have completed their handshake already
+  if (NetworkManager::get().is_warm_sender(conn_id)) {
+    m_first = false;
+  }
+  if constexpr (s_serialization_profiling) {
+    m_serialization_profile = NetworkManager::get().get_serialization_profile(conn_id.data_type);
+  }
+  auto options = NetworkManager::get().get_connection_options(conn_id);
+  m_reconnect = options.reconnect;
+  m_reconnect_backoff = ExponentialBackoff(m_reconnect.initial_backoff, m_reconnect.max_backoff, m_reconnect.jitter);
+  m_coalescing = options.coalescing;
+  if (m_coalescing.enabled) {
+    start_flush_thread();
+  }
+  m_trace_sample_interval = options.tracing.sample_interval;
+  m_messages_until_trace = m_trace_sample_interval;
+  if (options.flow_control.enabled) {
+    m_credit_tracker = std::make_unique<CreditTracker>(conn_id, options.flow_control);
+    if (!m_credit_tracker->is_enabled()) {
+      m_credit_tracker.reset();
+    }
+  }
+  if (options.compression.algorithm != CompressionAlgorithm::kNone) {
+    m_compressor = std::make_shared<MessageCompressor>(conn_id.uid, options.compression);
+    NetworkManager::get().register_compressor(conn_id, m_compressor);
+  }
+  m_sender_future = NetworkManager::get().request_sender(conn_id, s_initial_connection_budget);
+  get_sender(s_initial_wait, false);
   if (m_network_sender_ptr == nullptr) {
-    TLOG("NetworkSenderModel") << "Initial connection attempt failed for uid=" << conn_id.uid
-                               << ", data_type=" << conn_id.data_type;
+    TLOG("NetworkSenderModel") << "Connection not yet established for uid=" << conn_id.uid
+                               << ", data_type=" << conn_id.data_type << ", continuing in background";
+  }
+  m_async = options.async_send;
+  if (m_async.enabled && dunedaq::serialization::is_serializable<Datatype>::value) {
+    start_async_thread();
   }
 }
 
 template<typename Datatype>
 inline NetworkSenderModel<Datatype>::NetworkSenderModel(NetworkSenderModel&& other)
-  : SenderConcept<Datatype>(other.m_conn.uid)
-  , m_network_sender_ptr(std::move(other.m_network_sender_ptr))
-  , m_topic(std::move(other.m_topic))
+  : SenderConcept<Datatype>(other.m_conn)
 {
+  // other's threads must not touch the batch, the sender or the credit tracker once they have been moved. Its
+  // async thread sends everything still queued before exiting, so messages it holds go out in order
+  other.stop_async_thread();
+  other.stop_flush_thread();
+  {
+    std::lock_guard<std::mutex> lk(other.m_send_mutex);
+    other.m_async_queue.reset();
+    m_network_sender_ptr = std::move(other.m_network_sender_ptr);
+    m_vectored_sender = other.m_vectored_sender;
+    other.m_vectored_sender = nullptr;
+    m_sender_future = std::move(other.m_sender_future);
+    m_initial_deadline = other.m_initial_deadline;
+    m_topic = std::move(other.m_topic);
+    m_first = other.m_first.load();
+    m_reconnect = other.m_reconnect;
+    m_reconnect_backoff = ExponentialBackoff(m_reconnect.initial_backoff, m_reconnect.max_backoff, m_reconnect.jitter);
+    m_reconnecting = other.m_reconnecting.load();
+    m_coalescing = other.m_coalescing;
+    std::swap(m_batch, other.m_batch);
+    m_batch_topic = std::move(other.m_batch_topic);
+    m_batch_timeout = other.m_batch_timeout;
+    m_batch_deadline = other.m_batch_deadline;
+    m_credit_tracker = std::move(other.m_credit_tracker);
+    m_serialization_profile = std::move(other.m_serialization_profile);
+    m_compressor = other.m_compressor;
+    m_trace_sample_interval = other.m_trace_sample_interval;
+    m_messages_until_trace = other.m_messages_until_trace;
+    m_async = other.m_async;
+  }
+  if (m_coalescing.enabled) {
+    start_flush_thread();
+  }
+  if (m_async.enabled && dunedaq::serialization::is_serializable<Datatype>::value) {
+    start_async_thread();
+  }
+}
+
+template<typename Datatype>
+inline NetworkSenderModel<Datatype>::~NetworkSenderModel()
+{
+  stop_async_thread();
+  stop_flush_thread();
+  std::lock_guard<std::mutex> lk(m_send_mutex);
+  if (!m_batch.empty()) {
+    auto count = m_batch.message_count();
+    if (m_network_sender_ptr == nullptr) {
+      ers::warning(BatchDropped(ERS_HERE, this->id().uid, count));
+      return;
+    }
+    try {
+      if (!flush_batch(m_batch_timeout, true)) {
+        ers::warning(BatchDropped(ERS_HERE, this->id().uid, count));
+      }
+    } catch (ers::Issue const& ex) {
+      ers::warning(BatchDropped(ERS_HERE, this->id().uid, count, ex));
+    }
+  }
 }
 
 template<typename Datatype>
 inline void
 NetworkSenderModel<Datatype>::send(Datatype&& data, Sender::timeout_t timeout) // NOLINT
 {
+  if (m_async_queue != nullptr) {
+    if (!enqueue_async(std::move(data), timeout, std::nullopt)) {
+      throw TimeoutExpired(ERS_HERE, this->id().uid, "send", timeout.count());
+    }
+    return;
+  }
   try {
     write_network<Datatype>(data, timeout);
   } catch (ipm::SendTimeoutExpired& ex) {
@@ -49,6 +155,13 @@ template<typename Datatype>
 inline bool
 NetworkSenderModel<Datatype>::try_send(Datatype&& data, Sender::timeout_t timeout) // NOLINT
 {
+  if (m_async_queue != nullptr) {
+    if (!enqueue_async(std::move(data), timeout, std::nullopt)) {
+      TLOG("NetworkSenderModel") << "Send queue of uid=" << this->id().uid << " is full";
+      return false;
+    }
+    return true;
+  }
   return try_write_network<Datatype>(data, timeout);
 }
 
@@ -56,6 +169,12 @@ template<typename Datatype>
 inline void
 NetworkSenderModel<Datatype>::send_with_topic(Datatype&& data, Sender::timeout_t timeout, std::string topic) // NOLINT
 {
+  if (m_async_queue != nullptr) {
+    if (!enqueue_async(std::move(data), timeout, std::move(topic))) {
+      throw TimeoutExpired(ERS_HERE, this->id().uid, "send", timeout.count());
+    }
+    return;
+  }
   try {
     write_network_with_topic<Datatype>(data, timeout, topic);
   } catch (ipm::SendTimeoutExpired& ex) {
@@ -67,30 +186,526 @@ template<typename Datatype>
 inline bool
 NetworkSenderModel<Datatype>::is_ready_for_sending(Sender::timeout_t timeout) // NOLINT
 {
-  get_sender(timeout);
-  return (m_network_sender_ptr != nullptr);
+  auto start = std::chrono::steady_clock::now();
+  {
+    // The connection members are shared with the send paths and the flush and async send threads
+    auto lk = lock_send_mutex();
+    if (m_reconnecting) {
+      poll_reconnect(remaining(start, timeout));
+    } else {
+      get_sender(remaining(start, timeout), false);
+    }
+    if (m_network_sender_ptr == nullptr) {
+      return false;
+    }
+  }
+  return wait_for_credit(remaining(start, timeout));
+}
+
+template<typename Datatype>
+inline Sender::timeout_t
+NetworkSenderModel<Datatype>::remaining(std::chrono::steady_clock::time_point start, Sender::timeout_t const& timeout)
+{
+  if (timeout == Sender::s_block) {
+    return timeout;
+  }
+  auto elapsed = std::chrono::duration_cast<Sender::timeout_t>(std::chrono::steady_clock::now() - start);
+  return timeout > elapsed ? timeout - elapsed : Sender::s_no_block;
+}
+
+template<typename Datatype>
+inline std::optional<size_t>
+NetworkSenderModel<Datatype>::available_credit()
+{
+  if (m_credit_tracker == nullptr) {
+    return std::nullopt;
+  }
+  return m_credit_tracker->available();
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::wait_for_credit(Sender::timeout_t const& timeout)
+{
+  return m_credit_tracker == nullptr || m_credit_tracker->wait_for_credit(timeout);
 }
 
 template<typename Datatype>
 inline void
-NetworkSenderModel<Datatype>::get_sender(Sender::timeout_t const& timeout)
+NetworkSenderModel<Datatype>::flush(Sender::timeout_t timeout) // NOLINT
 {
-  auto start = std::chrono::steady_clock::now();
-  while (m_network_sender_ptr == nullptr &&
-         std::chrono::duration_cast<Sender::timeout_t>(std::chrono::steady_clock::now() - start) <= timeout) {
-    // get network resources
-    try {
-      m_network_sender_ptr = NetworkManager::get().get_sender(this->id());
+  if (m_async_queue != nullptr) {
+    std::unique_lock<std::mutex> lk(m_async_mutex);
+    auto idle = [&] { return m_async_pending == 0; };
+    if (timeout == Sender::s_block) {
+      m_async_idle_cv.wait(lk, idle);
+    } else if (!m_async_idle_cv.wait_for(lk, timeout, idle)) {
+      throw TimeoutExpired(ERS_HERE, this->id().uid, "flush", timeout.count());
+    }
+  }
+
+  std::lock_guard<std::mutex> lk(m_send_mutex);
+  if (m_batch.empty()) {
+    return;
+  }
+  try {
+    flush_batch(timeout, false);
+  } catch (ipm::SendTimeoutExpired& ex) {
+    drop_sender();
+    throw TimeoutExpired(ERS_HERE, this->id().uid, "flush", timeout.count(), ex);
+  }
+}
+
+template<typename Datatype>
+inline std::unique_lock<std::mutex>
+NetworkSenderModel<Datatype>::lock_send_mutex()
+{
+  // Only look at the clock if the mutex is held by someone else
+  std::unique_lock<std::mutex> lk(m_send_mutex, std::try_to_lock);
+  if (!lk.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lk.lock();
+    m_metrics.add_time(NetworkMetrics::kLockWaitNs, std::chrono::steady_clock::now() - start);
+    m_metrics.add(NetworkMetrics::kLockContentions);
+  }
+  return lk;
+}
 
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::record_send(std::chrono::steady_clock::time_point start, bool sent)
+{
+  if (sent) {
+    auto bytes = m_serialization_buffer.size() + m_serialization_buffer.external_size();
+    m_metrics.add(NetworkMetrics::kMessages);
+    m_metrics.add(NetworkMetrics::kBytes, bytes);
+    IOMANAGER_PROBE(sender_send, this->id().uid, bytes);
+  } else {
+    m_metrics.add(NetworkMetrics::kFailures);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  m_metrics.add_time(NetworkMetrics::kTotalTimeNs, elapsed);
+  m_metrics.record(elapsed);
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::generate_opmon_data()
+{
+  auto snapshot = m_metrics.collect();
+  auto& counters = snapshot.counters;
+  opmon::NetworkSenderInfo info;
+  info.set_messages_sent(counters[NetworkMetrics::kMessages]);
+  info.set_bytes_sent(counters[NetworkMetrics::kBytes]);
+  info.set_send_failures(counters[NetworkMetrics::kFailures]);
+  info.set_send_time_us(counters[NetworkMetrics::kTotalTimeNs] / 1000);
+  info.set_transport_time_us(counters[NetworkMetrics::kTransportTimeNs] / 1000);
+  info.set_serialization_time_us(counters[NetworkMetrics::kSerializationTimeNs] / 1000);
+  info.set_lock_wait_time_us(counters[NetworkMetrics::kLockWaitNs] / 1000);
+  info.set_lock_contentions(counters[NetworkMetrics::kLockContentions]);
+  info.set_reconnect_attempts(counters[NetworkMetrics::kReconnectAttempts]);
+  info.set_reconnects(counters[NetworkMetrics::kReconnects]);
+  for (auto count : snapshot.histogram) {
+    info.add_send_time_histogram(count);
+  }
+  publish(std::move(info));
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::get_sender(Sender::timeout_t const& timeout, bool use_initial_budget)
+{
+  if (m_network_sender_ptr != nullptr) {
+    return;
+  }
+  if (m_reconnecting) {
+    // Never wait for a reconnection in the send path
+    poll_reconnect(Sender::s_no_block);
+    return;
+  }
+
+  // Never wait longer than the caller allows. The request made on construction gives up at the end of the
+  // initial budget, so there is no point waiting on it beyond that either
+  auto wait = timeout;
+  if (use_initial_budget && wait != Sender::s_block) {
+    auto remaining =
+      std::chrono::duration_cast<Sender::timeout_t>(m_initial_deadline - std::chrono::steady_clock::now());
+    if (remaining > Sender::s_no_block) {
+      wait = std::min(wait, remaining);
+    }
+  }
+
+  // Re-request the connection if the previous request gave up (or the connection was dropped). The background
+  // attempt keeps trying for at least s_initial_wait, so that non-blocking polls can still connect, and at most
+  // s_initial_connection_budget, so that a blocking call does not leave an attempt running forever
+  if (!m_sender_future.valid() ||
+      (m_sender_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+       m_sender_future.get() == nullptr)) {
+    auto give_up_after = std::clamp(timeout, s_initial_wait, s_initial_connection_budget);
+    m_sender_future = NetworkManager::get().request_sender(this->id(), give_up_after);
+  }
+
+  if (wait == Sender::s_block) {
+    m_sender_future.wait();
+  } else if (m_sender_future.wait_for(wait) != std::future_status::ready) {
+    return;
+  }
+
+  m_network_sender_ptr = m_sender_future.get();
+  if (m_network_sender_ptr != nullptr) {
+    try {
       if (NetworkManager::get().is_pubsub_connection(this->id())) {
         TLOG("NetworkSenderModel") << "Setting topic to " << this->id().data_type;
         m_topic = this->id().data_type;
       }
     } catch (ers::Issue const& ex) {
+      TLOG("NetworkSenderModel") << "Could not determine connection type for uid=" << this->id().uid << ": " << ex;
       m_network_sender_ptr = nullptr;
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
   }
+  m_vectored_sender = dynamic_cast<VectoredSender*>(m_network_sender_ptr.get());
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::drop_sender()
+{
+  if (m_network_sender_ptr == nullptr) {
+    return;
+  }
+  TLOG("NetworkSenderModel") << "Timeout detected, removing sender to re-acquire connection";
+  NetworkManager::get().remove_sender(this->id());
+  m_network_sender_ptr = nullptr;
+  m_vectored_sender = nullptr;
+  schedule_reconnect();
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::schedule_reconnect()
+{
+  auto delay = m_reconnect_backoff.next();
+  TLOG("NetworkSenderModel") << "Reconnecting uid=" << this->id().uid << " in " << delay.count() << " ms (attempt "
+                             << m_reconnect_backoff.get_retries() << ")";
+  m_reconnecting = true;
+  m_metrics.add(NetworkMetrics::kReconnectAttempts);
+  m_sender_future = NetworkManager::get().request_sender(this->id(), delay + m_reconnect.max_backoff, delay);
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::poll_reconnect(Sender::timeout_t const& timeout)
+{
+  if (!m_sender_future.valid()) {
+    schedule_reconnect();
+  }
+  if (timeout == Sender::s_block) {
+    m_sender_future.wait();
+  } else if (m_sender_future.wait_for(timeout) != std::future_status::ready) {
+    return;
+  }
+
+  auto sender = m_sender_future.get();
+  if (sender == nullptr) {
+    // The replacement could not be connected either, back off further
+    schedule_reconnect();
+    return;
+  }
+  TLOG("NetworkSenderModel") << "Connection for uid=" << this->id().uid << " re-established";
+  m_network_sender_ptr = sender;
+  m_vectored_sender = dynamic_cast<VectoredSender*>(m_network_sender_ptr.get());
+  m_reconnecting = false;
+  m_metrics.add(NetworkMetrics::kReconnects);
+}
+
+template<typename Datatype>
+template<typename MessageType>
+inline TraceContext
+NetworkSenderModel<Datatype>::get_trace_context(MessageType const& message)
+{
+  if constexpr (has_trace_context<MessageType>::value) {
+    if (message.trace_context.is_active()) {
+      return message.trace_context;
+    }
+  }
+  if (get_current_trace().is_active()) {
+    return get_current_trace();
+  }
+  if (m_trace_sample_interval > 0 && --m_messages_until_trace == 0) {
+    m_messages_until_trace = m_trace_sample_interval;
+    return TraceContext::start();
+  }
+  return TraceContext();
+}
+
+template<typename Datatype>
+template<typename MessageType>
+inline void
+NetworkSenderModel<Datatype>::serialize_message(MessageType const& message)
+{
+  // Only reference payloads in place if they can be handed to the transport that way
+  bool gather = m_vectored_sender != nullptr && !m_coalescing.enabled && m_compressor == nullptr;
+  m_serialization_buffer.set_gather_threshold(gather ? s_gather_threshold : 0);
+  auto start = std::chrono::steady_clock::now();
+  if constexpr (is_raw_serializable<MessageType>::value) {
+    serialize_raw(message, m_serialization_buffer);
+  } else {
+    serialize_into(message, m_serialization_buffer);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  m_metrics.add_time(NetworkMetrics::kSerializationTimeNs, elapsed);
+  if constexpr (s_serialization_profiling) {
+    m_serialization_profile->record(SerializationProfile::kEncode,
+                                    m_serialization_buffer.size() + m_serialization_buffer.external_size(),
+                                    elapsed);
+  }
+
+  // Traced messages are copied behind their envelope, the rest of the send path sees a single message either way
+  auto trace = get_trace_context(message);
+  if (trace.is_active()) {
+    trace.add_hop(TraceContext::now_ns());
+    wrap_trace_envelope(trace, m_serialization_buffer, m_trace_buffer);
+    std::swap(m_serialization_buffer, m_trace_buffer);
+  }
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::send_serialized(Sender::timeout_t const& timeout,
+                                              std::string const& topic,
+                                              bool no_tmoexcept_mode)
+{
+  if (m_vectored_sender != nullptr && m_serialization_buffer.has_external_segments()) {
+    auto start = std::chrono::steady_clock::now();
+    auto sent = m_vectored_sender->send_segments(m_serialization_buffer.segments(), timeout, topic, no_tmoexcept_mode);
+    m_metrics.add_time(NetworkMetrics::kTransportTimeNs, std::chrono::steady_clock::now() - start);
+    return sent;
+  }
+  return send_frame(m_serialization_buffer.data(), m_serialization_buffer.size(), timeout, topic, no_tmoexcept_mode);
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::send_frame(const uint8_t* data,
+                                         size_t size,
+                                         Sender::timeout_t const& timeout,
+                                         std::string const& topic,
+                                         bool no_tmoexcept_mode)
+{
+  if (m_compressor != nullptr && m_compressor->compress(data, size, m_compression_buffer)) {
+    data = m_compression_buffer.data();
+    size = m_compression_buffer.size();
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto sent = m_network_sender_ptr->send(data, size, timeout, topic, no_tmoexcept_mode);
+  m_metrics.add_time(NetworkMetrics::kTransportTimeNs, std::chrono::steady_clock::now() - start);
+  return sent;
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::dispatch_serialized(Sender::timeout_t const& timeout,
+                                                  std::string const& topic,
+                                                  bool no_tmoexcept_mode)
+{
+  if (!m_coalescing.enabled) {
+    return send_serialized(timeout, topic, no_tmoexcept_mode);
+  }
+
+  // A batch is sent with a single topic
+  if (!m_batch.empty() && topic != m_batch_topic && !flush_batch(timeout, no_tmoexcept_mode)) {
+    return false;
+  }
+
+  // Large messages gain nothing from batching, keep ordering by sending the batch first
+  if (m_serialization_buffer.size() >= m_coalescing.max_batch_bytes) {
+    if (!m_batch.empty() && !flush_batch(timeout, no_tmoexcept_mode)) {
+      return false;
+    }
+    return send_serialized(timeout, topic, no_tmoexcept_mode);
+  }
+
+  if (m_batch.empty()) {
+    m_batch_topic = topic;
+    m_batch_timeout = timeout;
+    m_batch_deadline = std::chrono::steady_clock::now() + m_coalescing.max_delay;
+    m_flush_cv.notify_all();
+  }
+  m_batch.append(m_serialization_buffer.data(), m_serialization_buffer.size());
+
+  if (m_batch.size() >= m_coalescing.max_batch_bytes) {
+    return flush_batch(timeout, no_tmoexcept_mode);
+  }
+  return true;
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::flush_batch(Sender::timeout_t const& timeout, bool no_tmoexcept_mode)
+{
+  if (m_batch.empty()) {
+    return true;
+  }
+  // A batch which could not be sent is dropped, like a single message would be
+  if (m_network_sender_ptr == nullptr) {
+    m_batch.clear();
+    if (!no_tmoexcept_mode) {
+      throw ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
+    }
+    return false;
+  }
+
+  TLOG_DEBUG(20) << "Sending batch of " << m_batch.message_count() << " messages (" << m_batch.size()
+                 << " bytes) on " << this->id().uid;
+  bool res = false;
+  try {
+    res = send_frame(m_batch.data(), m_batch.size(), timeout, m_batch_topic, no_tmoexcept_mode);
+  } catch (...) {
+    m_batch.clear();
+    throw;
+  }
+  m_batch.clear();
+  return res;
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::start_flush_thread()
+{
+  m_flush_thread_running = true;
+  m_flush_thread = std::make_unique<std::thread>(&NetworkSenderModel<Datatype>::flush_thread, this);
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::stop_flush_thread()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_send_mutex);
+    m_flush_thread_running = false;
+  }
+  m_flush_cv.notify_all();
+  if (m_flush_thread != nullptr && m_flush_thread->joinable()) {
+    m_flush_thread->join();
+  }
+  m_flush_thread.reset();
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::flush_thread()
+{
+  std::unique_lock<std::mutex> lk(m_send_mutex);
+  while (m_flush_thread_running) {
+    if (m_batch.empty()) {
+      m_flush_cv.wait(lk);
+      continue;
+    }
+    if (std::chrono::steady_clock::now() < m_batch_deadline) {
+      m_flush_cv.wait_until(lk, m_batch_deadline);
+      continue;
+    }
+
+    // Use the replacement connection if it is ready, without holding up senders waiting for it
+    if (m_reconnecting) {
+      poll_reconnect(Sender::s_no_block);
+    }
+
+    // The senders of these messages have already returned, so failures can only be reported. The
+    // batch is dropped either way, so a missing connection costs one warning, not one per wake-up.
+    auto count = m_batch.message_count();
+    try {
+      if (!flush_batch(m_batch_timeout, true)) {
+        ers::warning(BatchDropped(ERS_HERE, this->id().uid, count));
+        m_metrics.add(NetworkMetrics::kFailures, count);
+        drop_sender();
+      }
+    } catch (ers::Issue const& ex) {
+      ers::warning(BatchDropped(ERS_HERE, this->id().uid, count, ex));
+      m_metrics.add(NetworkMetrics::kFailures, count);
+    }
+  }
+}
+
+template<typename Datatype>
+inline bool
+NetworkSenderModel<Datatype>::enqueue_async(Datatype&& data,
+                                           Sender::timeout_t const& timeout,
+                                           std::optional<std::string> topic)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_async_mutex);
+    ++m_async_pending;
+  }
+  AsyncSendItem item{ std::move(data), timeout, std::move(topic), get_current_trace() };
+  bool queued = true;
+  if (timeout == Sender::s_block) {
+    m_async_queue->enqueue(std::move(item));
+  } else {
+    queued = m_async_queue->try_enqueue_for(std::move(item), timeout);
+  }
+  if (!queued) {
+    {
+      std::lock_guard<std::mutex> lk(m_async_mutex);
+      --m_async_pending;
+    }
+    m_async_idle_cv.notify_all();
+  }
+  return queued;
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::start_async_thread()
+{
+  m_async_queue = std::make_unique<folly::DMPMCQueue<AsyncSendItem, true>>(std::max<size_t>(m_async.queue_capacity, 1));
+  m_async_thread_running = true;
+  m_async_thread = std::make_unique<std::thread>(&NetworkSenderModel<Datatype>::async_thread, this);
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::stop_async_thread()
+{
+  // The thread sends everything still queued before exiting
+  m_async_thread_running = false;
+  if (m_async_thread != nullptr && m_async_thread->joinable()) {
+    m_async_thread->join();
+  }
+  m_async_thread.reset();
+}
+
+template<typename Datatype>
+inline void
+NetworkSenderModel<Datatype>::async_thread()
+{
+  while (true) {
+    AsyncSendItem item;
+    if (!m_async_queue->try_dequeue_for(item, s_async_poll_interval)) {
+      if (!m_async_thread_running.load()) {
+        break;
+      }
+      continue;
+    }
+
+    // The sender of this message has already returned, so failures can only be reported
+    try {
+      ScopedTraceContext trace(item.trace);
+      if (item.topic) {
+        write_network_with_topic<Datatype>(*item.data, item.timeout, *item.topic);
+      } else {
+        write_network<Datatype>(*item.data, item.timeout);
+      }
+    } catch (ers::Issue const& ex) {
+      ers::warning(AsyncSendFailed(ERS_HERE, this->id().uid, ex));
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(m_async_mutex);
+      --m_async_pending;
+    }
+    m_async_idle_cv.notify_all();
+  }
 }
 
 template<typename Datatype>
@@ -98,26 +713,40 @@ template<typename MessageType>
 inline typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, void>::type
 NetworkSenderModel<Datatype>::write_network(MessageType& message, Sender::timeout_t const& timeout)
 {
-  std::lock_guard<std::mutex> lk(m_send_mutex);
-  get_sender(timeout);
+  auto start = std::chrono::steady_clock::now();
+  auto lk = lock_send_mutex();
+  // Waiting for the lock, the connection and credit all come out of the caller's timeout
+  get_sender(remaining(start, timeout));
   if (m_network_sender_ptr == nullptr) {
+    record_send(start, false);
+    if (m_reconnecting) {
+      throw ConnectionReconnecting(ERS_HERE, this->id().uid, "send", timeout.count());
+    }
     throw TimeoutExpired(
       ERS_HERE, this->id().uid, "send", timeout.count(), ConnectionInstanceNotFound(ERS_HERE, this->id().uid));
   }
+  // A receiver which has not granted credit is busy, not disconnected, so the connection is kept
+  if (!wait_for_credit(remaining(start, timeout))) {
+    record_send(start, false);
+    throw TimeoutExpired(ERS_HERE, this->id().uid, "send (no flow control credit)", timeout.count());
+  }
 
-  auto serialized = dunedaq::serialization::serialize(message, dunedaq::serialization::kMsgPack);
-  //  TLOG("NetworkSenderModel") << "Serialized message for network sending: " << serialized.size() << ", topic=" <<
-  //  m_topic << ", this="
-  //  << (void*)this;
+  serialize_message(message);
+  //  TLOG("NetworkSenderModel") << "Serialized message for network sending: " << m_serialization_buffer.size()
+  //  << ", topic=" << m_topic << ", this=" << (void*)this;
 
   try {
-    m_network_sender_ptr->send(serialized.data(), serialized.size(), extend_first_timeout(timeout), m_topic);
+    dispatch_serialized(extend_first_timeout(remaining(start, timeout)), m_topic);
   } catch (ipm::SendTimeoutExpired const& ex) {
-    TLOG("NetworkSenderModel") << "Timeout detected, removing sender to re-acquire connection";
-    NetworkManager::get().remove_sender(this->id());
-    m_network_sender_ptr = nullptr;
+    record_send(start, false);
+    drop_sender();
     throw;
   }
+  m_reconnect_backoff.reset();
+  if (m_credit_tracker != nullptr) {
+    m_credit_tracker->on_sent();
+  }
+  record_send(start, true);
 }
 
 template<typename Datatype>
@@ -133,26 +762,40 @@ template<typename MessageType>
 inline typename std::enable_if<dunedaq::serialization::is_serializable<MessageType>::value, bool>::type
 NetworkSenderModel<Datatype>::try_write_network(MessageType& message, Sender::timeout_t const& timeout)
 {
-  std::lock_guard<std::mutex> lk(m_send_mutex);
-  get_sender(timeout);
+  auto start = std::chrono::steady_clock::now();
+  auto lk = lock_send_mutex();
+  get_sender(remaining(start, timeout));
   if (m_network_sender_ptr == nullptr) {
-    TLOG("NetworkSenderModel") << ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
+    record_send(start, false);
+    if (m_reconnecting) {
+      TLOG("NetworkSenderModel") << ConnectionReconnecting(ERS_HERE, this->id().uid, "send", timeout.count());
+    } else {
+      TLOG("NetworkSenderModel") << ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
+    }
+    return false;
+  }
+  if (!wait_for_credit(remaining(start, timeout))) {
+    record_send(start, false);
+    TLOG("NetworkSenderModel") << "No flow control credit for uid=" << this->id().uid;
     return false;
   }
 
-  auto serialized = dunedaq::serialization::serialize(message, dunedaq::serialization::kMsgPack);
-  // TLOG("NetworkSenderModel") << "Serialized message for network sending: " << serialized.size() << ", topic=" <<
-  // m_topic <<
-  // ", this=" << (void*)this;
+  serialize_message(message);
+  // TLOG("NetworkSenderModel") << "Serialized message for network sending: " << m_serialization_buffer.size()
+  // << ", topic=" << m_topic << ", this=" << (void*)this;
 
-  auto res =
-    m_network_sender_ptr->send(serialized.data(), serialized.size(), extend_first_timeout(timeout), m_topic, true);
+  auto res = dispatch_serialized(extend_first_timeout(remaining(start, timeout)), m_topic, true);
   if (!res) {
-    TLOG("NetworkSenderModel") << "Timeout detected, removing sender to re-acquire connection";
-    NetworkManager::get().remove_sender(this->id());
-    m_network_sender_ptr = nullptr;
+    record_send(start, false);
+    drop_sender();
+    return false;
   }
-  return res;
+  m_reconnect_backoff.reset();
+  if (m_credit_tracker != nullptr) {
+    m_credit_tracker->on_sent();
+  }
+  record_send(start, true);
+  return true;
 }
 
 template<typename Datatype>
@@ -171,24 +814,38 @@ NetworkSenderModel<Datatype>::write_network_with_topic(MessageType& message,
                                                        Sender::timeout_t const& timeout,
                                                        std::string topic)
 {
-  std::lock_guard<std::mutex> lk(m_send_mutex);
-  get_sender(timeout);
+  auto start = std::chrono::steady_clock::now();
+  auto lk = lock_send_mutex();
+  get_sender(remaining(start, timeout));
   if (m_network_sender_ptr == nullptr) {
+    record_send(start, false);
+    if (m_reconnecting) {
+      throw ConnectionReconnecting(ERS_HERE, this->id().uid, "send", timeout.count());
+    }
     throw TimeoutExpired(
       ERS_HERE, this->id().uid, "send", timeout.count(), ConnectionInstanceNotFound(ERS_HERE, this->id().uid));
   }
+  if (!wait_for_credit(remaining(start, timeout))) {
+    record_send(start, false);
+    throw TimeoutExpired(ERS_HERE, this->id().uid, "send (no flow control credit)", timeout.count());
+  }
 
-  auto serialized = dunedaq::serialization::serialize(message, dunedaq::serialization::kMsgPack);
-  //  TLOG("NetworkSenderModel") << "Serialized message for network sending: " << serialized.size() << ", topic=" <<
-  //  m_topic << ", this="
-  //  << (void*)this;
+  serialize_message(message);
+  //  TLOG("NetworkSenderModel") << "Serialized message for network sending: " << m_serialization_buffer.size()
+  //  << ", topic=" << m_topic << ", this=" << (void*)this;
 
   try {
-    m_network_sender_ptr->send(serialized.data(), serialized.size(), timeout, topic);
-  } catch (TimeoutExpired const& ex) {
-    m_network_sender_ptr = nullptr;
+    dispatch_serialized(remaining(start, timeout), topic);
+  } catch (ipm::SendTimeoutExpired const& ex) {
+    record_send(start, false);
+    drop_sender();
     throw;
   }
+  m_reconnect_backoff.reset();
+  if (m_credit_tracker != nullptr) {
+    m_credit_tracker->on_sent();
+  }
+  record_send(start, true);
 }
 
 template<typename Datatype>
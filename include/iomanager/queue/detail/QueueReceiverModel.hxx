@@ -1,11 +1,14 @@
 
+#include "iomanager/Instrumentation.hpp"
 #include "iomanager/Receiver.hpp"
+#include "iomanager/TraceContext.hpp"
 #include "iomanager/queue/QueueIssues.hpp"
 #include "iomanager/queue/QueueRegistry.hpp"
 
 #include "logging/Logging.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <optional>
 #include <string>
@@ -56,6 +59,8 @@ QueueReceiverModel<Datatype>::receive(Receiver::timeout_t timeout)
   } catch (QueueTimeoutExpired& ex) {
     throw TimeoutExpired(ERS_HERE, this->id().uid, "pop", timeout.count(), ex);
   }
+  IOMANAGER_PROBE(queue_pop, this->id().uid, 1);
+  adopt_trace(dt);
   return dt;
   // if (m_queue->write(
 }
@@ -77,6 +82,8 @@ QueueReceiverModel<Datatype>::try_receive(Receiver::timeout_t timeout)
   Datatype dt;
   auto ret = m_queue->try_pop(dt, timeout);
   if (ret) {
+    IOMANAGER_PROBE(queue_pop, this->id().uid, 1);
+    adopt_trace(dt);
     return std::make_optional(std::move(dt));
   }
   return std::nullopt;
@@ -99,7 +106,18 @@ QueueReceiverModel<Datatype>::add_callback(std::function<void(Datatype&)> callba
       // TLOG() << "Take data from q then invoke callback...";
       ret = m_queue->try_pop(dt, std::chrono::milliseconds(1));
       if (ret) {
-        m_callback(dt);
+        IOMANAGER_PROBE(queue_pop, this->id().uid, 1);
+        adopt_trace(dt);
+        if constexpr (s_instrumentation_level == InstrumentationLevel::kNone) {
+          m_callback(dt);
+        } else {
+          auto start = std::chrono::steady_clock::now();
+          m_callback(dt);
+          IOMANAGER_PROBE(callback_invoke,
+                          this->id().uid,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                            .count());
+        }
       }
     }
   });
@@ -1,5 +1,7 @@
 
+#include "iomanager/Instrumentation.hpp"
 #include "iomanager/Sender.hpp"
+#include "iomanager/TraceContext.hpp"
 #include "iomanager/queue/QueueIssues.hpp"
 #include "iomanager/queue/QueueRegistry.hpp"
 
@@ -29,7 +31,12 @@ QueueSenderModel<Datatype>::try_send(Datatype&& data, Sender::timeout_t timeout)
     return false;
   }
 
-  return m_queue->try_push(std::move(data), timeout);
+  attach_current_trace(data);
+  if (!m_queue->try_push(std::move(data), timeout)) {
+    return false;
+  }
+  IOMANAGER_PROBE(queue_push, this->id().uid, 1);
+  return true;
 }
 
 template<typename Datatype>
@@ -39,11 +46,13 @@ QueueSenderModel<Datatype>::send(Datatype&& data, Sender::timeout_t timeout) //
   if (m_queue == nullptr)
     throw ConnectionInstanceNotFound(ERS_HERE, this->id().uid);
 
+  attach_current_trace(data);
   try {
     m_queue->push(std::move(data), timeout);
   } catch (QueueTimeoutExpired& ex) {
     throw TimeoutExpired(ERS_HERE, this->id().uid, "push", timeout.count(), ex);
   }
+  IOMANAGER_PROBE(queue_push, this->id().uid, 1);
 }
 
 template<typename Datatype>
@@ -0,0 +1,237 @@
+/**
+ * @file SyntheticConfiguration.hpp
+ *
+ * Synthetic confmodel configurations for the unit tests and benchmark applications
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_INCLUDE_IOMANAGER_TEST_SYNTHETICCONFIGURATION_HPP_
+#define IOMANAGER_INCLUDE_IOMANAGER_TEST_SYNTHETICCONFIGURATION_HPP_
+
+#include "conffwk/Configuration.hpp"
+#include "confmodel/ConnectivityService.hpp"
+#include "confmodel/NetworkConnection.hpp"
+#include "confmodel/Queue.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager::test {
+
+/**
+ * @brief Builds an OKS database of Queues and NetworkConnections in a temporary file and loads it
+ *
+ * The objects are written in the same format as the files in test/config, so that tests and
+ * benchmarks can generate configurations of any size, or with names unique to the process,
+ * without checked-in data files. Every NetworkConnection gets
+ * its own Service. The loaded objects stay valid for the lifetime of the SyntheticConfiguration.
+ */
+class SyntheticConfiguration
+{
+public:
+  SyntheticConfiguration() = default;
+  ~SyntheticConfiguration()
+  {
+    std::error_code ec;
+    if (!m_path.empty()) {
+      std::filesystem::remove(m_path, ec);
+    }
+  }
+
+  SyntheticConfiguration(SyntheticConfiguration const&) = delete;
+  SyntheticConfiguration& operator=(SyntheticConfiguration const&) = delete;
+
+  // queue_type is a confmodel Queue queue_type, e.g. "kFollyMPMCQueue"
+  void add_queue(std::string const& uid,
+                 std::string const& data_type,
+                 std::string const& queue_type,
+                 size_t capacity,
+                 uint32_t timeout_ms = 10)
+  {
+    m_objects << "<obj class=\"Queue\" id=\"" << uid << "\">\n"
+              << " <attr name=\"data_type\" type=\"string\" val=\"" << data_type << "\"/>\n"
+              << " <attr name=\"send_timeout_ms\" type=\"u32\" val=\"" << timeout_ms << "\"/>\n"
+              << " <attr name=\"recv_timeout_ms\" type=\"u32\" val=\"" << timeout_ms << "\"/>\n"
+              << " <attr name=\"capacity\" type=\"u32\" val=\"" << capacity << "\"/>\n"
+              << " <attr name=\"queue_type\" type=\"enum\" val=\"" << queue_type << "\"/>\n"
+              << "</obj>\n\n";
+    ++m_object_count;
+    ++m_item_count;
+  }
+
+  /**
+   * @param connection_type "kSendRecv" or "kPubSub"
+   * @param protocol "tcp", "inproc" or "shm"; path is used for inproc and shm, port for tcp (0 for any)
+   */
+  void add_network_connection(std::string const& uid,
+                              std::string const& data_type,
+                              std::string const& connection_type,
+                              std::string const& protocol,
+                              std::string const& path,
+                              uint16_t port = 0,
+                              uint32_t timeout_ms = 10)
+  {
+    m_objects << "<obj class=\"NetworkConnection\" id=\"" << uid << "\">\n"
+              << " <attr name=\"data_type\" type=\"string\" val=\"" << data_type << "\"/>\n"
+              << " <attr name=\"send_timeout_ms\" type=\"u32\" val=\"" << timeout_ms << "\"/>\n"
+              << " <attr name=\"recv_timeout_ms\" type=\"u32\" val=\"" << timeout_ms << "\"/>\n"
+              << " <attr name=\"connection_type\" type=\"enum\" val=\"" << connection_type << "\"/>\n"
+              << " <rel name=\"associated_service\" class=\"Service\" id=\"" << uid << "_service\"/>\n"
+              << "</obj>\n\n";
+    add_service(uid + "_service", protocol, path, port);
+    ++m_object_count;
+    ++m_item_count;
+  }
+
+  // Add the ConnectivityService returned by get_connectivity_service, e.g. a StandInConnectivityService
+  void set_connectivity_service(std::string const& host, uint16_t port, uint32_t interval_ms)
+  {
+    m_objects << "<obj class=\"ConnectivityService\" id=\"" << s_connectivity_service_uid << "\">\n"
+              << " <attr name=\"host\" type=\"string\" val=\"" << host << "\"/>\n"
+              << " <attr name=\"interval_ms\" type=\"u32\" val=\"" << interval_ms << "\"/>\n"
+              << " <rel name=\"service\" class=\"Service\" id=\"" << s_connectivity_service_uid << "_service\"/>\n"
+              << "</obj>\n\n";
+    add_service(std::string(s_connectivity_service_uid) + "_service", "http", "", port);
+    ++m_item_count;
+    m_has_connectivity_service = true;
+  }
+
+  // Write the database and load it; may be called once
+  void load()
+  {
+    static std::atomic<size_t> s_file_number{ 0 };
+    m_path = std::filesystem::temp_directory_path() /
+             ("iomanager_synthetic_" + std::to_string(getpid()) + "_" + std::to_string(s_file_number++) + ".data.xml");
+    {
+      std::ofstream file(m_path);
+      file << s_header << "<info name=\"\" type=\"\" num-of-items=\"" << m_item_count
+           << "\" oks-format=\"data\" oks-version=\"862f2957270\"/>\n\n"
+           << "<include>\n <file path=\"schema/confmodel/dunedaq.schema.xml\"/>\n</include>\n\n"
+           << m_objects.str() << "</oks-data>\n";
+      if (!file) {
+        throw std::runtime_error("Cannot write configuration to " + m_path.string());
+      }
+    }
+    m_confdb = std::make_shared<conffwk::Configuration>("oksconflibs:" + m_path.string());
+    m_confdb->get<confmodel::Queue>(m_queues);
+    m_confdb->get<confmodel::NetworkConnection>(m_connections);
+    if (m_has_connectivity_service) {
+      m_connectivity_service = m_confdb->get<confmodel::ConnectivityService>(s_connectivity_service_uid);
+    }
+  }
+
+  std::vector<const confmodel::Queue*> const& get_queues() const { return m_queues; }
+  std::vector<const confmodel::NetworkConnection*> const& get_connections() const { return m_connections; }
+  // nullptr unless set_connectivity_service was called
+  const confmodel::ConnectivityService* get_connectivity_service() const { return m_connectivity_service; }
+  std::shared_ptr<conffwk::Configuration> get_database() const { return m_confdb; }
+  // Number of Queues and NetworkConnections
+  size_t get_object_count() const { return m_object_count; }
+
+protected:
+  void add_service(std::string const& uid, std::string const& protocol, std::string const& path, uint16_t port)
+  {
+    m_objects << "<obj class=\"Service\" id=\"" << uid << "\">\n"
+              << " <attr name=\"protocol\" type=\"string\" val=\"" << protocol << "\"/>\n"
+              << " <attr name=\"port\" type=\"u16\" val=\"" << port << "\"/>\n"
+              << " <attr name=\"path\" type=\"string\" val=\"" << path << "\"/>\n"
+              << "</obj>\n\n";
+    ++m_item_count;
+  }
+
+  std::ostringstream m_objects;
+  size_t m_item_count{ 0 }; // All OKS objects, including Services
+
+private:
+  static constexpr const char* s_connectivity_service_uid = "benchmark_connectivity_service";
+  static constexpr const char* s_header = R"(<?xml version="1.0" encoding="ASCII"?>
+
+<!-- oks-data version 2.2 -->
+
+
+<!DOCTYPE oks-data [
+  <!ELEMENT oks-data (info, (include)?, (comments)?, (obj)+)>
+  <!ELEMENT info EMPTY>
+  <!ATTLIST info
+      name CDATA #IMPLIED
+      type CDATA #IMPLIED
+      num-of-items CDATA #REQUIRED
+      oks-format CDATA #FIXED "data"
+      oks-version CDATA #REQUIRED
+      created-by CDATA #IMPLIED
+      created-on CDATA #IMPLIED
+      creation-time CDATA #IMPLIED
+      last-modified-by CDATA #IMPLIED
+      last-modified-on CDATA #IMPLIED
+      last-modification-time CDATA #IMPLIED
+  >
+  <!ELEMENT include (file)*>
+  <!ELEMENT file EMPTY>
+  <!ATTLIST file
+      path CDATA #REQUIRED
+  >
+  <!ELEMENT comments (comment)*>
+  <!ELEMENT comment EMPTY>
+  <!ATTLIST comment
+      creation-time CDATA #REQUIRED
+      created-by CDATA #REQUIRED
+      created-on CDATA #REQUIRED
+      author CDATA #REQUIRED
+      text CDATA #REQUIRED
+  >
+  <!ELEMENT obj (attr | rel)*>
+  <!ATTLIST obj
+      class CDATA #REQUIRED
+      id CDATA #REQUIRED
+  >
+  <!ELEMENT attr (data)*>
+  <!ATTLIST attr
+      name CDATA #REQUIRED
+      type (bool|s8|u8|s16|u16|s32|u32|s64|u64|float|double|date|time|string|uid|enum|class|-) "-"
+      val CDATA ""
+  >
+  <!ELEMENT data EMPTY>
+  <!ATTLIST data
+      val CDATA #REQUIRED
+  >
+  <!ELEMENT rel (ref)*>
+  <!ATTLIST rel
+      name CDATA #REQUIRED
+      class CDATA ""
+      id CDATA ""
+  >
+  <!ELEMENT ref EMPTY>
+  <!ATTLIST ref
+      class CDATA #REQUIRED
+      id CDATA #REQUIRED
+  >
+]>
+
+<oks-data>
+
+)";
+
+  std::filesystem::path m_path;
+  size_t m_object_count{ 0 };
+  std::shared_ptr<conffwk::Configuration> m_confdb;
+  std::vector<const confmodel::Queue*> m_queues;
+  std::vector<const confmodel::NetworkConnection*> m_connections;
+  bool m_has_connectivity_service{ false };
+  const confmodel::ConnectivityService* m_connectivity_service{ nullptr };
+};
+
+} // namespace dunedaq::iomanager::test
+
+#endif // IOMANAGER_INCLUDE_IOMANAGER_TEST_SYNTHETICCONFIGURATION_HPP_
@@ -7,6 +7,7 @@
  */
 
 #include "iomanager/IOManager.hpp"
+#include "iomanager/Instrumentation.hpp"
 
 #include <memory>
 
@@ -17,17 +18,50 @@ dunedaq::iomanager::IOManager::configure(std::string session,
                                          std::vector<const confmodel::Queue*> queues,
                                          std::vector<const confmodel::NetworkConnection*> connections,
                                          const confmodel::ConnectivityService* connection_service,
-                                         dunedaq::opmonlib::OpMonManager& opmgr)
+                                         dunedaq::opmonlib::OpMonManager& opmgr,
+                                         ConnectionWarmup const& warmup)
 {
   m_session = session;
 
   QueueRegistry::get().configure(queues, opmgr);
   NetworkManager::get().configure(session, connections, connection_service, opmgr);
+  if constexpr (s_instrumentation_level != InstrumentationLevel::kNone) {
+    opmgr.register_node("probes", ProbeCounters::get());
+  }
+
+  m_warmup_results.clear();
+  if (!warmup.empty()) {
+    auto session_warmup = warmup;
+    for (auto& id : session_warmup.senders) {
+      if (id.session == "") {
+        id.session = m_session;
+      }
+    }
+    for (auto& id : session_warmup.receivers) {
+      if (id.session == "") {
+        id.session = m_session;
+      }
+    }
+    m_warmup_results = NetworkManager::get().warm_up(session_warmup);
+  }
+}
+
+void
+dunedaq::iomanager::IOManager::flush_senders()
+{
+  for (auto& [id, sender] : m_senders) {
+    try {
+      sender->flush(s_shutdown_flush_timeout);
+    } catch (ers::Issue const& ex) {
+      ers::warning(ex);
+    }
+  }
 }
 
 void
 dunedaq::iomanager::IOManager::shutdown()
 {
+  flush_senders();
   QueueRegistry::get().shutdown();
   NetworkManager::get().shutdown();
   m_senders.clear();
@@ -37,10 +71,12 @@ dunedaq::iomanager::IOManager::shutdown()
 void
 dunedaq::iomanager::IOManager::reset()
 {
+  flush_senders();
   QueueRegistry::get().reset();
   NetworkManager::get().reset();
   m_senders.clear();
   m_receivers.clear();
+  m_warmup_results.clear();
   s_instance = nullptr;
 }
 
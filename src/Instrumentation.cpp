@@ -0,0 +1,45 @@
+/**
+ * @file Instrumentation.cpp ProbeCounters Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/Instrumentation.hpp"
+
+#include "iomanager/opmon/instrumentation.pb.h"
+
+#include <string>
+#include <utility>
+
+namespace dunedaq::iomanager {
+
+uint64_t
+ProbeCounters::get_hits(size_t probe) const
+{
+  uint64_t hits = 0;
+  for (auto& shard : m_shards) {
+    hits += shard.hits[probe].load(std::memory_order_relaxed);
+  }
+  return hits;
+}
+
+void
+ProbeCounters::generate_opmon_data()
+{
+  for (size_t probe = 0; probe < s_probe_names.size(); ++probe) {
+    opmon::ProbeInfo info;
+    uint64_t hits = 0;
+    uint64_t amount = 0;
+    for (auto& shard : m_shards) {
+      hits += shard.hits[probe].exchange(0, std::memory_order_relaxed);
+      amount += shard.amounts[probe].exchange(0, std::memory_order_relaxed);
+    }
+    info.set_hits(hits);
+    info.set_amount(amount);
+    publish(std::move(info), { { "probe", std::string(s_probe_names[probe]) } });
+  }
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,48 @@
+/**
+ * @file Backoff.cpp ExponentialBackoff Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/Backoff.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace dunedaq::iomanager {
+
+ExponentialBackoff::ExponentialBackoff(std::chrono::milliseconds initial, std::chrono::milliseconds max, double jitter)
+  : m_initial(std::max(initial, std::chrono::milliseconds(1)))
+  , m_max(std::max(max, m_initial))
+  , m_jitter(std::clamp(jitter, 0.0, 1.0))
+  , m_current(m_initial)
+  , m_random(std::random_device()())
+{
+}
+
+std::chrono::milliseconds
+ExponentialBackoff::next()
+{
+  auto delay = m_current;
+  ++m_retries;
+  m_current = m_current > m_max / 2 ? m_max : m_current * 2;
+
+  if (m_jitter > 0) {
+    std::uniform_real_distribution<double> factor(1 - m_jitter, 1 + m_jitter);
+    delay = std::chrono::milliseconds(static_cast<int64_t>(delay.count() * factor(m_random)));
+  }
+  return delay;
+}
+
+void
+ExponentialBackoff::reset()
+{
+  m_current = m_initial;
+  m_retries = 0;
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,153 @@
+/**
+ * @file ConnectionEstablisher.cpp ConnectionEstablisher Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/ConnectionEstablisher.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+
+namespace dunedaq::iomanager {
+
+ConnectionEstablisher::ConnectionEstablisher(size_t worker_count,
+                                             std::chrono::milliseconds retry_interval,
+                                             std::chrono::milliseconds max_retry_interval)
+  : m_retry_interval(retry_interval)
+  , m_max_retry_interval(max_retry_interval)
+{
+  if (worker_count == 0) {
+    worker_count = 1;
+  }
+  for (size_t ii = 0; ii < worker_count; ++ii) {
+    m_workers.emplace_back(&ConnectionEstablisher::worker, this);
+  }
+}
+
+void
+ConnectionEstablisher::submit(std::string const& name,
+                              std::function<bool()> attempt,
+                              std::function<void()> abandon,
+                              std::chrono::milliseconds give_up_after,
+                              std::chrono::milliseconds delay)
+{
+  auto now = clock_t::now();
+  Intent intent{ name,
+                 std::move(attempt),
+                 std::move(abandon),
+                 clock_t::time_point::max(),
+                 now + delay,
+                 ExponentialBackoff(m_retry_interval, m_max_retry_interval) };
+  // Avoid overflowing the time_point for "block forever" style timeouts
+  if (give_up_after < std::chrono::duration_cast<std::chrono::milliseconds>(clock_t::time_point::max() - now)) {
+    intent.deadline = now + give_up_after;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_running) {
+      TLOG_DEBUG(18) << "Queueing connection intent for " << name;
+      m_intents.push_back(std::move(intent));
+      m_cv.notify_one();
+      return;
+    }
+  }
+
+  // Not running any more, nobody will ever try this connection
+  intent.abandon();
+}
+
+void
+ConnectionEstablisher::stop()
+{
+  std::list<Intent> leftover;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_running) {
+      return;
+    }
+    m_running = false;
+    leftover.swap(m_intents);
+  }
+  m_cv.notify_all();
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  m_workers.clear();
+
+  TLOG_DEBUG(18) << "Abandoning " << leftover.size() << " outstanding connection intents";
+  for (auto& intent : leftover) {
+    intent.abandon();
+  }
+}
+
+size_t
+ConnectionEstablisher::get_pending_count() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_intents.size();
+}
+
+void
+ConnectionEstablisher::worker()
+{
+  while (true) {
+    Intent intent;
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_cv.wait(lk, [&] { return !m_running || !m_intents.empty(); });
+      if (!m_running) {
+        return;
+      }
+
+      auto next = std::min_element(m_intents.begin(), m_intents.end(), [](Intent const& l, Intent const& r) {
+        return l.next_attempt < r.next_attempt;
+      });
+      if (next->next_attempt > clock_t::now()) {
+        // Nothing due yet; wake up when the earliest retry is due or a new intent arrives
+        m_cv.wait_until(lk, next->next_attempt);
+        continue;
+      }
+      intent = std::move(*next);
+      m_intents.erase(next);
+    }
+
+    bool established = false;
+    try {
+      established = intent.attempt();
+    } catch (std::exception const& ex) {
+      TLOG_DEBUG(18) << "Connection attempt for " << intent.name << " threw: " << ex.what();
+    }
+    if (established) {
+      TLOG_DEBUG(18) << "Connection for " << intent.name << " established";
+      continue;
+    }
+
+    auto now = clock_t::now();
+    if (now >= intent.deadline) {
+      TLOG_DEBUG(18) << "Giving up on connection for " << intent.name;
+      intent.abandon();
+      continue;
+    }
+
+    intent.next_attempt = std::min(now + intent.backoff.next(), intent.deadline);
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_running) {
+      intent.abandon();
+      return;
+    }
+    m_intents.push_back(std::move(intent));
+    m_cv.notify_one();
+  }
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,234 @@
+/**
+ * @file FlowControl.cpp CreditGrantor and CreditTracker Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/FlowControl.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <random>
+#include <string>
+
+namespace dunedaq::iomanager {
+
+namespace {
+
+// How long each background attempt to connect the credit connection may take
+constexpr std::chrono::milliseconds s_connection_budget{ 1000 };
+// Longest single wait for grants while waiting for credit
+constexpr std::chrono::milliseconds s_grant_poll_interval{ 10 };
+
+bool
+is_configured(ConnectionId const& conn_id, ConnectionId const& credit_conn_id)
+{
+  if (NetworkManager::get().get_preconfigured_connections(credit_conn_id).connections.empty()) {
+    ers::warning(FlowControlUnavailable(ERS_HERE, conn_id.uid, credit_conn_id.uid));
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+ConnectionId
+get_credit_connection_id(ConnectionId const& conn_id, FlowControlOptions const& options)
+{
+  auto uid = options.credit_connection.empty() ? conn_id.uid + "_credits" : options.credit_connection;
+  return ConnectionId{ uid, datatype_to_string<FlowCredit>(), conn_id.session };
+}
+
+CreditGrantor::CreditGrantor(ConnectionId const& conn_id, FlowControlOptions const& options)
+  : m_conn_id(conn_id)
+  , m_credit_conn_id(get_credit_connection_id(conn_id, options))
+  , m_options(options)
+{
+  std::random_device rd;
+  m_epoch = (static_cast<uint64_t>(rd()) << 32) ^ rd() ^
+            static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  m_options.window = std::max<size_t>(m_options.window, 1);
+  m_enabled = is_configured(conn_id, m_credit_conn_id);
+  if (m_enabled) {
+    m_sender_future = NetworkManager::get().request_sender(m_credit_conn_id, s_connection_budget);
+  }
+}
+
+bool
+CreditGrantor::get_sender()
+{
+  if (m_sender != nullptr) {
+    return true;
+  }
+  if (!m_sender_future.valid()) {
+    m_sender_future = NetworkManager::get().request_sender(m_credit_conn_id, s_connection_budget);
+  }
+  if (m_sender_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return false;
+  }
+  m_sender = m_sender_future.get();
+  if (m_sender == nullptr) {
+    // The attempt gave up, try again
+    m_sender_future = NetworkManager::get().request_sender(m_credit_conn_id, s_connection_budget);
+  }
+  return m_sender != nullptr;
+}
+
+void
+CreditGrantor::update()
+{
+  if (!m_enabled) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto delivered = m_delivered.load();
+  auto now = std::chrono::steady_clock::now();
+  auto step = std::max<uint64_t>(m_options.window / 4, 1);
+  if (m_granted && delivered - m_last_granted < step && now - m_last_grant < m_options.grant_interval) {
+    return;
+  }
+  if (!get_sender()) {
+    return;
+  }
+
+  serialize_raw(FlowCredit{ m_epoch, delivered, m_options.window }, m_buffer);
+  try {
+    if (!m_sender->send(m_buffer.data(), m_buffer.size(), ipm::Sender::s_no_block, "", true)) {
+      // Retried by the next update
+      return;
+    }
+  } catch (ers::Issue const& ex) {
+    TLOG_DEBUG(25) << "Failed to send credit on " << m_credit_conn_id.uid << ", reconnecting: " << ex;
+    NetworkManager::get().remove_sender(m_credit_conn_id);
+    m_sender = nullptr;
+    m_sender_future = NetworkManager::SenderFuture();
+    return;
+  }
+  TLOG_DEBUG(25) << "Granted credit up to " << delivered + m_options.window << " messages on " << m_conn_id.uid;
+  m_granted = true;
+  m_last_granted = delivered;
+  m_last_grant = now;
+}
+
+CreditTracker::CreditTracker(ConnectionId const& conn_id, FlowControlOptions const& options)
+  : m_conn_id(conn_id)
+  , m_credit_conn_id(get_credit_connection_id(conn_id, options))
+{
+  m_enabled = is_configured(conn_id, m_credit_conn_id);
+  if (m_enabled) {
+    m_receiver_future = NetworkManager::get().request_receiver(m_credit_conn_id, s_connection_budget);
+  }
+}
+
+bool
+CreditTracker::get_receiver()
+{
+  if (m_receiver != nullptr) {
+    return true;
+  }
+  if (!m_receiver_future.valid()) {
+    m_receiver_future = NetworkManager::get().request_receiver(m_credit_conn_id, s_connection_budget);
+  }
+  if (m_receiver_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return false;
+  }
+  m_receiver = m_receiver_future.get();
+  if (m_receiver == nullptr) {
+    m_receiver_future = NetworkManager::get().request_receiver(m_credit_conn_id, s_connection_budget);
+  }
+  return m_receiver != nullptr;
+}
+
+void
+CreditTracker::receive_grants(std::chrono::milliseconds timeout)
+{
+  if (!get_receiver()) {
+    if (timeout > std::chrono::milliseconds(0)) {
+      m_receiver_future.wait_for(timeout);
+    }
+    return;
+  }
+
+  try {
+    while (true) {
+      auto response = m_receiver->receive(timeout, ipm::Receiver::s_any_size, true);
+      if (response.data.empty()) {
+        return;
+      }
+      // Only wait for the first grant, then read whatever else is pending
+      timeout = std::chrono::milliseconds(0);
+
+      FlowCredit grant;
+      try {
+        grant = deserialize_raw<FlowCredit>(response.data);
+      } catch (MessageDecodeFailed const& ex) {
+        TLOG_DEBUG(25) << "Ignoring invalid credit on " << m_credit_conn_id.uid << ": " << ex;
+        continue;
+      }
+
+      if (!m_granted || grant.epoch != m_epoch) {
+        // First grant from this receiver: messages sent to a previous receiver no longer count
+        m_epoch = grant.epoch;
+        m_sent = grant.consumed;
+        m_limit = grant.consumed + grant.window;
+      } else {
+        m_sent = std::max(m_sent, grant.consumed);
+        m_limit = std::max(m_limit, grant.consumed + grant.window);
+      }
+      m_granted = true;
+      m_available = credit();
+    }
+  } catch (ers::Issue const& ex) {
+    TLOG_DEBUG(25) << "Failed to receive credit on " << m_credit_conn_id.uid << ": " << ex;
+  }
+}
+
+size_t
+CreditTracker::credit() const
+{
+  return m_granted && m_limit > m_sent ? m_limit - m_sent : 0;
+}
+
+size_t
+CreditTracker::available()
+{
+  // While a sender waits for credit it holds the lock, and keeps m_available up to date itself
+  std::unique_lock<std::mutex> lk(m_mutex, std::try_to_lock);
+  if (lk.owns_lock()) {
+    receive_grants(std::chrono::milliseconds(0));
+  }
+  return m_available;
+}
+
+bool
+CreditTracker::wait_for_credit(std::chrono::milliseconds timeout)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(m_mutex);
+  receive_grants(std::chrono::milliseconds(0));
+  while (credit() == 0) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    if (elapsed >= timeout) {
+      return false;
+    }
+    receive_grants(std::min(timeout - elapsed, s_grant_poll_interval));
+  }
+  return true;
+}
+
+void
+CreditTracker::on_sent(size_t count)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_sent += count;
+  m_available = credit();
+}
+
+} // namespace dunedaq::iomanager
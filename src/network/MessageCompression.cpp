@@ -0,0 +1,204 @@
+/**
+ * @file MessageCompression.cpp MessageCompressor Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/MessageCompression.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "iomanager/opmon/compression.pb.h"
+#include "logging/Logging.hpp"
+
+#include <folly/compression/Compression.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+namespace {
+
+bool
+get_codec_type(CompressionAlgorithm algorithm, folly::io::CodecType& type)
+{
+  switch (algorithm) {
+    case CompressionAlgorithm::kLZ4:
+      type = folly::io::CodecType::LZ4;
+      return true;
+    case CompressionAlgorithm::kZstd:
+      type = folly::io::CodecType::ZSTD;
+      return true;
+    default:
+      return false;
+  }
+}
+
+folly::io::Codec&
+get_decompression_codec(uint8_t algorithm)
+{
+  // Codecs are not thread-safe, and creating one per frame would cost more than small decompressions
+  thread_local std::array<std::unique_ptr<folly::io::Codec>, 256> codecs;
+
+  auto& codec = codecs[algorithm]; // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+  if (codec == nullptr) {
+    folly::io::CodecType type;
+    if (!get_codec_type(static_cast<CompressionAlgorithm>(algorithm), type)) {
+      throw MessageDecodeFailed(ERS_HERE, "compressed", "unknown algorithm " + std::to_string(algorithm));
+    }
+    if (!folly::io::hasCodec(type)) {
+      throw MessageDecodeFailed(
+        ERS_HERE, "compressed", to_string(static_cast<CompressionAlgorithm>(algorithm)) + " is not available");
+    }
+    // Stream codecs can decompress into the message directly
+    if (folly::io::hasStreamCodec(type)) {
+      codec = folly::io::getStreamCodec(type);
+    } else {
+      codec = folly::io::getCodec(type);
+    }
+  }
+  return *codec;
+}
+
+} // namespace
+
+MessageCompressor::MessageCompressor(std::string const& name, CompressionOptions const& options)
+  : m_name(name)
+  , m_options(options)
+{
+  folly::io::CodecType type;
+  if (!get_codec_type(options.algorithm, type)) {
+    return;
+  }
+  if (!folly::io::hasCodec(type)) {
+    ers::warning(CompressionUnavailable(ERS_HERE, to_string(options.algorithm), name));
+    return;
+  }
+  auto level = options.level < 0 ? folly::io::COMPRESSION_LEVEL_DEFAULT : options.level;
+  if (folly::io::hasStreamCodec(type)) {
+    auto stream_codec = folly::io::getStreamCodec(type, level);
+    m_stream_codec = stream_codec.get();
+    m_codec = std::move(stream_codec);
+  } else {
+    m_codec = folly::io::getCodec(type, level);
+  }
+  TLOG_DEBUG(20) << "Compressing messages of at least " << options.min_size << " bytes on " << name << " with "
+                 << to_string(options.algorithm);
+}
+
+MessageCompressor::~MessageCompressor() = default;
+
+bool
+MessageCompressor::compress(const uint8_t* data, size_t size, SerializationBuffer& frame)
+{
+  if (m_codec == nullptr || size < m_options.min_size || size <= s_header_size + 1) {
+    ++m_messages_not_compressed;
+    return false;
+  }
+
+  // Compression is only kept if the frame comes out smaller than the message
+  auto max_compressed_size = size - s_header_size - 1;
+  size_t compressed_size = 0;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    frame.clear();
+    if (m_stream_codec != nullptr) {
+      // Compress straight into the frame; the codec stops once the output would be too large
+      frame.resize(s_header_size + max_compressed_size);
+      folly::ByteRange input(data, size);
+      folly::MutableByteRange output(frame.data() + s_header_size, max_compressed_size);
+      m_stream_codec->resetStream(size);
+      if (m_stream_codec->compressStream(input, output, folly::io::StreamCodec::FlushOp::END)) {
+        compressed_size = max_compressed_size - output.size();
+      }
+    } else {
+      // Codecs without streaming support can only return a new string
+      auto compressed = m_codec->compress(folly::StringPiece(reinterpret_cast<const char*>(data), size)); // NOLINT
+      if (compressed.size() <= max_compressed_size) {
+        frame.resize(s_header_size + compressed.size());
+        std::memcpy(frame.data() + s_header_size, compressed.data(), compressed.size());
+        compressed_size = compressed.size();
+      }
+    }
+  } catch (std::exception const& ex) {
+    TLOG_DEBUG(20) << "Compression failed on " << m_name << ", sending uncompressed: " << ex.what();
+    compressed_size = 0;
+  }
+  m_compression_time_ns +=
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+  if (compressed_size == 0) {
+    frame.clear();
+    ++m_messages_not_compressed;
+    return false;
+  }
+
+  uint64_t uncompressed_size = size;
+  frame.data()[0] = s_compressed_frame_type;
+  frame.data()[1] = static_cast<uint8_t>(m_options.algorithm);
+  std::memcpy(frame.data() + 2, &uncompressed_size, sizeof(uncompressed_size));
+  frame.resize(s_header_size + compressed_size);
+
+  ++m_messages_compressed;
+  m_bytes_in += size;
+  m_bytes_out += frame.size();
+  return true;
+}
+
+void
+MessageCompressor::generate_opmon_data()
+{
+  opmon::CompressionInfo info;
+  auto bytes_in = m_bytes_in.exchange(0);
+  auto bytes_out = m_bytes_out.exchange(0);
+  info.set_messages_compressed(m_messages_compressed.exchange(0));
+  info.set_messages_not_compressed(m_messages_not_compressed.exchange(0));
+  info.set_bytes_in(bytes_in);
+  info.set_bytes_out(bytes_out);
+  info.set_ratio(bytes_out > 0 ? static_cast<double>(bytes_in) / static_cast<double>(bytes_out) : 0.);
+  info.set_compression_time_ns(m_compression_time_ns.exchange(0));
+  publish(std::move(info));
+}
+
+std::vector<uint8_t>
+decompress_frame(std::vector<uint8_t> const& frame)
+{
+  if (frame.size() < MessageCompressor::s_header_size || frame[0] != s_compressed_frame_type) {
+    throw MessageDecodeFailed(ERS_HERE, "compressed", "truncated header");
+  }
+  uint64_t uncompressed_size = 0;
+  std::memcpy(&uncompressed_size, frame.data() + 2, sizeof(uncompressed_size));
+
+  auto& codec = get_decompression_codec(frame[1]);
+  auto compressed_size = frame.size() - MessageCompressor::s_header_size;
+  try {
+    if (auto* stream_codec = dynamic_cast<folly::io::StreamCodec*>(&codec)) {
+      // Decompress straight into the message
+      std::vector<uint8_t> uncompressed(uncompressed_size);
+      folly::ByteRange input(frame.data() + MessageCompressor::s_header_size, compressed_size);
+      folly::MutableByteRange output(uncompressed.data(), uncompressed.size());
+      stream_codec->resetStream(uncompressed_size);
+      if (!stream_codec->uncompressStream(input, output, folly::io::StreamCodec::FlushOp::END) || output.size() != 0) {
+        throw MessageDecodeFailed(ERS_HERE, "compressed", "size does not match the header");
+      }
+      return uncompressed;
+    }
+
+    auto compressed_data = reinterpret_cast<const char*>(frame.data()) + MessageCompressor::s_header_size; // NOLINT
+    folly::StringPiece compressed(compressed_data, compressed_size);
+    auto uncompressed = codec.uncompress(compressed, uncompressed_size);
+    return std::vector<uint8_t>(uncompressed.begin(), uncompressed.end());
+  } catch (MessageDecodeFailed const&) {
+    throw;
+  } catch (std::exception const& ex) {
+    throw MessageDecodeFailed(ERS_HERE, "compressed", ex.what());
+  }
+}
+
+} // namespace dunedaq::iomanager
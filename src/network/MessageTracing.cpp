@@ -0,0 +1,109 @@
+/**
+ * @file MessageTracing.cpp Trace envelope and TraceStatistics implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/MessageTracing.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "iomanager/opmon/tracing.pb.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+namespace dunedaq::iomanager {
+
+void
+wrap_trace_envelope(TraceContext const& context, SerializationBuffer const& message, SerializationBuffer& frame)
+{
+  frame.clear();
+  frame.reserve(s_trace_header_size + context.hop_count * sizeof(uint64_t) + message.size() +
+                message.external_size());
+  const char header[4] = { static_cast<char>(s_trace_frame_type),
+                           static_cast<char>(s_trace_envelope_version),
+                           static_cast<char>(context.hop_count),
+                           0 };
+  frame.write(header, sizeof(header));
+  frame.write(reinterpret_cast<const char*>(&context.trace_id), sizeof(context.trace_id));   // NOLINT
+  frame.write(reinterpret_cast<const char*>(&context.origin_ns), sizeof(context.origin_ns)); // NOLINT
+  frame.write(reinterpret_cast<const char*>(context.hops.data()), context.hop_count * sizeof(uint64_t)); // NOLINT
+  for (auto& segment : message.segments()) {
+    frame.write(reinterpret_cast<const char*>(segment.data), segment.size); // NOLINT
+  }
+}
+
+TraceContext
+unwrap_trace_envelope(std::vector<uint8_t>& message)
+{
+  TraceContext context;
+  if (message.empty() || message[0] != s_trace_frame_type) {
+    return context;
+  }
+  if (message.size() < s_trace_header_size) {
+    throw MessageDecodeFailed(ERS_HERE, "trace", "truncated header");
+  }
+  if (message[1] != s_trace_envelope_version) {
+    throw MessageDecodeFailed(ERS_HERE, "trace", "unknown envelope version " + std::to_string(message[1]));
+  }
+  auto hop_count = message[2];
+  if (hop_count > TraceContext::s_max_hops) {
+    throw MessageDecodeFailed(ERS_HERE, "trace", "too many hops (" + std::to_string(hop_count) + ")");
+  }
+  auto header_size = s_trace_header_size + hop_count * sizeof(uint64_t);
+  if (message.size() < header_size) {
+    throw MessageDecodeFailed(ERS_HERE, "trace", "truncated hop timestamps");
+  }
+  std::memcpy(&context.trace_id, message.data() + 4, sizeof(context.trace_id));
+  std::memcpy(&context.origin_ns, message.data() + 4 + sizeof(uint64_t), sizeof(context.origin_ns));
+  std::memcpy(context.hops.data(), message.data() + s_trace_header_size, hop_count * sizeof(uint64_t));
+  context.hop_count = hop_count;
+  // Only sampled messages pay for the move
+  message.erase(message.begin(), message.begin() + header_size);
+  return context;
+}
+
+void
+TraceStatistics::Latencies::record(uint64_t ns)
+{
+  total_ns.fetch_add(ns, std::memory_order_relaxed);
+  histogram[NetworkMetrics::get_bucket(std::chrono::nanoseconds(ns))].fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+TraceStatistics::record(TraceContext const& context, uint64_t received_ns)
+{
+  m_traced_messages.fetch_add(1, std::memory_order_relaxed);
+  m_interval_messages.fetch_add(1, std::memory_order_relaxed);
+  auto last_hop_ns = context.last_hop_ns();
+  if (received_ns < last_hop_ns || received_ns < context.origin_ns) {
+    m_negative_latencies.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  m_hop.record(received_ns - last_hop_ns);
+  m_end_to_end.record(received_ns - context.origin_ns);
+}
+
+void
+TraceStatistics::generate_opmon_data()
+{
+  auto messages = m_interval_messages.exchange(0);
+  if (messages == 0) {
+    return;
+  }
+  opmon::TraceInfo info;
+  info.set_traced_messages(messages);
+  info.set_negative_latencies(m_negative_latencies.exchange(0));
+  info.set_hop_latency_us(m_hop.total_ns.exchange(0) / 1000);
+  info.set_end_to_end_latency_us(m_end_to_end.total_ns.exchange(0) / 1000);
+  for (size_t ii = 0; ii < s_histogram_buckets; ++ii) {
+    info.add_hop_latency_histogram(m_hop.histogram[ii].exchange(0));
+    info.add_end_to_end_latency_histogram(m_end_to_end.histogram[ii].exchange(0));
+  }
+  publish(std::move(info));
+}
+
+} // namespace dunedaq::iomanager
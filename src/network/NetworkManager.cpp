@@ -7,6 +7,7 @@
  */
 
 #include "iomanager/network/NetworkManager.hpp"
+#include "iomanager/network/ShmTransport.hpp"
 #include "iomanager/SchemaUtils.hpp"
 
 #include "ipm/PluginInfo.hpp"
@@ -16,6 +17,7 @@
 #include "confmodel/PhysicalHost.hpp"
 #include "confmodel/Service.hpp"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -77,12 +79,18 @@ NetworkManager::configure(const std::string& session_name,
 
   opmgr.register_node("senders", m_sender_opmon_link);
   opmgr.register_node("receivers", m_receiver_opmon_link);
+  opmgr.register_node("compression", m_compression_opmon_link);
+  opmgr.register_node("sender_models", m_sender_model_opmon_link);
+  opmgr.register_node("receiver_models", m_receiver_model_opmon_link);
+  opmgr.register_node("serialization", m_serialization_opmon_link);
+  opmgr.register_node("tracing", m_tracing_opmon_link);
 }
 
 void
 NetworkManager::reset()
 {
   TLOG_DEBUG(5) << "reset() BEGIN";
+  stop_establisher();
   m_subscriber_update_thread_running = false;
   if (m_subscriber_update_thread && m_subscriber_update_thread->joinable()) {
     m_subscriber_update_thread->join();
@@ -91,6 +99,18 @@ NetworkManager::reset()
     std::lock_guard<std::mutex> lkk(m_subscriber_plugin_map_mutex);
     m_subscriber_plugins.clear();
   }
+  {
+    std::lock_guard<std::mutex> lk(m_shared_subscribers_mutex);
+    m_shared_subscribers.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_serialization_profiles_mutex);
+    m_serialization_profiles.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_trace_statistics_mutex);
+    m_trace_statistics.clear();
+  }
   {
     std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
     m_sender_plugins.clear();
@@ -100,6 +120,22 @@ NetworkManager::reset()
     m_receiver_plugins.clear();
   }
 
+  {
+    std::lock_guard<std::mutex> lk(m_creation_mutex_map_mutex);
+    m_sender_creation_mutexes.clear();
+    m_receiver_creation_mutexes.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_warm_senders_mutex);
+    m_warm_senders.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(m_connection_options_mutex);
+    m_connection_options.clear();
+  }
+
   m_preconfigured_connections.clear();
   if (m_config_client != nullptr) {
     try {
@@ -112,6 +148,11 @@ NetworkManager::reset()
 
   m_sender_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
   m_receiver_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
+  m_compression_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
+  m_sender_model_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
+  m_receiver_model_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
+  m_serialization_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
+  m_tracing_opmon_link = std::make_shared<dunedaq::opmonlib::OpMonLink>();
   TLOG_DEBUG(5) << "reset() END";
 }
 
@@ -119,6 +160,7 @@ void
 NetworkManager::shutdown()
 {
   TLOG_DEBUG(5) << "shutdown() BEGIN";
+  stop_establisher();
   m_subscriber_update_thread_running = false;
   if (m_subscriber_update_thread && m_subscriber_update_thread->joinable()) {
     m_subscriber_update_thread->join();
@@ -127,6 +169,18 @@ NetworkManager::shutdown()
     std::lock_guard<std::mutex> lkk(m_subscriber_plugin_map_mutex);
     m_subscriber_plugins.clear();
   }
+  {
+    std::lock_guard<std::mutex> lk(m_shared_subscribers_mutex);
+    m_shared_subscribers.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_serialization_profiles_mutex);
+    m_serialization_profiles.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m_trace_statistics_mutex);
+    m_trace_statistics.clear();
+  }
   {
     std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
     m_sender_plugins.clear();
@@ -151,18 +205,32 @@ NetworkManager::get_receiver(ConnectionId const& conn_id)
 {
   TLOG_DEBUG(9) << "Getting receiver for connection " << conn_id.uid;
 
-  std::lock_guard<std::mutex> lk(m_receiver_plugin_map_mutex);
-  if (!m_receiver_plugins.count(conn_id) || m_receiver_plugins.at(conn_id) == nullptr) {
-
-    auto response = get_connections(conn_id);
+  {
+    std::lock_guard<std::mutex> lk(m_receiver_plugin_map_mutex);
+    if (m_receiver_plugins.count(conn_id) && m_receiver_plugins.at(conn_id) != nullptr) {
+      return m_receiver_plugins[conn_id];
+    }
+  }
 
-    TLOG_DEBUG(9) << "Creating receiver for connection " << conn_id.uid;
-    auto receiver = create_receiver(response.connections, conn_id);
+  auto creation_mutex = get_creation_mutex(m_receiver_creation_mutexes, m_creation_mutex_map_mutex, conn_id);
+  std::lock_guard<std::mutex> creation_lk(*creation_mutex);
 
-    m_receiver_plugins[conn_id] = receiver;
+  // Another thread may have created the receiver while we were waiting
+  {
+    std::lock_guard<std::mutex> lk(m_receiver_plugin_map_mutex);
+    if (m_receiver_plugins.count(conn_id) && m_receiver_plugins.at(conn_id) != nullptr) {
+      return m_receiver_plugins[conn_id];
+    }
   }
 
-  return m_receiver_plugins[conn_id];
+  auto response = get_connections(conn_id);
+
+  TLOG_DEBUG(9) << "Creating receiver for connection " << conn_id.uid;
+  auto receiver = create_receiver(response.connections, conn_id);
+
+  std::lock_guard<std::mutex> lk(m_receiver_plugin_map_mutex);
+  m_receiver_plugins[conn_id] = receiver;
+  return receiver;
 }
 
 std::shared_ptr<ipm::Sender>
@@ -170,21 +238,141 @@ NetworkManager::get_sender(ConnectionId const& conn_id)
 {
   TLOG_DEBUG(10) << "Getting sender for connection " << conn_id.uid;
 
+  {
+    std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
+    if (m_sender_plugins.count(conn_id) && m_sender_plugins.at(conn_id) != nullptr) {
+      return m_sender_plugins[conn_id];
+    }
+  }
+
+  auto creation_mutex = get_creation_mutex(m_sender_creation_mutexes, m_creation_mutex_map_mutex, conn_id);
+  std::lock_guard<std::mutex> creation_lk(*creation_mutex);
+
+  {
+    std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
+    if (m_sender_plugins.count(conn_id) && m_sender_plugins.at(conn_id) != nullptr) {
+      return m_sender_plugins[conn_id];
+    }
+  }
+
+  auto response = get_connections(conn_id, true);
+
+  TLOG_DEBUG(10) << "Creating sender for connection " << conn_id.uid;
+  auto sender = create_sender(response.connections[0]);
+
   std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
+  m_sender_plugins[conn_id] = sender;
+  return sender;
+}
 
-  if (!m_sender_plugins.count(conn_id) || m_sender_plugins.at(conn_id) == nullptr) {
-    auto response = get_connections(conn_id, true);
+NetworkManager::SenderFuture
+NetworkManager::request_sender(ConnectionId const& conn_id,
+                               std::chrono::milliseconds give_up_after,
+                               std::chrono::milliseconds delay)
+{
+  std::lock_guard<std::mutex> lk(m_establisher_mutex);
+  auto pending_it = m_pending_senders.find(conn_id);
+  if (pending_it != m_pending_senders.end() &&
+      pending_it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return pending_it->second;
+  }
+
+  auto promise = std::make_shared<std::promise<std::shared_ptr<ipm::Sender>>>();
+  SenderFuture future = promise->get_future().share();
+  m_pending_senders[conn_id] = future;
+
+  get_establisher().submit(
+    to_string(conn_id),
+    [this, conn_id, promise]() {
+      try {
+        auto sender = get_sender(conn_id);
+        if (sender != nullptr) {
+          promise->set_value(sender);
+          return true;
+        }
+      } catch (ers::Issue const& ex) {
+        TLOG_DEBUG(10) << "Sender for " << conn_id.uid << " not ready: " << ex;
+      }
+      return false;
+    },
+    [promise]() { promise->set_value(nullptr); },
+    give_up_after,
+    delay);
+
+  return future;
+}
 
-    TLOG_DEBUG(10) << "Creating sender for connection " << conn_id.uid;
-    auto sender = create_sender(response.connections[0]);
-    m_sender_plugins[conn_id] = sender;
+NetworkManager::ReceiverFuture
+NetworkManager::request_receiver(ConnectionId const& conn_id, std::chrono::milliseconds give_up_after)
+{
+  std::lock_guard<std::mutex> lk(m_establisher_mutex);
+  auto pending_it = m_pending_receivers.find(conn_id);
+  if (pending_it != m_pending_receivers.end() &&
+      pending_it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    return pending_it->second;
   }
 
-  if (m_sender_plugins.count(conn_id)) {
-    return m_sender_plugins[conn_id];
+  auto promise = std::make_shared<std::promise<std::shared_ptr<ipm::Receiver>>>();
+  ReceiverFuture future = promise->get_future().share();
+  m_pending_receivers[conn_id] = future;
+
+  get_establisher().submit(
+    to_string(conn_id),
+    [this, conn_id, promise]() {
+      try {
+        auto receiver = get_receiver(conn_id);
+        if (receiver != nullptr) {
+          promise->set_value(receiver);
+          return true;
+        }
+      } catch (ers::Issue const& ex) {
+        TLOG_DEBUG(9) << "Receiver for " << conn_id.uid << " not ready: " << ex;
+      }
+      return false;
+    },
+    [promise]() { promise->set_value(nullptr); },
+    give_up_after);
+
+  return future;
+}
+
+ConnectionEstablisher&
+NetworkManager::get_establisher()
+{
+  // Called with m_establisher_mutex held
+  if (m_establisher == nullptr) {
+    m_establisher = std::make_unique<ConnectionEstablisher>();
   }
+  return *m_establisher;
+}
 
-  return nullptr;
+void
+NetworkManager::stop_establisher()
+{
+  std::unique_ptr<ConnectionEstablisher> establisher;
+  {
+    std::lock_guard<std::mutex> lk(m_establisher_mutex);
+    establisher.swap(m_establisher);
+    m_pending_senders.clear();
+    m_pending_receivers.clear();
+  }
+  // Workers may be inside get_sender/get_receiver, join them without holding any NetworkManager locks
+  if (establisher != nullptr) {
+    establisher->stop();
+  }
+}
+
+std::shared_ptr<std::mutex>
+NetworkManager::get_creation_mutex(std::unordered_map<ConnectionId, std::shared_ptr<std::mutex>>& mutexes,
+                                   std::mutex& map_mutex,
+                                   ConnectionId const& conn_id)
+{
+  std::lock_guard<std::mutex> lk(map_mutex);
+  auto& mutex_ptr = mutexes[conn_id];
+  if (mutex_ptr == nullptr) {
+    mutex_ptr = std::make_shared<std::mutex>();
+  }
+  return mutex_ptr;
 }
 
 void
@@ -192,10 +380,97 @@ NetworkManager::remove_sender(ConnectionId const& conn_id)
 {
   TLOG_DEBUG(10) << "Removing sender for connection " << conn_id.uid;
 
+  {
+    std::lock_guard<std::mutex> lk(m_warm_senders_mutex);
+    m_warm_senders.erase(conn_id);
+  }
   std::lock_guard<std::mutex> lk(m_sender_plugin_map_mutex);
   m_sender_plugins.erase(conn_id);
 }
 
+std::vector<WarmupResult>
+NetworkManager::warm_up(ConnectionWarmup const& warmup)
+{
+  TLOG_DEBUG(5) << "warm_up() BEGIN, " << warmup.senders.size() << " senders, " << warmup.receivers.size()
+                << " receivers";
+  std::vector<WarmupResult> results;
+  for (auto& id : warmup.receivers) {
+    results.push_back(WarmupResult{ id, false, false, std::chrono::microseconds(0) });
+  }
+  for (auto& id : warmup.senders) {
+    results.push_back(WarmupResult{ id, true, false, std::chrono::microseconds(0) });
+  }
+
+  // Use a dedicated pool so that the warm-up is bounded by the requested worker count
+  ConnectionEstablisher pool(warmup.worker_count);
+  std::vector<std::future<void>> done;
+  auto start = std::chrono::steady_clock::now();
+  for (auto& result : results) {
+    auto promise = std::make_shared<std::promise<void>>();
+    done.push_back(promise->get_future());
+    auto result_ptr = &result;
+    pool.submit(
+      to_string(result.id),
+      [this, result_ptr, promise, start]() {
+        try {
+          bool ready = false;
+          if (result_ptr->is_sender) {
+            auto sender = get_sender(result_ptr->id);
+            ready = sender != nullptr && sender->can_send();
+          } else {
+            auto receiver = get_receiver(result_ptr->id);
+            ready = receiver != nullptr && receiver->can_receive();
+          }
+          if (!ready) {
+            return false;
+          }
+        } catch (ers::Issue const& ex) {
+          TLOG_DEBUG(5) << "Warm-up of " << result_ptr->id.uid << " not ready yet: " << ex;
+          return false;
+        }
+        result_ptr->success = true;
+        result_ptr->setup_time =
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        promise->set_value();
+        return true;
+      },
+      [result_ptr, promise, start]() {
+        result_ptr->setup_time =
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        promise->set_value();
+      },
+      warmup.timeout);
+  }
+  for (auto& future : done) {
+    future.wait();
+  }
+  pool.stop();
+
+  for (auto& result : results) {
+    if (result.success) {
+      TLOG_DEBUG(5) << "Warmed up " << (result.is_sender ? "sender" : "receiver") << " for " << to_string(result.id)
+                    << " in " << result.setup_time.count() << " us";
+      if (result.is_sender) {
+        std::lock_guard<std::mutex> lk(m_warm_senders_mutex);
+        m_warm_senders.insert(result.id);
+      }
+    } else {
+      TLOG() << "Unable to warm up " << (result.is_sender ? "sender" : "receiver") << " for "
+             << to_string(result.id) << " within " << warmup.timeout.count()
+             << " ms, it will be connected on first use";
+    }
+  }
+  TLOG_DEBUG(5) << "warm_up() END";
+  return results;
+}
+
+bool
+NetworkManager::is_warm_sender(ConnectionId const& conn_id) const
+{
+  std::lock_guard<std::mutex> lk(m_warm_senders_mutex);
+  return m_warm_senders.count(conn_id) > 0;
+}
+
 
 bool
 NetworkManager::is_pubsub_connection(ConnectionId const& conn_id) const
@@ -207,6 +482,69 @@ NetworkManager::is_pubsub_connection(ConnectionId const& conn_id) const
   return is_pubsub;
 }
 
+void
+NetworkManager::set_connection_options(ConnectionId const& pattern, ConnectionOptions const& options)
+{
+  TLOG_DEBUG(15) << "Setting connection options for " << to_string(pattern);
+  std::lock_guard<std::mutex> lk(m_connection_options_mutex);
+  m_connection_options.emplace_back(pattern, options);
+}
+
+ConnectionOptions
+NetworkManager::get_connection_options(ConnectionId const& conn_id) const
+{
+  std::lock_guard<std::mutex> lk(m_connection_options_mutex);
+  for (auto it = m_connection_options.rbegin(); it != m_connection_options.rend(); ++it) {
+    if (is_match(it->first, conn_id)) {
+      return it->second;
+    }
+  }
+  return ConnectionOptions();
+}
+
+void
+NetworkManager::register_compressor(ConnectionId const& conn_id, std::shared_ptr<MessageCompressor> compressor)
+{
+  register_monitorable_node(compressor, m_compression_opmon_link, conn_id.uid, false);
+}
+
+void
+NetworkManager::register_sender_model(ConnectionId const& conn_id, std::shared_ptr<opmonlib::MonitorableObject> model)
+{
+  register_monitorable_node(model, m_sender_model_opmon_link, conn_id.uid, false);
+}
+
+void
+NetworkManager::register_receiver_model(ConnectionId const& conn_id,
+                                        std::shared_ptr<opmonlib::MonitorableObject> model)
+{
+  register_monitorable_node(model, m_receiver_model_opmon_link, conn_id.uid, false);
+}
+
+std::shared_ptr<SerializationProfile>
+NetworkManager::get_serialization_profile(std::string const& data_type)
+{
+  std::lock_guard<std::mutex> lk(m_serialization_profiles_mutex);
+  auto& profile = m_serialization_profiles[data_type];
+  if (profile == nullptr) {
+    profile = std::make_shared<SerializationProfile>(data_type);
+    register_monitorable_node(profile, m_serialization_opmon_link, data_type, false);
+  }
+  return profile;
+}
+
+std::shared_ptr<TraceStatistics>
+NetworkManager::get_trace_statistics(ConnectionId const& conn_id)
+{
+  std::lock_guard<std::mutex> lk(m_trace_statistics_mutex);
+  auto& statistics = m_trace_statistics[conn_id.uid];
+  if (statistics == nullptr) {
+    statistics = std::make_shared<TraceStatistics>();
+    register_monitorable_node(statistics, m_tracing_opmon_link, conn_id.uid, false);
+  }
+  return statistics;
+}
+
 ConnectionResponse
 NetworkManager::get_connections(ConnectionId const& conn_id, bool restrict_single) const
 {
@@ -284,12 +622,6 @@ NetworkManager::create_receiver(std::vector<ConnectionInfo> connections, Connect
                           "Trying to configure a kSendRecv receiver with multiple Connections is not allowed!");
   }
 
-  auto plugin_type =
-    ipm::get_recommended_plugin_name(is_pubsub ? ipm::IpmPluginType::Subscriber : ipm::IpmPluginType::Receiver);
-
-  TLOG_DEBUG(12) << "Creating plugin of type " << plugin_type;
-  auto plugin = dunedaq::ipm::make_ipm_receiver(plugin_type);
-
   nlohmann::json config_json;
   if (is_pubsub) {
     std::vector<std::string> uris;
@@ -304,9 +636,29 @@ NetworkManager::create_receiver(std::vector<ConnectionInfo> connections, Connect
       return nullptr;
     }
     config_json["connection_strings"] = uris;
+
+    auto sharing = get_connection_options(conn_id).shared_subscriber;
+    if (sharing.enabled) {
+      return create_subscriber_channel(conn_id, connections[0].data_type, uris, sharing);
+    }
   } else {
     config_json["connection_string"] = connections[0].uri;
   }
+
+  std::shared_ptr<ipm::Receiver> plugin;
+  if (is_shm_uri(connections[0].uri)) {
+    if (is_pubsub) {
+      throw OperationFailed(ERS_HERE, "Shared-memory connections do not support pub/sub: " + conn_id.uid);
+    }
+    TLOG_DEBUG(12) << "Creating shared-memory receiver";
+    plugin = std::make_shared<ShmReceiver>();
+  } else {
+    auto plugin_type =
+      ipm::get_recommended_plugin_name(is_pubsub ? ipm::IpmPluginType::Subscriber : ipm::IpmPluginType::Receiver);
+
+    TLOG_DEBUG(12) << "Creating plugin of type " << plugin_type;
+    plugin = dunedaq::ipm::make_ipm_receiver(plugin_type);
+  }
   auto newCs = plugin->connect_for_receives(config_json);
   TLOG_DEBUG(12) << "Receiver reports connected to URI " << newCs;
 
@@ -329,12 +681,7 @@ NetworkManager::create_receiver(std::vector<ConnectionInfo> connections, Connect
     TLOG_DEBUG(12) << "Subscribing to topic " << connections[0].data_type << " after connect_for_receives";
     auto subscriber = std::dynamic_pointer_cast<ipm::Subscriber>(plugin);
     subscriber->subscribe(connections[0].data_type);
-    std::lock_guard<std::mutex> lkk(m_subscriber_plugin_map_mutex);
-    m_subscriber_plugins[conn_id] = subscriber;
-    if (!m_subscriber_update_thread_running && m_config_client != nullptr) {
-      m_subscriber_update_thread_running = true;
-      m_subscriber_update_thread.reset(new std::thread(&NetworkManager::update_subscribers, this));
-    }
+    register_subscriber(conn_id, subscriber);
   }
 
   if (m_config_client != nullptr && !is_pubsub) {
@@ -347,6 +694,53 @@ NetworkManager::create_receiver(std::vector<ConnectionInfo> connections, Connect
   return plugin;
 }
 
+std::shared_ptr<ipm::Receiver>
+NetworkManager::create_subscriber_channel(ConnectionId const& conn_id,
+                                          std::string const& topic,
+                                          std::vector<std::string> uris,
+                                          SubscriberSharingOptions const& options)
+{
+  std::sort(uris.begin(), uris.end());
+  auto key = conn_id.session;
+  for (auto& uri : uris) {
+    key += "|" + uri;
+  }
+
+  std::shared_ptr<SharedSubscriber> shared;
+  {
+    std::lock_guard<std::mutex> lk(m_shared_subscribers_mutex);
+    shared = m_shared_subscribers[key].lock();
+    if (shared == nullptr) {
+      auto plugin_type = ipm::get_recommended_plugin_name(ipm::IpmPluginType::Subscriber);
+      TLOG_DEBUG(12) << "Creating shared subscriber plugin of type " << plugin_type << " for publishers " << key;
+      auto plugin = dunedaq::ipm::make_ipm_receiver(plugin_type);
+      nlohmann::json config_json;
+      config_json["connection_strings"] = uris;
+      plugin->connect_for_receives(config_json);
+      shared = std::make_shared<SharedSubscriber>(std::dynamic_pointer_cast<ipm::Subscriber>(plugin), uris);
+      m_shared_subscribers[key] = shared;
+    }
+  }
+
+  TLOG_DEBUG(12) << "Adding channel for topic " << topic << " to shared subscriber for publishers " << key;
+  auto channel = std::make_shared<SubscriberChannel>(shared, conn_id.uid, options.queue_capacity);
+  channel->subscribe(topic);
+  register_subscriber(conn_id, channel);
+  register_monitorable_node(channel, m_receiver_opmon_link, conn_id.uid, true);
+  return channel;
+}
+
+void
+NetworkManager::register_subscriber(ConnectionId const& conn_id, std::shared_ptr<ipm::Subscriber> subscriber)
+{
+  std::lock_guard<std::mutex> lkk(m_subscriber_plugin_map_mutex);
+  m_subscriber_plugins[conn_id] = subscriber;
+  if (!m_subscriber_update_thread_running && m_config_client != nullptr) {
+    m_subscriber_update_thread_running = true;
+    m_subscriber_update_thread.reset(new std::thread(&NetworkManager::update_subscribers, this));
+  }
+}
+
 std::shared_ptr<ipm::Sender>
 NetworkManager::create_sender(ConnectionInfo connection)
 {
@@ -360,8 +754,17 @@ NetworkManager::create_sender(ConnectionInfo connection)
     return nullptr;
   }
 
-  TLOG_DEBUG(11) << "Creating sender plugin of type " << plugin_type;
-  auto plugin = dunedaq::ipm::make_ipm_sender(plugin_type);
+  std::shared_ptr<ipm::Sender> plugin;
+  if (is_shm_uri(connection.uri)) {
+    if (is_pubsub) {
+      throw OperationFailed(ERS_HERE, "Shared-memory connections do not support pub/sub: " + connection.uid);
+    }
+    TLOG_DEBUG(11) << "Creating shared-memory sender";
+    plugin = std::make_shared<ShmSender>();
+  } else {
+    TLOG_DEBUG(11) << "Creating sender plugin of type " << plugin_type;
+    plugin = dunedaq::ipm::make_ipm_sender(plugin_type);
+  }
   TLOG_DEBUG(11) << "Connecting sender plugin to " << connection.uri;
   auto newCs = plugin->connect_for_sends({ { "connection_string", connection.uri } });
   TLOG_DEBUG(11) << "Sender Plugin connected, reports URI " << newCs;
@@ -0,0 +1,45 @@
+/**
+ * @file NetworkMetrics.cpp NetworkMetrics Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/NetworkMetrics.hpp"
+
+#include <algorithm>
+
+namespace dunedaq::iomanager {
+
+size_t
+NetworkMetrics::get_bucket(std::chrono::steady_clock::duration duration)
+{
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  if (us <= 0) {
+    return 0;
+  }
+  size_t bucket = 1;
+  while (us > 1 && bucket < s_histogram_buckets - 1) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+NetworkMetrics::Snapshot
+NetworkMetrics::collect()
+{
+  Snapshot snapshot;
+  for (auto& shard : m_shards) {
+    for (size_t ii = 0; ii < kCounterCount; ++ii) {
+      snapshot.counters[ii] += shard.values[ii].exchange(0, std::memory_order_relaxed);
+    }
+    for (size_t ii = 0; ii < s_histogram_buckets; ++ii) {
+      snapshot.histogram[ii] += shard.values[kCounterCount + ii].exchange(0, std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,69 @@
+/**
+ * @file SerializationProfile.cpp SerializationProfile Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SerializationProfile.hpp"
+
+#include "iomanager/opmon/serialization.pb.h"
+
+#include <string>
+#include <utility>
+
+namespace dunedaq::iomanager {
+
+SerializationProfile::SerializationProfile(std::string data_type)
+  : m_data_type(std::move(data_type))
+{
+}
+
+size_t
+SerializationProfile::get_bucket(uint64_t value)
+{
+  size_t bucket = 0;
+  while (value > 0 && bucket < s_histogram_buckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+void
+SerializationProfile::record(Direction direction, size_t bytes, std::chrono::steady_clock::duration duration)
+{
+  auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  auto& histograms = m_histograms[direction];
+  histograms.messages.fetch_add(1, std::memory_order_relaxed);
+  histograms.interval_messages.fetch_add(1, std::memory_order_relaxed);
+  histograms.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  histograms.time_ns.fetch_add(ns, std::memory_order_relaxed);
+  histograms.sizes[get_bucket(bytes)].fetch_add(1, std::memory_order_relaxed);
+  histograms.times[get_bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+SerializationProfile::generate_opmon_data()
+{
+  auto& encode = m_histograms[kEncode];
+  auto& decode = m_histograms[kDecode];
+
+  opmon::SerializationInfo info;
+  info.set_messages_encoded(encode.interval_messages.exchange(0));
+  info.set_bytes_encoded(encode.bytes.exchange(0));
+  info.set_encode_time_ns(encode.time_ns.exchange(0));
+  info.set_messages_decoded(decode.interval_messages.exchange(0));
+  info.set_bytes_decoded(decode.bytes.exchange(0));
+  info.set_decode_time_ns(decode.time_ns.exchange(0));
+  for (size_t ii = 0; ii < s_histogram_buckets; ++ii) {
+    info.add_encode_size_histogram(encode.sizes[ii].exchange(0));
+    info.add_encode_time_histogram(encode.times[ii].exchange(0));
+    info.add_decode_size_histogram(decode.sizes[ii].exchange(0));
+    info.add_decode_time_histogram(decode.times[ii].exchange(0));
+  }
+  publish(std::move(info));
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,213 @@
+/**
+ * @file SharedSubscriber.cpp SharedSubscriber and SubscriberChannel Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SharedSubscriber.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+SubscriberChannel::SubscriberChannel(std::shared_ptr<SharedSubscriber> shared, std::string name, size_t capacity)
+  : m_shared(std::move(shared))
+  , m_name(std::move(name))
+  , m_capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+SubscriberChannel::~SubscriberChannel()
+{
+  // Once the routes are gone, the receive thread no longer delivers to this channel
+  std::set<std::string> topics;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    topics.swap(m_topics);
+  }
+  for (auto& topic : topics) {
+    m_shared->remove_route(topic, this);
+  }
+}
+
+std::string
+SubscriberChannel::connect_for_receives(const nlohmann::json& connection_info)
+{
+  std::vector<std::string> uris;
+  if (connection_info.contains("connection_strings")) {
+    uris = connection_info["connection_strings"].get<std::vector<std::string>>();
+  } else if (connection_info.contains("connection_string")) {
+    uris.push_back(connection_info["connection_string"].get<std::string>());
+  }
+  m_shared->connect(uris);
+  return "";
+}
+
+void
+SubscriberChannel::subscribe(std::string const& topic)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_topics.insert(topic).second) {
+      return;
+    }
+  }
+  // Routes are added without holding m_mutex, which the receive thread takes while holding the route table
+  m_shared->add_route(topic, this);
+}
+
+void
+SubscriberChannel::unsubscribe(std::string const& topic)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_topics.erase(topic) == 0) {
+      return;
+    }
+  }
+  m_shared->remove_route(topic, this);
+}
+
+void
+SubscriberChannel::deliver(Response&& response)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_queue.size() >= m_capacity) {
+      ++m_dropped;
+      if (!m_dropping) {
+        m_dropping = true;
+        ers::warning(SubscriberQueueFull(ERS_HERE, m_name, m_capacity));
+      }
+      return;
+    }
+    m_dropping = false;
+    m_queue.push_back(std::move(response));
+  }
+  m_cv.notify_one();
+}
+
+ipm::Receiver::Response
+SubscriberChannel::receive_(const duration_t& timeout, bool no_tmoexcept_mode)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  auto ready = [&] { return !m_queue.empty(); };
+  if (timeout == s_block) {
+    m_cv.wait(lk, ready);
+  } else if (!m_cv.wait_for(lk, timeout, ready)) {
+    if (!no_tmoexcept_mode) {
+      throw ipm::ReceiveTimeoutExpired(ERS_HERE, timeout.count());
+    }
+    return Response();
+  }
+  auto response = std::move(m_queue.front());
+  m_queue.pop_front();
+  return response;
+}
+
+SharedSubscriber::SharedSubscriber(std::shared_ptr<ipm::Subscriber> subscriber, std::vector<std::string> const& uris)
+  : m_subscriber(std::move(subscriber))
+  , m_uris(uris.begin(), uris.end())
+{
+  m_thread = std::thread(&SharedSubscriber::receive_loop, this);
+}
+
+SharedSubscriber::~SharedSubscriber()
+{
+  m_running = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void
+SharedSubscriber::connect(std::vector<std::string> const& uris)
+{
+  std::lock_guard<std::mutex> lk(m_connect_mutex);
+  auto count = m_uris.size();
+  m_uris.insert(uris.begin(), uris.end());
+  if (m_uris.size() == count) {
+    return;
+  }
+
+  // The publishers of all channels, whether or not the plugin remembers earlier connections
+  nlohmann::json config_json;
+  config_json["connection_strings"] = std::vector<std::string>(m_uris.begin(), m_uris.end());
+  m_subscriber->connect_for_receives(config_json);
+}
+
+void
+SharedSubscriber::add_route(std::string const& topic, SubscriberChannel* channel)
+{
+  std::lock_guard<std::mutex> lk(m_routes_mutex);
+  auto& channels = m_routes[topic];
+  if (channels.empty()) {
+    TLOG_DEBUG(12) << "Subscribing shared subscriber to topic " << topic;
+    m_subscriber->subscribe(topic);
+  }
+  channels.push_back(channel);
+}
+
+void
+SharedSubscriber::remove_route(std::string const& topic, SubscriberChannel* channel)
+{
+  std::lock_guard<std::mutex> lk(m_routes_mutex);
+  auto route = m_routes.find(topic);
+  if (route == m_routes.end()) {
+    return;
+  }
+  auto& channels = route->second;
+  channels.erase(std::remove(channels.begin(), channels.end(), channel), channels.end());
+  if (channels.empty()) {
+    TLOG_DEBUG(12) << "Unsubscribing shared subscriber from topic " << topic;
+    m_subscriber->unsubscribe(topic);
+    m_routes.erase(route);
+  }
+}
+
+size_t
+SharedSubscriber::get_route_count() const
+{
+  std::lock_guard<std::mutex> lk(m_routes_mutex);
+  return m_routes.size();
+}
+
+void
+SharedSubscriber::receive_loop()
+{
+  while (m_running.load()) {
+    ipm::Receiver::Response response;
+    try {
+      response = m_subscriber->receive(s_receive_timeout, ipm::Receiver::s_any_size, true);
+    } catch (ers::Issue const& ex) {
+      TLOG_DEBUG(12) << "Shared subscriber receive failed: " << ex;
+      continue;
+    }
+    if (response.data.empty()) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lk(m_routes_mutex);
+    auto route = m_routes.find(response.metadata);
+    if (route == m_routes.end()) {
+      // Unsubscribed while the message was in flight
+      continue;
+    }
+    auto& channels = route->second;
+    for (size_t ii = 0; ii + 1 < channels.size(); ++ii) {
+      channels[ii]->deliver(ipm::Receiver::Response(response));
+    }
+    channels.back()->deliver(std::move(response));
+  }
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,521 @@
+/**
+ * @file ShmTransport.cpp ShmSender and ShmReceiver Class implementations
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/ShmTransport.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace dunedaq::iomanager {
+
+namespace detail {
+
+/**
+ * Ring layout: this header in the first page, then capacity bytes of records. A record is a
+ * uint32 payload size, 4 reserved bytes and the payload, padded to 8 bytes. A record which would
+ * not fit before the end of the ring is preceded by a padding record (size s_padding) filling the
+ * rest of it. head and tail count bytes since creation; the ring holds head - tail bytes.
+ */
+struct ShmRingHeader
+{
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t capacity;
+  std::atomic<int32_t> receiver_pid;
+  std::atomic<uint32_t> closed;
+
+  alignas(64) std::atomic<uint64_t> head; // Advanced by the sender holding producer_lock
+  std::atomic<uint32_t> producer_lock;    // Futex mutex: 0 free, 1 locked, 2 locked with waiters
+  std::atomic<int32_t> producer_pid;      // Process holding producer_lock
+  std::atomic<uint32_t> space_seq;        // Futex word, bumped when the receiver frees space
+  std::atomic<uint32_t> producer_waiting;
+
+  alignas(64) std::atomic<uint64_t> tail; // Advanced by the receiver
+  std::atomic<uint32_t> data_seq;         // Futex word, bumped when a sender adds a record
+  std::atomic<uint32_t> consumer_waiting;
+};
+
+} // namespace detail
+
+namespace {
+
+using detail::ShmRingHeader;
+
+constexpr uint64_t s_magic = 0x4d48535f4d4f4921; // "!IOM_SHM"
+constexpr uint32_t s_version = 1;
+constexpr size_t s_header_size = 4096;
+constexpr size_t s_record_header_size = 8;
+constexpr uint32_t s_padding = std::numeric_limits<uint32_t>::max();
+// Longest single futex wait, after which waiters check that the other end is still alive
+constexpr std::chrono::milliseconds s_wait_slice{ 100 };
+constexpr std::chrono::milliseconds s_liveness_interval{ 100 };
+
+static_assert(sizeof(ShmRingHeader) <= s_header_size, "Ring header must fit in its page");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Futex words must be plain 32-bit integers");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring positions must be lock-free in shared memory");
+
+size_t
+record_size(size_t payload)
+{
+  return (s_record_header_size + payload + 7) & ~size_t(7);
+}
+
+std::string
+get_shm_path(std::string const& name)
+{
+  return "/iomanager." + name;
+}
+
+std::string
+get_shm_name(std::string const& uri)
+{
+  auto name = uri.substr(std::strlen(s_shm_scheme));
+  std::replace(name.begin(), name.end(), '/', '_');
+  if (name.empty()) {
+    throw SharedMemoryFailure(ERS_HERE, uri, "parse URI", "no name given");
+  }
+  return name;
+}
+
+void
+futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+  auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  timespec ts{ static_cast<time_t>(secs.count()),
+               static_cast<long>(std::chrono::nanoseconds(timeout - secs).count()) }; // NOLINT(runtime/int)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0); // NOLINT
+}
+
+void
+futex_wake(std::atomic<uint32_t>& word, int count)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0); // NOLINT
+}
+
+bool
+is_process_alive(int32_t pid)
+{
+  return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+std::chrono::steady_clock::time_point
+get_deadline(std::chrono::milliseconds timeout)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (timeout >= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::time_point::max() -
+                                                                         now)) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  return now + timeout;
+}
+
+// Time left until deadline, at most one wait slice
+std::chrono::milliseconds
+get_wait(std::chrono::steady_clock::time_point deadline)
+{
+  auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+  return std::min(left, s_wait_slice);
+}
+
+bool
+lock_producer(ShmRingHeader& header, std::chrono::steady_clock::time_point deadline)
+{
+  uint32_t state = 0;
+  if (!header.producer_lock.compare_exchange_strong(state, 1)) {
+    if (state != 2) {
+      state = header.producer_lock.exchange(2);
+    }
+    while (state != 0) {
+      auto wait = get_wait(deadline);
+      if (wait <= std::chrono::milliseconds(0)) {
+        return false;
+      }
+      futex_wait(header.producer_lock, 2, wait);
+      state = header.producer_lock.exchange(2);
+
+      // A sender which exited while holding the lock never published its partial record, take the lock over
+      auto owner = header.producer_pid.load();
+      if (state != 0 && owner != 0 && !is_process_alive(owner) &&
+          header.producer_pid.compare_exchange_strong(owner, getpid())) {
+        TLOG_DEBUG(26) << "Taking over ring lock from exited process " << owner;
+        return true;
+      }
+    }
+  }
+  header.producer_pid = getpid();
+  return true;
+}
+
+void
+unlock_producer(ShmRingHeader& header)
+{
+  header.producer_pid = 0;
+  if (header.producer_lock.fetch_sub(1) != 1) {
+    header.producer_lock = 0;
+    futex_wake(header.producer_lock, 1);
+  }
+}
+
+} // namespace
+
+bool
+is_shm_uri(std::string const& uri)
+{
+  return uri.compare(0, std::strlen(s_shm_scheme), s_shm_scheme) == 0;
+}
+
+namespace detail {
+
+void
+ShmMapping::create(std::string const& name, size_t capacity)
+{
+  unmap();
+  // Power of two, so that positions wrap with a mask
+  size_t ring_capacity = 4096;
+  while (ring_capacity < capacity) {
+    ring_capacity *= 2;
+  }
+
+  auto path = get_shm_path(name);
+  // Replaces the ring of a previous receiver, whose senders then reconnect
+  shm_unlink(path.c_str());
+  int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    throw SharedMemoryFailure(ERS_HERE, name, "shm_open", std::strerror(errno));
+  }
+  auto size = s_header_size + ring_capacity;
+  struct stat st;
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0 || fstat(fd, &st) != 0) {
+    auto error = errno;
+    close(fd);
+    shm_unlink(path.c_str());
+    throw SharedMemoryFailure(ERS_HERE, name, "ftruncate", std::strerror(error));
+  }
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+  auto error = errno;
+  close(fd);
+  if (addr == MAP_FAILED) {
+    shm_unlink(path.c_str());
+    throw SharedMemoryFailure(ERS_HERE, name, "mmap", std::strerror(error));
+  }
+
+  m_name = name;
+  m_size = size;
+  m_inode = st.st_ino;
+  m_owner = true;
+  m_data = static_cast<uint8_t*>(addr) + s_header_size;
+  m_header = new (addr) ShmRingHeader();
+  m_header->version = s_version;
+  m_header->capacity = ring_capacity;
+  m_header->receiver_pid = getpid();
+  // Senders only use the ring once the magic is set
+  m_header->magic.store(s_magic, std::memory_order_release);
+  TLOG_DEBUG(26) << "Created shared memory ring " << path << " of " << ring_capacity << " bytes";
+}
+
+void
+ShmMapping::open(std::string const& name)
+{
+  unmap();
+  auto path = get_shm_path(name);
+  int fd = shm_open(path.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    throw SharedMemoryFailure(ERS_HERE, name, "shm_open", std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= s_header_size) {
+    close(fd);
+    throw SharedMemoryFailure(ERS_HERE, name, "open", "ring is not initialized yet");
+  }
+  auto size = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  auto error = errno;
+  close(fd);
+  if (addr == MAP_FAILED) {
+    throw SharedMemoryFailure(ERS_HERE, name, "mmap", std::strerror(error));
+  }
+
+  auto header = static_cast<ShmRingHeader*>(addr);
+  std::string problem;
+  if (header->magic.load(std::memory_order_acquire) != s_magic) {
+    problem = "ring is not initialized yet";
+  } else if (header->version != s_version) {
+    problem = "ring has version " + std::to_string(header->version) + ", expected " + std::to_string(s_version);
+  } else if (header->capacity + s_header_size != size) {
+    problem = "ring size does not match its header";
+  } else if (header->closed.load() != 0 || !is_process_alive(header->receiver_pid.load())) {
+    problem = "receiver has gone away";
+  }
+  if (!problem.empty()) {
+    munmap(addr, size);
+    throw SharedMemoryFailure(ERS_HERE, name, "open", problem);
+  }
+
+  m_name = name;
+  m_size = size;
+  m_inode = st.st_ino;
+  m_owner = false;
+  m_header = header;
+  m_data = static_cast<uint8_t*>(addr) + s_header_size;
+}
+
+void
+ShmMapping::unmap()
+{
+  if (m_header == nullptr) {
+    return;
+  }
+  if (m_owner) {
+    // Wake all waiting senders, which then find the ring closed
+    m_header->closed = 1;
+    m_header->space_seq.fetch_add(1);
+    futex_wake(m_header->space_seq, INT_MAX);
+    futex_wake(m_header->producer_lock, INT_MAX);
+
+    // Only remove the name if it still refers to this ring
+    auto path = get_shm_path(m_name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+      struct stat st;
+      if (fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_ino) == m_inode) {
+        shm_unlink(path.c_str());
+      }
+      close(fd);
+    }
+  }
+  munmap(m_header, m_size);
+  m_header = nullptr;
+  m_data = nullptr;
+  m_size = 0;
+}
+
+} // namespace detail
+
+ShmReceiver::ShmReceiver(size_t capacity)
+  : m_capacity(capacity)
+{
+}
+
+ShmReceiver::~ShmReceiver()
+{
+  std::lock_guard<std::mutex> lk(m_receive_mutex);
+  m_mapping.unmap();
+}
+
+std::string
+ShmReceiver::connect_for_receives(const nlohmann::json& connection_info)
+{
+  auto uri = connection_info.value<std::string>("connection_string", "");
+  std::lock_guard<std::mutex> lk(m_receive_mutex);
+  m_mapping.create(get_shm_name(uri), m_capacity);
+  return uri;
+}
+
+ipm::Receiver::Response
+ShmReceiver::receive_(const duration_t& timeout, bool no_tmoexcept_mode)
+{
+  std::lock_guard<std::mutex> lk(m_receive_mutex);
+  if (!m_mapping.is_mapped()) {
+    throw SharedMemoryFailure(ERS_HERE, "", "receive", "not connected");
+  }
+  auto& header = *m_mapping.header();
+  auto data = m_mapping.data();
+  auto capacity = header.capacity;
+  auto deadline = get_deadline(timeout);
+
+  auto release = [&](uint64_t tail) {
+    // Sequentially consistent with producer_waiting, so that a waiting sender is never missed
+    header.tail.store(tail);
+    if (header.producer_waiting.load() != 0) {
+      header.space_seq.fetch_add(1);
+      futex_wake(header.space_seq, 1);
+    }
+  };
+
+  while (true) {
+    auto tail = header.tail.load(std::memory_order_relaxed);
+    if (header.head.load(std::memory_order_acquire) != tail) {
+      auto pos = tail & (capacity - 1);
+      uint32_t size = 0;
+      std::memcpy(&size, data + pos, sizeof(size));
+      if (size == s_padding) {
+        release(tail + (capacity - pos));
+        continue;
+      }
+      Response response;
+      response.data.resize(size);
+      std::memcpy(response.data.data(), data + pos + s_record_header_size, size);
+      release(tail + record_size(size));
+      return response;
+    }
+
+    auto seq = header.data_seq.load();
+    header.consumer_waiting = 1;
+    if (header.head.load() != tail) {
+      header.consumer_waiting = 0;
+      continue;
+    }
+    auto wait = get_wait(deadline);
+    if (wait <= std::chrono::milliseconds(0)) {
+      header.consumer_waiting = 0;
+      if (!no_tmoexcept_mode) {
+        throw ipm::ReceiveTimeoutExpired(ERS_HERE, timeout.count());
+      }
+      return Response();
+    }
+    futex_wait(header.data_seq, seq, wait);
+    header.consumer_waiting = 0;
+  }
+}
+
+std::string
+ShmSender::connect_for_sends(const nlohmann::json& connection_info)
+{
+  auto uri = connection_info.value<std::string>("connection_string", "");
+  std::lock_guard<std::mutex> lk(m_send_mutex);
+  m_mapping.open(get_shm_name(uri));
+  m_last_liveness_check = std::chrono::steady_clock::now();
+  return uri;
+}
+
+bool
+ShmSender::send_(const void* message,
+                 message_size_t N,
+                 const duration_t& timeout,
+                 std::string const& topic,
+                 bool no_tmoexcept_mode)
+{
+  std::vector<BufferSegment> segments{ { static_cast<const uint8_t*>(message), static_cast<size_t>(N) } };
+  return send_segments(segments, timeout, topic, no_tmoexcept_mode);
+}
+
+bool
+ShmSender::is_receiver_alive(bool force)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (!force && now - m_last_liveness_check < s_liveness_interval) {
+    return true;
+  }
+  m_last_liveness_check = now;
+  return is_process_alive(m_mapping.header()->receiver_pid.load());
+}
+
+bool
+ShmSender::send_segments(std::vector<BufferSegment> const& segments,
+                         std::chrono::milliseconds timeout,
+                         std::string const&,
+                         bool no_tmoexcept_mode)
+{
+  std::lock_guard<std::mutex> lk(m_send_mutex);
+  if (!m_mapping.is_mapped()) {
+    throw SharedMemoryFailure(ERS_HERE, "", "send", "not connected");
+  }
+  auto& header = *m_mapping.header();
+  auto data = m_mapping.data();
+  auto capacity = header.capacity;
+
+  size_t size = 0;
+  for (auto& segment : segments) {
+    size += segment.size;
+  }
+  // Up to half the ring, so that a record always fits once the ring has drained
+  if (record_size(size) > capacity / 2) {
+    throw SharedMemoryFailure(ERS_HERE,
+                              m_mapping.name(),
+                              "send",
+                              "message of " + std::to_string(size) + " bytes is larger than half the ring");
+  }
+
+  // A ring without receiver fails like a timeout, so that the connection is re-established
+  auto fail = [&]() {
+    if (no_tmoexcept_mode) {
+      return false;
+    }
+    throw ipm::SendTimeoutExpired(ERS_HERE, timeout.count());
+  };
+  if (header.closed.load() != 0 || !is_receiver_alive(false)) {
+    return fail();
+  }
+
+  auto deadline = get_deadline(timeout);
+  if (!lock_producer(header, deadline)) {
+    return fail();
+  }
+
+  auto need = record_size(size);
+  uint64_t head = 0;
+  uint64_t pos = 0;
+  uint64_t contiguous = 0;
+  while (true) {
+    head = header.head.load(std::memory_order_relaxed);
+    pos = head & (capacity - 1);
+    contiguous = capacity - pos;
+    auto total = need + (contiguous < need ? contiguous : 0);
+    if (capacity - (head - header.tail.load(std::memory_order_acquire)) >= total) {
+      break;
+    }
+
+    auto seq = header.space_seq.load();
+    header.producer_waiting = 1;
+    if (capacity - (head - header.tail.load()) >= total) {
+      continue;
+    }
+    auto wait = get_wait(deadline);
+    if (header.closed.load() != 0 || !is_receiver_alive(true) || wait <= std::chrono::milliseconds(0)) {
+      header.producer_waiting = 0;
+      unlock_producer(header);
+      return fail();
+    }
+    futex_wait(header.space_seq, seq, wait);
+  }
+  header.producer_waiting = 0;
+
+  if (contiguous < need) {
+    std::memcpy(data + pos, &s_padding, sizeof(s_padding));
+    head += contiguous;
+    pos = 0;
+  }
+  auto record_length = static_cast<uint32_t>(size);
+  std::memcpy(data + pos, &record_length, sizeof(record_length));
+  auto offset = pos + s_record_header_size;
+  for (auto& segment : segments) {
+    std::memcpy(data + offset, segment.data, segment.size);
+    offset += segment.size;
+  }
+
+  // Sequentially consistent with consumer_waiting, so that a waiting receiver is never missed
+  header.head.store(head + need);
+  if (header.consumer_waiting.load() != 0) {
+    header.data_seq.fetch_add(1);
+    futex_wake(header.data_seq, 1);
+  }
+  unlock_producer(header);
+  return true;
+}
+
+} // namespace dunedaq::iomanager
@@ -0,0 +1,177 @@
+/**
+ * @file BenchmarkConnectivityService.hpp
+ *
+ * In-process stand-in for the Connectivity Service, for the benchmark applications
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_TEST_APPS_BENCHMARKCONNECTIVITYSERVICE_HPP_
+#define IOMANAGER_TEST_APPS_BENCHMARKCONNECTIVITYSERVICE_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dunedaq::iomanager::benchmark {
+
+/**
+ * @brief Minimal HTTP server implementing the Connectivity Service requests made by ConfigClient
+ *
+ * Serves POST /publish, /retract and /getconnection/<session> on 127.0.0.1, one request per
+ * connection, from a single thread. Lookups match uid_regex against the whole uid and require the
+ * same data_type; no match is answered with 404, like the real service. Registrations do not expire.
+ */
+class StandInConnectivityService
+{
+public:
+  StandInConnectivityService()
+    : m_acceptor(m_io_context, { boost::asio::ip::make_address("127.0.0.1"), 0 })
+  {
+    m_thread = std::thread([this]() { serve(); });
+  }
+
+  ~StandInConnectivityService()
+  {
+    m_running = false;
+    // Wake up the blocking accept
+    boost::system::error_code ec;
+    boost::asio::ip::tcp::socket socket(m_io_context);
+    socket.connect(m_acceptor.local_endpoint(), ec);
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  StandInConnectivityService(StandInConnectivityService const&) = delete;
+  StandInConnectivityService& operator=(StandInConnectivityService const&) = delete;
+
+  uint16_t get_port() const { return m_acceptor.local_endpoint().port(); }
+
+  size_t get_registration_count() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    size_t count = 0;
+    for (auto& [session, registrations] : m_registrations) {
+      count += registrations.size();
+    }
+    return count;
+  }
+
+  // Requests served so far, by target ("/publish", "/retract" or "/getconnection")
+  std::map<std::string, size_t> get_request_counts() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_request_counts;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_registrations.clear();
+    m_request_counts.clear();
+  }
+
+private:
+  using Registrations = std::map<std::pair<std::string, std::string>, nlohmann::json>;
+
+  void serve()
+  {
+    namespace http = boost::beast::http;
+    while (m_running) {
+      boost::asio::ip::tcp::socket socket(m_io_context);
+      boost::system::error_code ec;
+      m_acceptor.accept(socket, ec);
+      if (ec || !m_running) {
+        continue;
+      }
+      boost::beast::flat_buffer buffer;
+      http::request<http::string_body> request;
+      http::read(socket, buffer, request, ec);
+      if (ec) {
+        continue;
+      }
+      http::response<http::string_body> response{ http::status::ok, request.version() };
+      response.set(http::field::content_type, "application/json");
+      try {
+        response.result(handle(std::string(request.target()), request.body(), response.body()));
+      } catch (std::exception const& ex) {
+        response.result(http::status::bad_request);
+        response.body() = ex.what();
+      }
+      response.prepare_payload();
+      http::write(socket, response, ec);
+      socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    }
+  }
+
+  boost::beast::http::status handle(std::string const& target, std::string const& body, std::string& reply)
+  {
+    namespace http = boost::beast::http;
+    static const std::string s_lookup_target = "/getconnection/";
+    auto request = nlohmann::json::parse(body);
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (target == "/publish") {
+      ++m_request_counts["/publish"];
+      auto& registrations = m_registrations[request.at("partition").get<std::string>()];
+      for (auto& connection : request.at("connections")) {
+        registrations[{ connection.at("uid").get<std::string>(), connection.at("data_type").get<std::string>() }] =
+          connection;
+      }
+      return http::status::ok;
+    }
+    if (target == "/retract") {
+      ++m_request_counts["/retract"];
+      auto& registrations = m_registrations[request.at("partition").get<std::string>()];
+      for (auto& connection : request.at("connections")) {
+        registrations.erase(
+          { connection.at("connection_id").get<std::string>(), connection.at("data_type").get<std::string>() });
+      }
+      return http::status::ok;
+    }
+    if (target.rfind(s_lookup_target, 0) == 0) {
+      ++m_request_counts["/getconnection"];
+      std::regex uid_regex(request.at("uid_regex").get<std::string>());
+      auto data_type = request.at("data_type").get<std::string>();
+      auto result = nlohmann::json::array();
+      for (auto& [key, connection] : m_registrations[target.substr(s_lookup_target.size())]) {
+        if (key.second == data_type && std::regex_match(key.first, uid_regex)) {
+          result.push_back(connection);
+        }
+      }
+      if (result.empty()) {
+        return http::status::not_found;
+      }
+      reply = result.dump();
+      return http::status::ok;
+    }
+    return http::status::not_found;
+  }
+
+  boost::asio::io_context m_io_context;
+  boost::asio::ip::tcp::acceptor m_acceptor;
+  std::atomic<bool> m_running{ true };
+  std::thread m_thread;
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Registrations> m_registrations; // By session
+  std::map<std::string, size_t> m_request_counts;
+};
+
+} // namespace dunedaq::iomanager::benchmark
+
+#endif // IOMANAGER_TEST_APPS_BENCHMARKCONNECTIVITYSERVICE_HPP_
@@ -0,0 +1,266 @@
+/**
+ * @file BenchmarkUtilities.hpp
+ *
+ * Latency histograms, thread pinning, process statistics and JSON output shared by the benchmark applications
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef IOMANAGER_TEST_APPS_BENCHMARKUTILITIES_HPP_
+#define IOMANAGER_TEST_APPS_BENCHMARKUTILITIES_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq::iomanager::benchmark {
+
+/**
+ * @brief Histogram of latencies in nanoseconds with a relative resolution of 1/64
+ *
+ * Values below 64 have a bucket each; above, every power of two is split into 64 buckets.
+ * Recording is a few instructions, so one histogram per thread can take millions of samples,
+ * and histograms of several threads are merged afterwards. Percentiles report the upper
+ * bound of the bucket holding the requested rank, capped at the exact maximum.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr unsigned s_sub_bucket_bits = 6;
+  static constexpr uint64_t s_sub_buckets = 1ULL << s_sub_bucket_bits;
+  static constexpr size_t s_bucket_count = s_sub_buckets + (64 - s_sub_bucket_bits) * s_sub_buckets;
+
+  LatencyHistogram()
+    : m_counts(s_bucket_count, 0)
+  {
+  }
+
+  void record(uint64_t ns)
+  {
+    ++m_counts[get_bucket(ns)];
+    ++m_count;
+    m_sum += ns;
+    m_min = std::min(m_min, ns);
+    m_max = std::max(m_max, ns);
+  }
+
+  void record(std::chrono::steady_clock::duration duration)
+  {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    record(static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+  }
+
+  void merge(LatencyHistogram const& other)
+  {
+    for (size_t ii = 0; ii < s_bucket_count; ++ii) {
+      m_counts[ii] += other.m_counts[ii];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+  }
+
+  uint64_t count() const { return m_count; }
+  uint64_t min() const { return m_count == 0 ? 0 : m_min; }
+  uint64_t max() const { return m_max; }
+  double mean() const { return m_count == 0 ? 0. : static_cast<double>(m_sum) / static_cast<double>(m_count); }
+
+  // Smallest recorded value (to the histogram's resolution) which percent of the values do not exceed
+  uint64_t percentile(double percent) const
+  {
+    if (m_count == 0) {
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(percent / 100. * static_cast<double>(m_count)));
+    rank = std::clamp<uint64_t>(rank, 1, m_count);
+    uint64_t seen = 0;
+    for (size_t ii = 0; ii < s_bucket_count; ++ii) {
+      seen += m_counts[ii];
+      if (seen >= rank) {
+        return std::min(get_upper_bound(ii), m_max);
+      }
+    }
+    return m_max;
+  }
+
+  nlohmann::json to_json() const
+  {
+    return { { "count", count() },
+             { "min_ns", min() },
+             { "mean_ns", mean() },
+             { "p50_ns", percentile(50) },
+             { "p90_ns", percentile(90) },
+             { "p99_ns", percentile(99) },
+             { "p99_9_ns", percentile(99.9) },
+             { "p99_99_ns", percentile(99.99) },
+             { "max_ns", max() } };
+  }
+
+  static size_t get_bucket(uint64_t value)
+  {
+    if (value < s_sub_buckets) {
+      return static_cast<size_t>(value);
+    }
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    unsigned shift = msb - s_sub_bucket_bits;
+    auto sub = (value >> shift) - s_sub_buckets;
+    return static_cast<size_t>(s_sub_buckets + shift * s_sub_buckets + sub);
+  }
+
+  static uint64_t get_upper_bound(size_t bucket)
+  {
+    if (bucket < s_sub_buckets) {
+      return bucket;
+    }
+    auto shift = (bucket - s_sub_buckets) / s_sub_buckets;
+    auto sub = (bucket - s_sub_buckets) % s_sub_buckets + s_sub_buckets;
+    if (sub + 1 > (std::numeric_limits<uint64_t>::max() >> shift)) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    return ((sub + 1) << shift) - 1;
+  }
+
+private:
+  std::vector<uint64_t> m_counts;
+  uint64_t m_count{ 0 };
+  uint64_t m_sum{ 0 };
+  uint64_t m_min{ std::numeric_limits<uint64_t>::max() };
+  uint64_t m_max{ 0 };
+};
+
+inline uint64_t
+now_ns()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// CPU time used by all threads of the process so far
+inline double
+get_process_cpu_seconds()
+{
+  timespec ts{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+// Resident set size of the process, 0 if unavailable
+inline size_t
+get_resident_bytes()
+{
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t resident = 0;
+  if (!(statm >> pages >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Number of threads in the process, 0 if unavailable
+inline size_t
+get_thread_count()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("Threads:", 0) == 0) {
+      return std::stoul(line.substr(8));
+    }
+  }
+  return 0;
+}
+
+// Pin the calling thread to one CPU; returns false if the CPU is not available
+inline bool
+pin_current_thread(int cpu)
+{
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Comma-separated list, e.g. "1,2,4"
+template<typename T>
+std::vector<T>
+parse_list(std::string const& text)
+{
+  std::vector<T> values;
+  std::istringstream stream(text);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    std::istringstream item_stream(item);
+    T value{};
+    item_stream >> value;
+    if (item_stream.fail()) {
+      throw std::invalid_argument("Cannot parse \"" + item + "\" in list \"" + text + "\"");
+    }
+    values.push_back(value);
+  }
+  return values;
+}
+
+// Whether every value in the comma-separated list is allowed; reports the first one which is not
+inline bool
+check_list_values(std::string const& option, std::string const& list, std::vector<std::string> const& allowed)
+{
+  for (auto& value : parse_list<std::string>(list)) {
+    if (std::find(allowed.begin(), allowed.end(), value) == allowed.end()) {
+      std::cerr << "Unknown value " << value << " for --" << option << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Information identifying the machine a benchmark ran on
+inline nlohmann::json
+get_host_info()
+{
+  char hostname[256] = {};
+  gethostname(hostname, sizeof(hostname) - 1);
+  return { { "hostname", hostname },
+           { "hardware_concurrency", std::thread::hardware_concurrency() },
+           { "started_at",
+             std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+               .count() } };
+}
+
+// Write results to path, or to stdout if path is "-"
+inline void
+write_json(nlohmann::json const& results, std::string const& path)
+{
+  if (path == "-") {
+    std::cout << results.dump(2) << std::endl;
+    return;
+  }
+  std::ofstream output(path);
+  output << results.dump(2) << std::endl;
+}
+
+} // namespace dunedaq::iomanager::benchmark
+
+#endif // IOMANAGER_TEST_APPS_BENCHMARKUTILITIES_HPP_
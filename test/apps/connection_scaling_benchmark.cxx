@@ -0,0 +1,298 @@
+/**
+ * @file connection_scaling_benchmark.cxx
+ *
+ * Time taken by IOManager configure, first and repeated get_sender/get_receiver, shutdown and
+ * reset, together with memory use and thread count, as the number of queues and network
+ * connections grows. Configurations are generated, and lookups can go through an in-process
+ * stand-in for the Connectivity Service. Results are written as JSON.
+ *
+ * Run "connection_scaling_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkConnectivityService.hpp"
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
+#include "logging/Logging.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+#include "serialization/Serialization.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager::benchmark {
+struct ScalingMessage
+{
+  uint64_t value{ 0 };
+
+  DUNE_DAQ_SERIALIZE(ScalingMessage, value);
+};
+} // namespace iomanager::benchmark
+DUNE_DAQ_SERIALIZABLE(iomanager::benchmark::ScalingMessage, "ScalingMessage");
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+using dunedaq::iomanager::test::SyntheticConfiguration;
+
+namespace {
+
+struct Step
+{
+  size_t index;
+  std::string mode; // preconfigured or connectivity_service
+  size_t connections;
+  size_t queues;
+  std::string protocol;
+  std::string queue_type;
+  uint16_t port;
+  uint32_t publish_interval_ms;
+  std::chrono::milliseconds publish_timeout;
+};
+
+double
+seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Call function(ii) for ii in [0, count), timing each call
+nlohmann::json
+time_calls(size_t count, std::function<void(size_t)> const& function)
+{
+  LatencyHistogram latency;
+  size_t failures = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < count; ++ii) {
+    auto call_start = std::chrono::steady_clock::now();
+    try {
+      function(ii);
+    } catch (ers::Issue const& ex) {
+      if (failures++ == 0) {
+        ers::warning(ex);
+      }
+    }
+    latency.record(std::chrono::steady_clock::now() - call_start);
+  }
+  return { { "calls", count },
+           { "seconds", seconds_since(start) },
+           { "failures", failures },
+           { "latency", latency.to_json() } };
+}
+
+nlohmann::json
+get_process_snapshot()
+{
+  return { { "resident_bytes", get_resident_bytes() }, { "threads", get_thread_count() } };
+}
+
+nlohmann::json
+run_step(Step const& s, StandInConnectivityService* service)
+{
+  nlohmann::json result{ { "mode", s.mode },
+                         { "connections", s.connections },
+                         { "queues", s.queues },
+                         { "protocol", s.protocol },
+                         { "queue_type", s.queue_type } };
+  result["process"]["before"] = get_process_snapshot();
+
+  auto prefix = "scaling_" + std::to_string(s.index) + "_";
+  auto connection_uid = [&](size_t ii) { return prefix + "connection_" + std::to_string(ii); };
+  auto queue_uid = [&](size_t ii) { return prefix + "queue_" + std::to_string(ii); };
+
+  auto start = std::chrono::steady_clock::now();
+  SyntheticConfiguration config;
+  for (size_t ii = 0; ii < s.queues; ++ii) {
+    config.add_queue(queue_uid(ii), "ScalingMessage", s.queue_type, 16);
+  }
+  for (size_t ii = 0; ii < s.connections; ++ii) {
+    // With the Connectivity Service, tcp receivers bind to any port and publish the one they got
+    uint16_t port = 0;
+    if (s.protocol == "tcp" && service == nullptr) {
+      port = static_cast<uint16_t>(s.port + ii);
+    }
+    config.add_network_connection(
+      connection_uid(ii), "ScalingMessage", "kSendRecv", s.protocol, connection_uid(ii), port);
+  }
+  if (service != nullptr) {
+    service->clear();
+    config.set_connectivity_service("127.0.0.1", service->get_port(), s.publish_interval_ms);
+  }
+  config.load();
+  result["load_configuration_seconds"] = seconds_since(start);
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  start = std::chrono::steady_clock::now();
+  IOManager::get()->configure("connection_scaling_benchmark",
+                              config.get_queues(),
+                              config.get_connections(),
+                              config.get_connectivity_service(),
+                              opmgr);
+  result["configure_seconds"] = seconds_since(start);
+  result["process"]["after_configure"] = get_process_snapshot();
+
+  std::vector<std::shared_ptr<SenderConcept<ScalingMessage>>> senders;
+  std::vector<std::shared_ptr<ReceiverConcept<ScalingMessage>>> receivers;
+  senders.reserve(s.queues + s.connections);
+  receivers.reserve(s.queues + s.connections);
+
+  // Receivers first, so that network receivers are bound (and published) before senders connect
+  result["get_receiver"]["queue"] = time_calls(s.queues, [&](size_t ii) {
+    receivers.push_back(
+      IOManager::get()->get_receiver<ScalingMessage>(ConnectionId{ queue_uid(ii), "ScalingMessage" }));
+  });
+  result["get_receiver"]["network"] = time_calls(s.connections, [&](size_t ii) {
+    receivers.push_back(
+      IOManager::get()->get_receiver<ScalingMessage>(ConnectionId{ connection_uid(ii), "ScalingMessage" }));
+  });
+
+  if (service != nullptr) {
+    // ConfigClient publishes from a background thread every publish_interval_ms
+    start = std::chrono::steady_clock::now();
+    while (service->get_registration_count() < s.connections &&
+           std::chrono::steady_clock::now() - start < s.publish_timeout) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    result["publish_wait_seconds"] = seconds_since(start);
+    result["published_connections"] = service->get_registration_count();
+  }
+
+  result["get_sender"]["queue"] = time_calls(s.queues, [&](size_t ii) {
+    senders.push_back(IOManager::get()->get_sender<ScalingMessage>(ConnectionId{ queue_uid(ii), "ScalingMessage" }));
+  });
+  result["get_sender"]["network"] = time_calls(s.connections, [&](size_t ii) {
+    senders.push_back(
+      IOManager::get()->get_sender<ScalingMessage>(ConnectionId{ connection_uid(ii), "ScalingMessage" }));
+  });
+
+  // Lookups of existing Senders and Receivers, which applications make on every use of get_iom_sender
+  result["cached_get_sender"] = time_calls(s.queues + s.connections, [&](size_t ii) {
+    auto uid = ii < s.queues ? queue_uid(ii) : connection_uid(ii - s.queues);
+    IOManager::get()->get_sender<ScalingMessage>(ConnectionId{ uid, "ScalingMessage" });
+  });
+  result["cached_get_receiver"] = time_calls(s.queues + s.connections, [&](size_t ii) {
+    auto uid = ii < s.queues ? queue_uid(ii) : connection_uid(ii - s.queues);
+    IOManager::get()->get_receiver<ScalingMessage>(ConnectionId{ uid, "ScalingMessage" });
+  });
+  result["process"]["after_lookups"] = get_process_snapshot();
+
+  senders.clear();
+  receivers.clear();
+  start = std::chrono::steady_clock::now();
+  IOManager::get()->shutdown();
+  result["shutdown_seconds"] = seconds_since(start);
+  start = std::chrono::steady_clock::now();
+  IOManager::get()->reset();
+  result["reset_seconds"] = seconds_since(start);
+  result["process"]["after_reset"] = get_process_snapshot();
+
+  if (service != nullptr) {
+    result["connectivity_service_requests"] = service->get_request_counts();
+  }
+  return result;
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string sizes = "10,100,1000,5000";
+  std::string modes = "preconfigured,connectivity_service";
+  std::string protocol = "inproc";
+  std::string queue_type = "kFollySPSCQueue";
+  std::string output = "connection_scaling_benchmark.json";
+  double queues_per_connection = 1.;
+  uint16_t port = 20000;
+  uint32_t publish_interval_ms = 100;
+  size_t publish_timeout_ms = 60000;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()(
+    "sizes", bpo::value(&sizes)->default_value(sizes), "Comma-separated numbers of network connections per step")(
+    "queues_per_connection",
+    bpo::value(&queues_per_connection)->default_value(queues_per_connection),
+    "Queues configured per network connection")(
+    "modes",
+    bpo::value(&modes)->default_value(modes),
+    "Comma-separated lookup modes, preconfigured and/or connectivity_service")(
+    "protocol", bpo::value(&protocol)->default_value(protocol), "Network connection protocol, inproc or tcp")(
+    "queue_type", bpo::value(&queue_type)->default_value(queue_type), "confmodel queue_type of the queues")(
+    "port",
+    bpo::value(&port)->default_value(port),
+    "First port of preconfigured tcp connections; each connection uses the next one")(
+    "publish_interval_ms",
+    bpo::value(&publish_interval_ms)->default_value(publish_interval_ms),
+    "Connectivity Service publish interval")(
+    "publish_timeout_ms",
+    bpo::value(&publish_timeout_ms)->default_value(publish_timeout_ms),
+    "Time allowed for all receivers to be published to the Connectivity Service")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")(
+    "help,h", "produce help message");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+  if (!check_list_values("modes", modes, { "preconfigured", "connectivity_service" }) ||
+      !check_list_values("protocol", protocol, { "inproc", "tcp" }) ||
+      !check_list_values("queue_type", queue_type, { "kStdDeQueue", "kFollySPSCQueue", "kFollyMPMCQueue" })) {
+    return 1;
+  }
+
+  nlohmann::json results;
+  results["benchmark"] = "connection_scaling";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+
+  std::unique_ptr<StandInConnectivityService> service;
+  size_t index = 0;
+  for (auto& mode : parse_list<std::string>(modes)) {
+    if (mode == "connectivity_service" && service == nullptr) {
+      service = std::make_unique<StandInConnectivityService>();
+    }
+    for (auto size : parse_list<size_t>(sizes)) {
+      Step s{ index++,
+              mode,
+              size,
+              static_cast<size_t>(static_cast<double>(size) * queues_per_connection),
+              protocol,
+              queue_type,
+              port,
+              publish_interval_ms,
+              std::chrono::milliseconds(publish_timeout_ms) };
+      auto result = run_step(s, mode == "connectivity_service" ? service.get() : nullptr);
+      TLOG() << mode << " connections=" << s.connections << " queues=" << s.queues << ": configure "
+             << result["configure_seconds"].get<double>() << " s, first get_sender "
+             << result["get_sender"]["network"]["seconds"].get<double>() << " s, reset "
+             << result["reset_seconds"].get<double>() << " s";
+      results["results"].push_back(std::move(result));
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
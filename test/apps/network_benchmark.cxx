@@ -0,0 +1,366 @@
+/**
+ * @file network_benchmark.cxx
+ *
+ * Throughput, latency and CPU cost of network connections driven through the IOManager API,
+ * swept over transport, connection type, receive mode, sender thread count and message size.
+ * Results are written as JSON.
+ *
+ * Run "network_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
+#include "logging/Logging.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+#include "serialization/Serialization.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager::benchmark {
+struct BenchmarkMessage
+{
+  uint64_t sent_ns{ 0 };
+  uint64_t sequence{ 0 };
+  bool warmup{ false };
+  std::vector<uint8_t> payload;
+
+  DUNE_DAQ_SERIALIZE(BenchmarkMessage, sent_ns, sequence, warmup, payload);
+};
+} // namespace iomanager::benchmark
+DUNE_DAQ_SERIALIZABLE(iomanager::benchmark::BenchmarkMessage, "BenchmarkMessage");
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+using dunedaq::iomanager::test::SyntheticConfiguration;
+
+namespace {
+
+constexpr Sender::timeout_t s_send_timeout{ 1000 };
+constexpr Receiver::timeout_t s_receive_timeout{ 10 };
+constexpr auto s_idle_poll = std::chrono::milliseconds(1);
+
+struct Case
+{
+  size_t index;
+  std::string protocol;
+  std::string pattern; // sendrecv or pubsub
+  std::string receive_mode;
+  size_t senders;
+  size_t message_size;
+  size_t messages;
+  size_t warmup_messages;
+  uint16_t port;
+  std::chrono::milliseconds idle_timeout;
+  std::chrono::milliseconds connect_timeout;
+};
+
+/**
+ * Receiving side of a case: counts measured messages and their latencies, and remembers when the
+ * last one arrived. Callbacks and the direct receive thread both call handle().
+ */
+class ReceiveState
+{
+public:
+  void handle(BenchmarkMessage const& message)
+  {
+    auto received_ns = now_ns();
+    if (message.warmup) {
+      m_warmup_received.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lk(m_latency_mutex);
+      m_latency.record(received_ns - message.sent_ns);
+    }
+    m_last_received_ns.store(received_ns, std::memory_order_relaxed);
+    m_received.fetch_add(1, std::memory_order_release);
+  }
+
+  size_t get_received() const { return m_received.load(std::memory_order_acquire); }
+  size_t get_warmup_received() const { return m_warmup_received.load(std::memory_order_relaxed); }
+  uint64_t get_last_received_ns() const { return m_last_received_ns.load(std::memory_order_relaxed); }
+  LatencyHistogram get_latency()
+  {
+    std::lock_guard<std::mutex> lk(m_latency_mutex);
+    return m_latency;
+  }
+
+private:
+  std::atomic<size_t> m_received{ 0 };
+  std::atomic<size_t> m_warmup_received{ 0 };
+  std::atomic<uint64_t> m_last_received_ns{ 0 };
+  std::mutex m_latency_mutex;
+  LatencyHistogram m_latency;
+};
+
+BenchmarkMessage
+make_message(Case const& c, uint64_t sequence, bool warmup)
+{
+  BenchmarkMessage message;
+  message.sequence = sequence;
+  message.warmup = warmup;
+  message.payload.resize(c.message_size);
+  message.sent_ns = now_ns();
+  return message;
+}
+
+// Wait until count() reaches target, or stops increasing for idle_timeout
+template<typename Count>
+void
+wait_for(Count count, size_t target, std::chrono::milliseconds idle_timeout)
+{
+  auto last_count = count();
+  auto last_change = std::chrono::steady_clock::now();
+  while (last_count < target && std::chrono::steady_clock::now() - last_change < idle_timeout) {
+    std::this_thread::sleep_for(s_idle_poll);
+    auto current = count();
+    if (current != last_count) {
+      last_count = current;
+      last_change = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+nlohmann::json
+run_case(Case const& c)
+{
+  auto uid = "network_benchmark_" + std::to_string(c.index);
+  SyntheticConfiguration config;
+  config.add_network_connection(uid,
+                                "BenchmarkMessage",
+                                c.pattern == "pubsub" ? "kPubSub" : "kSendRecv",
+                                c.protocol,
+                                uid,
+                                c.protocol == "tcp" ? c.port : 0);
+  config.load();
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  IOManager::get()->configure("network_benchmark", config.get_queues(), config.get_connections(), nullptr, opmgr);
+
+  ConnectionId id{ uid, "BenchmarkMessage" };
+  ReceiveState state;
+  auto receiver = IOManager::get()->get_receiver<BenchmarkMessage>(id);
+  std::atomic<bool> receiving{ true };
+  std::thread receive_thread;
+  if (c.receive_mode == "callback") {
+    receiver->add_callback([&](BenchmarkMessage& message) { state.handle(message); });
+  } else {
+    receive_thread = std::thread([&]() {
+      while (receiving.load(std::memory_order_relaxed)) {
+        auto message = receiver->try_receive(s_receive_timeout);
+        if (message) {
+          state.handle(*message);
+        }
+      }
+    });
+  }
+  auto sender = IOManager::get()->get_sender<BenchmarkMessage>(id);
+
+  // Subscriptions (and tcp connections) are established asynchronously, so send until a message gets through
+  auto connect_start = std::chrono::steady_clock::now();
+  uint64_t sequence = 0;
+  while (state.get_warmup_received() == 0 && std::chrono::steady_clock::now() - connect_start < c.connect_timeout) {
+    sender->try_send(make_message(c, sequence++, true), s_send_timeout);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  auto connected = state.get_warmup_received() > 0;
+  auto connect_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connect_start).count();
+
+  std::atomic<size_t> sent{ 0 };
+  std::atomic<size_t> send_failures{ 0 };
+  double seconds = 0;
+  double cpu_seconds = 0;
+  if (connected) {
+    for (size_t ii = 0; ii < c.warmup_messages; ++ii) {
+      sender->try_send(make_message(c, sequence++, true), s_send_timeout);
+    }
+    wait_for([&]() { return state.get_warmup_received(); }, sequence, c.idle_timeout);
+
+    std::atomic<size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> senders;
+    for (size_t ss = 0; ss < c.senders; ++ss) {
+      auto count = c.messages / c.senders + (ss < c.messages % c.senders ? 1 : 0);
+      senders.emplace_back([&, count]() {
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+        }
+        for (size_t ii = 0; ii < count; ++ii) {
+          if (sender->try_send(make_message(c, ii, false), s_send_timeout)) {
+            sent.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            send_failures.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+    while (ready.load() < senders.size()) {
+      std::this_thread::yield();
+    }
+    auto cpu_start = get_process_cpu_seconds();
+    auto start_ns = now_ns();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : senders) {
+      thread.join();
+    }
+    wait_for([&]() { return state.get_received(); }, sent.load(), c.idle_timeout);
+    cpu_seconds = get_process_cpu_seconds() - cpu_start;
+    auto end_ns = std::max(state.get_last_received_ns(), start_ns);
+    seconds = static_cast<double>(end_ns - start_ns) * 1e-9;
+  }
+
+  if (c.receive_mode == "callback") {
+    receiver->remove_callback();
+  } else {
+    receiving = false;
+    receive_thread.join();
+  }
+  sender.reset();
+  receiver.reset();
+  IOManager::get()->reset();
+
+  auto received = state.get_received();
+  auto rate = seconds > 0 ? static_cast<double>(received) / seconds : 0.;
+  return { { "protocol", c.protocol },
+           { "pattern", c.pattern },
+           { "receive_mode", c.receive_mode },
+           { "senders", c.senders },
+           { "message_bytes", c.message_size },
+           { "messages", c.messages },
+           { "connected", connected },
+           { "connect_seconds", connect_seconds },
+           { "sent", sent.load() },
+           { "send_failures", send_failures.load() },
+           { "received", received },
+           { "lost", sent.load() - std::min(sent.load(), received) },
+           { "seconds", seconds },
+           { "messages_per_second", rate },
+           { "megabytes_per_second", rate * static_cast<double>(c.message_size) / 1e6 },
+           { "cpu_ns_per_message", received > 0 ? cpu_seconds * 1e9 / static_cast<double>(received) : 0. },
+           { "latency", state.get_latency().to_json() } };
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string protocols = "inproc,tcp";
+  std::string patterns = "sendrecv,pubsub";
+  std::string receive_modes = "callback,direct";
+  std::string senders = "1,4";
+  std::string message_sizes = "64,4096,65536,1048576";
+  std::string output = "network_benchmark.json";
+  size_t messages = 100000;
+  size_t max_bytes = 1000000000;
+  size_t warmup_messages = 1000;
+  uint16_t port = 15600;
+  size_t idle_timeout_ms = 2000;
+  size_t connect_timeout_ms = 5000;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()(
+    "protocols", bpo::value(&protocols)->default_value(protocols), "Comma-separated transports, inproc and/or tcp")(
+    "patterns",
+    bpo::value(&patterns)->default_value(patterns),
+    "Comma-separated connection types, sendrecv and/or pubsub")(
+    "receive_modes",
+    bpo::value(&receive_modes)->default_value(receive_modes),
+    "Comma-separated receive modes, callback and/or direct")(
+    "senders",
+    bpo::value(&senders)->default_value(senders),
+    "Comma-separated numbers of threads sending on the connection")(
+    "message_sizes",
+    bpo::value(&message_sizes)->default_value(message_sizes),
+    "Comma-separated payload sizes in bytes")(
+    "messages", bpo::value(&messages)->default_value(messages), "Messages per measurement")(
+    "max_bytes",
+    bpo::value(&max_bytes)->default_value(max_bytes),
+    "Upper limit on the payload bytes per measurement; fewer messages are sent for large sizes")(
+    "warmup_messages", bpo::value(&warmup_messages)->default_value(warmup_messages), "Messages sent before measuring")(
+    "port", bpo::value(&port)->default_value(port), "First tcp port; each case uses the next one")(
+    "idle_timeout_ms",
+    bpo::value(&idle_timeout_ms)->default_value(idle_timeout_ms),
+    "Time without receives after which the remaining messages are counted as lost")(
+    "connect_timeout_ms",
+    bpo::value(&connect_timeout_ms)->default_value(connect_timeout_ms),
+    "Time allowed for the first message to get through")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")(
+    "help,h", "produce help message");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+
+  if (!check_list_values("protocols", protocols, { "inproc", "tcp" }) ||
+      !check_list_values("patterns", patterns, { "sendrecv", "pubsub" }) ||
+      !check_list_values("receive_modes", receive_modes, { "callback", "direct" })) {
+    return 1;
+  }
+
+  nlohmann::json results;
+  results["benchmark"] = "network";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+
+  size_t index = 0;
+  for (auto& protocol : parse_list<std::string>(protocols)) {
+    for (auto& pattern : parse_list<std::string>(patterns)) {
+      for (auto& receive_mode : parse_list<std::string>(receive_modes)) {
+        for (auto sender_count : parse_list<size_t>(senders)) {
+          for (auto size : parse_list<size_t>(message_sizes)) {
+            Case c{ index,
+                    protocol,
+                    pattern,
+                    receive_mode,
+                    std::max<size_t>(sender_count, 1),
+                    size,
+                    std::max<size_t>(1, std::min(messages, max_bytes / std::max<size_t>(size, 1))),
+                    warmup_messages,
+                    static_cast<uint16_t>(port + index),
+                    std::chrono::milliseconds(idle_timeout_ms),
+                    std::chrono::milliseconds(connect_timeout_ms) };
+            ++index;
+            auto result = run_case(c);
+            TLOG() << protocol << " " << pattern << " " << receive_mode << " senders=" << sender_count
+                   << " size=" << size << ": " << result["messages_per_second"].get<double>() << " msg/s, p99 "
+                   << result["latency"]["p99_ns"].get<uint64_t>() << " ns, lost " << result["lost"].get<size_t>();
+            results["results"].push_back(std::move(result));
+          }
+        }
+      }
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
@@ -0,0 +1,352 @@
+/**
+ * @file pingpong_benchmark.cxx
+ *
+ * Round-trip latency of IOManager Senders and Receivers: a timestamped message is bounced between
+ * two endpoints, over queue pairs or network connections, with callback or blocking receives.
+ * Round-trip latency percentiles are written as JSON.
+ *
+ * Run "pingpong_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
+#include "logging/Logging.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+#include "serialization/Serialization.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager::benchmark {
+struct PingMessage
+{
+  uint64_t sent_ns{ 0 };
+  uint64_t sequence{ 0 };
+  std::vector<uint8_t> payload;
+
+  DUNE_DAQ_SERIALIZE(PingMessage, sent_ns, sequence, payload);
+};
+} // namespace iomanager::benchmark
+DUNE_DAQ_SERIALIZABLE(iomanager::benchmark::PingMessage, "PingMessage");
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+using dunedaq::iomanager::test::SyntheticConfiguration;
+
+namespace {
+
+constexpr Sender::timeout_t s_send_timeout{ 1000 };
+constexpr Receiver::timeout_t s_poll_timeout{ 10 };
+
+struct Case
+{
+  size_t index;
+  std::string endpoint; // queue, inproc or tcp
+  std::string receive_mode;
+  size_t message_size;
+  size_t iterations;
+  size_t warmup_iterations;
+  std::string queue_type;
+  uint16_t port;
+  std::chrono::milliseconds reply_timeout;
+};
+
+/**
+ * State of the initiating side. The round trip with sequence number get_expected() is in flight;
+ * replies with another sequence number (after a timeout and resend) are counted as stale.
+ */
+class PingState
+{
+public:
+  explicit PingState(Case const& c)
+    : m_case(c)
+  {
+  }
+
+  PingMessage make_ping(uint64_t sequence) const
+  {
+    PingMessage message;
+    message.sequence = sequence;
+    message.payload.resize(m_case.message_size);
+    message.sent_ns = now_ns();
+    return message;
+  }
+
+  // Handle a reply; returns true if it completes the round trip in flight
+  bool handle_pong(PingMessage const& message)
+  {
+    auto received_ns = now_ns();
+    auto expected = m_expected.load(std::memory_order_acquire);
+    if (message.sequence != expected) {
+      m_stale.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (expected >= m_case.warmup_iterations) {
+      if (expected == m_case.warmup_iterations) {
+        m_start_ns = received_ns;
+      }
+      m_rtt.record(received_ns - message.sent_ns);
+      m_end_ns = received_ns;
+    }
+    m_expected.store(expected + 1, std::memory_order_release);
+    return true;
+  }
+
+  uint64_t get_expected() const { return m_expected.load(std::memory_order_acquire); }
+  uint64_t get_total() const { return m_case.warmup_iterations + m_case.iterations; }
+  bool is_done() const { return get_expected() >= get_total(); }
+
+  void count_timeout() { m_timeouts.fetch_add(1, std::memory_order_relaxed); }
+  void count_send_failure() { m_send_failures.fetch_add(1, std::memory_order_relaxed); }
+
+  nlohmann::json to_json() const
+  {
+    auto seconds = static_cast<double>(m_end_ns - m_start_ns) * 1e-9;
+    return { { "completed", m_rtt.count() },
+             { "seconds", seconds },
+             { "round_trips_per_second", seconds > 0 ? static_cast<double>(m_rtt.count()) / seconds : 0. },
+             { "timeouts", m_timeouts.load() },
+             { "stale_replies", m_stale.load() },
+             { "send_failures", m_send_failures.load() },
+             { "rtt", m_rtt.to_json() } };
+  }
+
+private:
+  Case const& m_case;
+  std::atomic<uint64_t> m_expected{ 0 };
+  std::atomic<size_t> m_timeouts{ 0 };
+  std::atomic<size_t> m_stale{ 0 };
+  std::atomic<size_t> m_send_failures{ 0 };
+  // Only touched by the thread handling replies, and read once the run is over
+  LatencyHistogram m_rtt;
+  uint64_t m_start_ns{ 0 };
+  uint64_t m_end_ns{ 0 };
+};
+
+nlohmann::json
+run_case(Case const& c)
+{
+  auto ping_uid = "pingpong_benchmark_ping_" + std::to_string(c.index);
+  auto pong_uid = "pingpong_benchmark_pong_" + std::to_string(c.index);
+  // In callback mode pings are sent both by the reply callback and, after a timeout, by the main thread, which a
+  // single-producer queue does not allow
+  auto ping_queue_type = c.queue_type;
+  if (c.receive_mode == "callback" && ping_queue_type == "kFollySPSCQueue") {
+    ping_queue_type = "kFollyMPMCQueue";
+  }
+  SyntheticConfiguration config;
+  if (c.endpoint == "queue") {
+    config.add_queue(ping_uid, "PingMessage", ping_queue_type, 16);
+    config.add_queue(pong_uid, "PingMessage", c.queue_type, 16);
+  } else {
+    auto tcp = c.endpoint == "tcp";
+    config.add_network_connection(ping_uid, "PingMessage", "kSendRecv", c.endpoint, ping_uid, tcp ? c.port : 0);
+    config.add_network_connection(pong_uid, "PingMessage", "kSendRecv", c.endpoint, pong_uid, tcp ? c.port + 1 : 0);
+  }
+  config.load();
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  IOManager::get()->configure("pingpong_benchmark", config.get_queues(), config.get_connections(), nullptr, opmgr);
+
+  ConnectionId ping_id{ ping_uid, "PingMessage" };
+  ConnectionId pong_id{ pong_uid, "PingMessage" };
+  auto ping_receiver = IOManager::get()->get_receiver<PingMessage>(ping_id);
+  auto pong_receiver = IOManager::get()->get_receiver<PingMessage>(pong_id);
+  auto ping_sender = IOManager::get()->get_sender<PingMessage>(ping_id);
+  auto pong_sender = IOManager::get()->get_sender<PingMessage>(pong_id);
+
+  PingState state(c);
+  auto send_ping = [&](uint64_t sequence) {
+    if (!ping_sender->try_send(state.make_ping(sequence), s_send_timeout)) {
+      state.count_send_failure();
+    }
+  };
+  auto cpu_start = get_process_cpu_seconds();
+
+  if (c.receive_mode == "callback") {
+    // Both sides are driven by callbacks: the echo callback returns each ping, and the reply callback starts the next
+    ping_receiver->add_callback([&](PingMessage& message) {
+      if (!pong_sender->try_send(std::move(message), s_send_timeout)) {
+        state.count_send_failure();
+      }
+    });
+    pong_receiver->add_callback([&](PingMessage& message) {
+      if (state.handle_pong(message) && !state.is_done()) {
+        send_ping(state.get_expected());
+      }
+    });
+
+    send_ping(0);
+    auto last_expected = state.get_expected();
+    auto last_progress = std::chrono::steady_clock::now();
+    while (!state.is_done()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      auto expected = state.get_expected();
+      if (expected != last_expected) {
+        last_expected = expected;
+        last_progress = std::chrono::steady_clock::now();
+      } else if (std::chrono::steady_clock::now() - last_progress > c.reply_timeout) {
+        state.count_timeout();
+        send_ping(expected);
+        last_progress = std::chrono::steady_clock::now();
+      }
+    }
+    pong_receiver->remove_callback();
+    ping_receiver->remove_callback();
+  } else {
+    std::atomic<bool> echoing{ true };
+    std::thread echo_thread([&]() {
+      while (echoing.load(std::memory_order_relaxed)) {
+        auto message = ping_receiver->try_receive(s_poll_timeout);
+        if (message && !pong_sender->try_send(std::move(*message), s_send_timeout)) {
+          state.count_send_failure();
+        }
+      }
+    });
+
+    while (!state.is_done()) {
+      auto sequence = state.get_expected();
+      send_ping(sequence);
+      auto sent = std::chrono::steady_clock::now();
+      while (state.get_expected() == sequence) {
+        auto reply = pong_receiver->try_receive(c.reply_timeout);
+        if (reply) {
+          state.handle_pong(*reply);
+        } else if (std::chrono::steady_clock::now() - sent >= c.reply_timeout) {
+          state.count_timeout();
+          break;
+        }
+      }
+    }
+    echoing = false;
+    echo_thread.join();
+  }
+  auto cpu_seconds = get_process_cpu_seconds() - cpu_start;
+
+  ping_sender.reset();
+  pong_sender.reset();
+  ping_receiver.reset();
+  pong_receiver.reset();
+  IOManager::get()->reset();
+
+  auto result = state.to_json();
+  result["endpoint"] = c.endpoint;
+  result["receive_mode"] = c.receive_mode;
+  result["message_bytes"] = c.message_size;
+  result["iterations"] = c.iterations;
+  result["warmup_iterations"] = c.warmup_iterations;
+  if (c.endpoint == "queue") {
+    result["queue_type"] = c.queue_type;
+    result["ping_queue_type"] = ping_queue_type;
+  }
+  auto total = static_cast<double>(state.get_total());
+  result["cpu_ns_per_round_trip"] = cpu_seconds * 1e9 / total;
+  return result;
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string endpoints = "queue,inproc,tcp";
+  std::string receive_modes = "callback,blocking";
+  std::string message_sizes = "64,4096";
+  std::string queue_type = "kFollySPSCQueue";
+  std::string output = "pingpong_benchmark.json";
+  size_t iterations = 1000000;
+  size_t warmup_iterations = 10000;
+  uint16_t port = 15800;
+  size_t reply_timeout_ms = 1000;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()("endpoints",
+                     bpo::value(&endpoints)->default_value(endpoints),
+                     "Comma-separated endpoint pairs: queue, inproc and/or tcp (loopback)")(
+    "receive_modes",
+    bpo::value(&receive_modes)->default_value(receive_modes),
+    "Comma-separated receive modes, callback and/or blocking")(
+    "message_sizes",
+    bpo::value(&message_sizes)->default_value(message_sizes),
+    "Comma-separated payload sizes in bytes")(
+    "iterations", bpo::value(&iterations)->default_value(iterations), "Measured round trips per case")(
+    "warmup_iterations",
+    bpo::value(&warmup_iterations)->default_value(warmup_iterations),
+    "Round trips before measuring")(
+    "queue_type",
+    bpo::value(&queue_type)->default_value(queue_type),
+    "confmodel queue_type of the queue pairs")(
+    "port", bpo::value(&port)->default_value(port), "First tcp port; each case uses the next two")(
+    "reply_timeout_ms",
+    bpo::value(&reply_timeout_ms)->default_value(reply_timeout_ms),
+    "Time after which a ping is counted as timed out and sent again")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")(
+    "help,h", "produce help message");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+  if (!check_list_values("endpoints", endpoints, { "queue", "inproc", "tcp" }) ||
+      !check_list_values("receive_modes", receive_modes, { "callback", "blocking" }) ||
+      !check_list_values("queue_type", queue_type, { "kStdDeQueue", "kFollySPSCQueue", "kFollyMPMCQueue" })) {
+    return 1;
+  }
+
+  nlohmann::json results;
+  results["benchmark"] = "pingpong";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+
+  size_t index = 0;
+  for (auto& endpoint : parse_list<std::string>(endpoints)) {
+    for (auto& receive_mode : parse_list<std::string>(receive_modes)) {
+      for (auto size : parse_list<size_t>(message_sizes)) {
+        Case c{ index,
+                endpoint,
+                receive_mode,
+                size,
+                std::max<size_t>(iterations, 1),
+                warmup_iterations,
+                queue_type,
+                static_cast<uint16_t>(port + 2 * index),
+                std::chrono::milliseconds(reply_timeout_ms) };
+        ++index;
+        auto result = run_case(c);
+        TLOG() << endpoint << " " << receive_mode << " size=" << size << ": p50 "
+               << result["rtt"]["p50_ns"].get<uint64_t>() << " ns, p99 " << result["rtt"]["p99_ns"].get<uint64_t>()
+               << " ns, p99.99 " << result["rtt"]["p99_99_ns"].get<uint64_t>() << " ns";
+        results["results"].push_back(std::move(result));
+      }
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
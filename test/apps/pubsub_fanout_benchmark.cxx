@@ -0,0 +1,492 @@
+/**
+ * @file pubsub_fanout_benchmark.cxx
+ *
+ * Delivered throughput and latency of publish/subscribe connections on one host as the numbers of
+ * publishers, subscribers and topics grow, with optional slow subscribers to show where messages
+ * are dropped. Publishers and subscribers are plain std::threads using the IOManager API.
+ * Results are written as JSON.
+ *
+ * Run "pubsub_fanout_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
+#include "logging/Logging.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+#include "serialization/Serialization.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager::benchmark {
+struct FanoutMessage
+{
+  uint64_t sent_ns{ 0 };
+  uint32_t publisher{ 0 };
+  uint32_t topic{ 0 };
+  uint64_t sequence{ 0 }; // Per publisher and topic
+  bool warmup{ false };
+  std::vector<uint8_t> payload;
+
+  DUNE_DAQ_SERIALIZE(FanoutMessage, sent_ns, publisher, topic, sequence, warmup, payload);
+};
+} // namespace iomanager::benchmark
+DUNE_DAQ_SERIALIZABLE(iomanager::benchmark::FanoutMessage, "FanoutMessage");
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+using dunedaq::iomanager::test::SyntheticConfiguration;
+
+namespace {
+
+constexpr Sender::timeout_t s_send_timeout{ 100 };
+constexpr Receiver::timeout_t s_receive_timeout{ 10 };
+
+struct Case
+{
+  size_t index;
+  std::string protocol;
+  size_t publishers;
+  size_t subscribers;
+  size_t topics;
+  size_t topics_per_subscriber; // 0 for all
+  size_t slow_subscribers;
+  std::chrono::microseconds slow_delay;
+  size_t messages; // Per publisher
+  size_t message_size;
+  uint16_t port;
+  std::chrono::milliseconds connect_timeout;
+  std::chrono::milliseconds idle_timeout;
+};
+
+// Fixed width, so that no topic is a prefix of another (subscriptions match topic prefixes)
+std::string
+get_topic_name(size_t topic)
+{
+  std::ostringstream name;
+  name << "topic_" << std::setw(6) << std::setfill('0') << topic;
+  return name.str();
+}
+
+// Number of message indices in [0, count) which are sent on topic, with messages sent on the topics in turn
+size_t
+get_topic_count(size_t count, size_t topic, size_t topics)
+{
+  return count / topics + (topic < count % topics ? 1 : 0);
+}
+
+/**
+ * One subscriber, with its own Receiver and thread. Sequence numbers are counted per publisher and
+ * topic, so that gaps show dropped messages even when only some topics are subscribed to.
+ */
+class Subscriber
+{
+public:
+  Subscriber(Case const& c, size_t index)
+    : m_index(index)
+    , m_slow(index < c.slow_subscribers)
+    , m_slow_delay(c.slow_delay)
+    , m_topic_count(c.topics)
+    , m_subscribed(c.topics, c.topics_per_subscriber == 0 || c.topics_per_subscriber >= c.topics)
+    , m_warmup_seen(c.publishers, false)
+    , m_next_sequence(c.publishers * c.topics, 0)
+  {
+    if (c.topics_per_subscriber != 0) {
+      for (size_t tt = 0; tt < std::min(c.topics_per_subscriber, c.topics); ++tt) {
+        m_subscribed[(index + tt) % c.topics] = true;
+      }
+    }
+    for (size_t pp = 0; pp < c.publishers; ++pp) {
+      auto count = c.messages / c.publishers + (pp < c.messages % c.publishers ? 1 : 0);
+      for (size_t tt = 0; tt < c.topics; ++tt) {
+        if (m_subscribed[tt]) {
+          m_expected += get_topic_count(count, tt, c.topics);
+        }
+      }
+    }
+  }
+
+  void start(std::shared_ptr<ReceiverConcept<FanoutMessage>> receiver)
+  {
+    for (size_t tt = 0; tt < m_topic_count; ++tt) {
+      if (m_subscribed[tt]) {
+        receiver->subscribe(get_topic_name(tt));
+      }
+    }
+    m_thread = std::thread([this, receiver]() {
+      while (m_running.load(std::memory_order_relaxed)) {
+        auto message = receiver->try_receive(s_receive_timeout);
+        if (message) {
+          handle(*message);
+        }
+      }
+    });
+  }
+
+  void stop()
+  {
+    m_running = false;
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  size_t get_connected_publishers() const { return m_connected_publishers.load(std::memory_order_relaxed); }
+  size_t get_received() const { return m_received.load(std::memory_order_relaxed); }
+  size_t get_expected() const { return m_expected; }
+  LatencyHistogram const& get_latency() const { return m_latency; }
+
+  // Call after stop()
+  nlohmann::json to_json() const
+  {
+    return { { "subscriber", m_index },
+             { "slow", m_slow },
+             { "expected", m_expected },
+             { "received", get_received() },
+             { "lost", m_expected - std::min(m_expected, get_received()) },
+             { "sequence_gaps", m_gaps },
+             { "out_of_order", m_out_of_order },
+             { "latency", m_latency.to_json() } };
+  }
+
+private:
+  void handle(FanoutMessage const& message)
+  {
+    auto received_ns = now_ns();
+    if (message.warmup) {
+      if (message.publisher < m_warmup_seen.size() && !m_warmup_seen[message.publisher]) {
+        m_warmup_seen[message.publisher] = true;
+        m_connected_publishers.fetch_add(1, std::memory_order_relaxed);
+      }
+      return;
+    }
+    m_latency.record(received_ns - message.sent_ns);
+    auto& next = m_next_sequence[message.publisher * m_topic_count + message.topic];
+    if (message.sequence > next) {
+      m_gaps += message.sequence - next;
+    } else if (message.sequence < next) {
+      ++m_out_of_order;
+    }
+    next = std::max(next, message.sequence + 1);
+    m_received.fetch_add(1, std::memory_order_relaxed);
+    if (m_slow) {
+      std::this_thread::sleep_for(m_slow_delay);
+    }
+  }
+
+  size_t m_index;
+  bool m_slow;
+  std::chrono::microseconds m_slow_delay;
+  size_t m_topic_count;
+  std::vector<bool> m_subscribed;
+  size_t m_expected{ 0 };
+
+  std::atomic<bool> m_running{ true };
+  std::thread m_thread;
+
+  // Only touched by the subscriber thread until stop()
+  std::vector<bool> m_warmup_seen;
+  std::vector<uint64_t> m_next_sequence;
+  size_t m_gaps{ 0 };
+  size_t m_out_of_order{ 0 };
+  LatencyHistogram m_latency;
+
+  std::atomic<size_t> m_connected_publishers{ 0 };
+  std::atomic<size_t> m_received{ 0 };
+};
+
+nlohmann::json
+run_case(Case const& c)
+{
+  auto prefix = "fanout_" + std::to_string(c.index) + "_";
+  auto publisher_uid = [&](size_t pp) { return prefix + "publisher_" + std::to_string(pp); };
+
+  SyntheticConfiguration config;
+  for (size_t pp = 0; pp < c.publishers; ++pp) {
+    config.add_network_connection(publisher_uid(pp),
+                                  "FanoutMessage",
+                                  "kPubSub",
+                                  c.protocol,
+                                  publisher_uid(pp),
+                                  c.protocol == "tcp" ? static_cast<uint16_t>(c.port + pp) : 0);
+  }
+  config.load();
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  IOManager::get()->configure("pubsub_fanout_benchmark", config.get_queues(), config.get_connections(), nullptr, opmgr);
+
+  std::vector<std::shared_ptr<SenderConcept<FanoutMessage>>> senders;
+  for (size_t pp = 0; pp < c.publishers; ++pp) {
+    senders.push_back(IOManager::get()->get_sender<FanoutMessage>(ConnectionId{ publisher_uid(pp), "FanoutMessage" }));
+  }
+
+  // IOManager keeps one Receiver per ConnectionId, so each subscriber matches all publishers with its own pattern
+  std::vector<std::unique_ptr<Subscriber>> subscribers;
+  for (size_t ss = 0; ss < c.subscribers; ++ss) {
+    ConnectionId id{ "(" + prefix + "publisher_.*)|(" + prefix + "subscriber_" + std::to_string(ss) + ")",
+                     "FanoutMessage" };
+    subscribers.push_back(std::make_unique<Subscriber>(c, ss));
+    subscribers.back()->start(IOManager::get()->get_receiver<FanoutMessage>(id));
+  }
+
+  std::atomic<size_t> send_failures{ 0 };
+  auto publish = [&](size_t pp, size_t topic, uint64_t sequence, bool warmup) {
+    FanoutMessage message;
+    message.publisher = static_cast<uint32_t>(pp);
+    message.topic = static_cast<uint32_t>(topic);
+    message.sequence = sequence;
+    message.warmup = warmup;
+    message.payload.resize(c.message_size);
+    message.sent_ns = now_ns();
+    try {
+      senders[pp]->send_with_topic(std::move(message), s_send_timeout, get_topic_name(topic));
+    } catch (ers::Issue const&) {
+      send_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  // Subscriptions are established asynchronously: publish on every topic until every subscriber hears every publisher
+  auto all_connected = [&]() {
+    return std::all_of(subscribers.begin(), subscribers.end(), [&](auto& subscriber) {
+      return subscriber->get_connected_publishers() == c.publishers;
+    });
+  };
+  auto connect_start = std::chrono::steady_clock::now();
+  while (!all_connected() && std::chrono::steady_clock::now() - connect_start < c.connect_timeout) {
+    for (size_t pp = 0; pp < c.publishers; ++pp) {
+      for (size_t tt = 0; tt < c.topics; ++tt) {
+        publish(pp, tt, 0, true);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  auto connected = all_connected();
+  auto connect_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connect_start).count();
+  send_failures = 0;
+
+  double seconds = 0;
+  double cpu_seconds = 0;
+  if (connected) {
+    std::atomic<size_t> ready{ 0 };
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> publishers;
+    for (size_t pp = 0; pp < c.publishers; ++pp) {
+      auto count = c.messages / c.publishers + (pp < c.messages % c.publishers ? 1 : 0);
+      publishers.emplace_back([&, pp, count]() {
+        std::vector<uint64_t> sequences(c.topics, 0);
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+        }
+        for (size_t ii = 0; ii < count; ++ii) {
+          auto topic = ii % c.topics;
+          publish(pp, topic, sequences[topic]++, false);
+        }
+      });
+    }
+    while (ready.load() < publishers.size()) {
+      std::this_thread::yield();
+    }
+    auto cpu_start = get_process_cpu_seconds();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& thread : publishers) {
+      thread.join();
+    }
+
+    // Wait for every subscriber to get all its messages, or for deliveries to stop
+    auto total_received = [&]() {
+      size_t total = 0;
+      for (auto& subscriber : subscribers) {
+        total += subscriber->get_received();
+      }
+      return total;
+    };
+    size_t total_expected = 0;
+    for (auto& subscriber : subscribers) {
+      total_expected += subscriber->get_expected();
+    }
+    auto last_total = total_received();
+    auto last_change = std::chrono::steady_clock::now();
+    auto last_delivery = last_change;
+    while (last_total < total_expected && std::chrono::steady_clock::now() - last_change < c.idle_timeout) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      auto current = total_received();
+      if (current != last_total) {
+        last_total = current;
+        last_change = last_delivery = std::chrono::steady_clock::now();
+      }
+    }
+    seconds = std::chrono::duration<double>(std::max(last_delivery, start) - start).count();
+    cpu_seconds = get_process_cpu_seconds() - cpu_start;
+  }
+
+  for (auto& subscriber : subscribers) {
+    subscriber->stop();
+  }
+  senders.clear();
+  IOManager::get()->reset();
+
+  LatencyHistogram latency;
+  size_t delivered = 0;
+  size_t expected = 0;
+  size_t gaps = 0;
+  size_t lost_by_slow = 0;
+  auto per_subscriber = nlohmann::json::array();
+  for (auto& subscriber : subscribers) {
+    auto subscriber_result = subscriber->to_json();
+    latency.merge(subscriber->get_latency());
+    delivered += subscriber->get_received();
+    expected += subscriber->get_expected();
+    gaps += subscriber_result["sequence_gaps"].get<size_t>();
+    if (subscriber_result["slow"].get<bool>()) {
+      lost_by_slow += subscriber_result["lost"].get<size_t>();
+    }
+    per_subscriber.push_back(std::move(subscriber_result));
+  }
+  auto rate = seconds > 0 ? static_cast<double>(delivered) / seconds : 0.;
+  return { { "protocol", c.protocol },
+           { "publishers", c.publishers },
+           { "subscribers", c.subscribers },
+           { "topics", c.topics },
+           { "topics_per_subscriber", c.topics_per_subscriber == 0 ? c.topics : c.topics_per_subscriber },
+           { "slow_subscribers", std::min(c.slow_subscribers, c.subscribers) },
+           { "slow_delay_us", c.slow_delay.count() },
+           { "message_bytes", c.message_size },
+           { "messages", c.messages },
+           { "connected", connected },
+           { "connect_seconds", connect_seconds },
+           { "send_failures", send_failures.load() },
+           { "expected_deliveries", expected },
+           { "delivered", delivered },
+           { "lost", expected - std::min(expected, delivered) },
+           { "lost_by_slow_subscribers", lost_by_slow },
+           { "sequence_gaps", gaps },
+           { "seconds", seconds },
+           { "deliveries_per_second", rate },
+           { "delivered_megabytes_per_second", rate * static_cast<double>(c.message_size) / 1e6 },
+           { "cpu_ns_per_delivery", delivered > 0 ? cpu_seconds * 1e9 / static_cast<double>(delivered) : 0. },
+           { "latency", latency.to_json() },
+           { "per_subscriber", per_subscriber } };
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string protocols = "inproc,tcp";
+  std::string publishers = "1,4";
+  std::string subscribers = "1,4,16";
+  std::string topics = "1,16";
+  std::string output = "pubsub_fanout_benchmark.json";
+  size_t topics_per_subscriber = 0;
+  size_t slow_subscribers = 0;
+  size_t slow_delay_us = 100;
+  size_t messages = 100000;
+  size_t message_size = 1024;
+  uint16_t port = 16000;
+  size_t connect_timeout_ms = 5000;
+  size_t idle_timeout_ms = 2000;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()(
+    "protocols", bpo::value(&protocols)->default_value(protocols), "Comma-separated transports, inproc and/or tcp")(
+    "publishers", bpo::value(&publishers)->default_value(publishers), "Comma-separated numbers of publishers")(
+    "subscribers", bpo::value(&subscribers)->default_value(subscribers), "Comma-separated numbers of subscribers")(
+    "topics", bpo::value(&topics)->default_value(topics), "Comma-separated numbers of topics")(
+    "topics_per_subscriber",
+    bpo::value(&topics_per_subscriber)->default_value(topics_per_subscriber),
+    "Topics each subscriber subscribes to, 0 for all")(
+    "slow_subscribers",
+    bpo::value(&slow_subscribers)->default_value(slow_subscribers),
+    "Number of subscribers which sleep after each message")(
+    "slow_delay_us",
+    bpo::value(&slow_delay_us)->default_value(slow_delay_us),
+    "Time slow subscribers sleep after each message")(
+    "messages", bpo::value(&messages)->default_value(messages), "Messages published per case, over all publishers")(
+    "message_size", bpo::value(&message_size)->default_value(message_size), "Payload size in bytes")(
+    "port", bpo::value(&port)->default_value(port), "First tcp port; each publisher of a case uses the next one")(
+    "connect_timeout_ms",
+    bpo::value(&connect_timeout_ms)->default_value(connect_timeout_ms),
+    "Time allowed for all subscriptions to be established")(
+    "idle_timeout_ms",
+    bpo::value(&idle_timeout_ms)->default_value(idle_timeout_ms),
+    "Time without deliveries after which the remaining messages are counted as lost")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")(
+    "help,h", "produce help message");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+  if (!check_list_values("protocols", protocols, { "inproc", "tcp" })) {
+    return 1;
+  }
+
+  nlohmann::json results;
+  results["benchmark"] = "pubsub_fanout";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+
+  size_t index = 0;
+  uint16_t next_port = port;
+  for (auto& protocol : parse_list<std::string>(protocols)) {
+    for (auto publisher_count : parse_list<size_t>(publishers)) {
+      for (auto subscriber_count : parse_list<size_t>(subscribers)) {
+        for (auto topic_count : parse_list<size_t>(topics)) {
+          Case c{ index++,
+                  protocol,
+                  std::max<size_t>(publisher_count, 1),
+                  std::max<size_t>(subscriber_count, 1),
+                  std::max<size_t>(topic_count, 1),
+                  topics_per_subscriber,
+                  slow_subscribers,
+                  std::chrono::microseconds(slow_delay_us),
+                  std::max<size_t>(messages, 1),
+                  message_size,
+                  next_port,
+                  std::chrono::milliseconds(connect_timeout_ms),
+                  std::chrono::milliseconds(idle_timeout_ms) };
+          next_port = static_cast<uint16_t>(next_port + c.publishers);
+          auto result = run_case(c);
+          TLOG() << protocol << " publishers=" << c.publishers << " subscribers=" << c.subscribers
+                 << " topics=" << c.topics << ": " << result["deliveries_per_second"].get<double>()
+                 << " deliveries/s, p99 " << result["latency"]["p99_ns"].get<uint64_t>() << " ns, lost "
+                 << result["lost"].get<size_t>();
+          results["results"].push_back(std::move(result));
+        }
+      }
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
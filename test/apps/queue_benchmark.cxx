@@ -0,0 +1,321 @@
+/**
+ * @file queue_benchmark.cxx
+ *
+ * Throughput and push-to-pop latency of every Queue implementation QueueRegistry can create,
+ * swept over producer/consumer thread counts, element sizes and capacities. Results are
+ * written as JSON.
+ *
+ * Run "queue_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/queue/FollyQueue.hpp"
+#include "iomanager/queue/StdDeQueue.hpp"
+
+#include "logging/Logging.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+
+namespace {
+
+// The queue types of confmodel::Queue, see QueueRegistry::create_queue
+const std::vector<std::string> s_queue_types = { "StdDeQueue", "FollySPSCQueue", "FollyMPMCQueue" };
+
+// Element sizes are compile-time, so that elements are stored in the queues themselves like typical DAQ structs
+constexpr std::array<size_t, 5> s_payload_sizes = { 8, 64, 512, 4096, 32768 };
+
+constexpr std::chrono::milliseconds s_timeout{ 10 };
+
+template<size_t PayloadSize>
+struct Element
+{
+  uint64_t pushed_ns{ 0 };
+  std::array<uint8_t, PayloadSize> payload{};
+};
+
+struct Case
+{
+  std::string queue_type;
+  size_t producers;
+  size_t consumers;
+  size_t payload_size;
+  size_t capacity;
+  size_t messages;
+  size_t warmup_messages;
+  std::vector<int> cpus; // Empty if threads are not pinned
+};
+
+template<typename T>
+std::unique_ptr<Queue<T>>
+make_queue(std::string const& type, size_t capacity)
+{
+  if (type == "StdDeQueue") {
+    return std::make_unique<StdDeQueue<T>>("benchmark", capacity);
+  }
+  if (type == "FollySPSCQueue") {
+    return std::make_unique<FollySPSCQueue<T>>("benchmark", capacity);
+  }
+  return std::make_unique<FollyMPMCQueue<T>>("benchmark", capacity);
+}
+
+struct PassResult
+{
+  double seconds{ 0 };
+  double cpu_seconds{ 0 };
+  uint64_t push_timeouts{ 0 };
+  LatencyHistogram latency;
+};
+
+/**
+ * Push messages through the queue with the configured threads. Each thread spins until all
+ * are ready, and the clock starts when they are released.
+ */
+template<size_t PayloadSize>
+PassResult
+run_pass(Queue<Element<PayloadSize>>& queue, Case const& c, size_t messages)
+{
+  std::atomic<size_t> ready{ 0 };
+  std::atomic<bool> go{ false };
+  std::atomic<size_t> popped{ 0 };
+  std::atomic<uint64_t> push_timeouts{ 0 };
+  std::vector<LatencyHistogram> latencies(c.consumers);
+  std::vector<std::thread> threads;
+
+  auto wait_for_start = [&](size_t index) {
+    if (!c.cpus.empty()) {
+      pin_current_thread(c.cpus[index % c.cpus.size()]);
+    }
+    ready.fetch_add(1);
+    while (!go.load(std::memory_order_acquire)) {
+    }
+  };
+
+  for (size_t pp = 0; pp < c.producers; ++pp) {
+    auto count = messages / c.producers + (pp < messages % c.producers ? 1 : 0);
+    threads.emplace_back([&, pp, count]() {
+      wait_for_start(pp);
+      for (size_t ii = 0; ii < count; ++ii) {
+        Element<PayloadSize> element;
+        element.pushed_ns = now_ns();
+        while (true) {
+          try {
+            queue.push(std::move(element), s_timeout);
+            break;
+          } catch (QueueTimeoutExpired const&) {
+            push_timeouts.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+    });
+  }
+  for (size_t cc = 0; cc < c.consumers; ++cc) {
+    threads.emplace_back([&, cc]() {
+      wait_for_start(c.producers + cc);
+      Element<PayloadSize> element;
+      while (popped.load(std::memory_order_relaxed) < messages) {
+        if (queue.try_pop(element, s_timeout)) {
+          latencies[cc].record(now_ns() - element.pushed_ns);
+          popped.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+
+  while (ready.load() < threads.size()) {
+    std::this_thread::yield();
+  }
+  PassResult result;
+  auto cpu_start = get_process_cpu_seconds();
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.cpu_seconds = get_process_cpu_seconds() - cpu_start;
+  result.push_timeouts = push_timeouts.load();
+  for (auto& latency : latencies) {
+    result.latency.merge(latency);
+  }
+  return result;
+}
+
+template<size_t PayloadSize>
+nlohmann::json
+run_case(Case const& c)
+{
+  auto queue = make_queue<Element<PayloadSize>>(c.queue_type, c.capacity);
+  if (c.warmup_messages > 0) {
+    run_pass<PayloadSize>(*queue, c, c.warmup_messages);
+  }
+  auto result = run_pass<PayloadSize>(*queue, c, c.messages);
+
+  auto element_bytes = sizeof(Element<PayloadSize>);
+  return { { "queue_type", c.queue_type },
+           { "producers", c.producers },
+           { "consumers", c.consumers },
+           { "payload_bytes", c.payload_size },
+           { "element_bytes", element_bytes },
+           { "capacity", c.capacity },
+           { "messages", c.messages },
+           { "pinned", !c.cpus.empty() },
+           { "seconds", result.seconds },
+           { "messages_per_second", static_cast<double>(c.messages) / result.seconds },
+           { "megabytes_per_second", static_cast<double>(c.messages * element_bytes) / result.seconds / 1e6 },
+           { "cpu_ns_per_message", result.cpu_seconds * 1e9 / static_cast<double>(c.messages) },
+           { "push_timeouts", result.push_timeouts },
+           { "latency", result.latency.to_json() } };
+}
+
+template<size_t Index = 0>
+nlohmann::json
+dispatch_case(Case const& c)
+{
+  if constexpr (Index < s_payload_sizes.size()) {
+    if (c.payload_size == s_payload_sizes[Index]) {
+      return run_case<s_payload_sizes[Index]>(c);
+    }
+    return dispatch_case<Index + 1>(c);
+  } else {
+    return nullptr;
+  }
+}
+
+std::string
+join(std::vector<size_t> const& values)
+{
+  std::string text;
+  for (auto value : values) {
+    text += (text.empty() ? "" : ",") + std::to_string(value);
+  }
+  return text;
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string queue_types = "StdDeQueue,FollySPSCQueue,FollyMPMCQueue";
+  std::string producers = "1,2,4";
+  std::string consumers = "1,2,4";
+  std::string payload_sizes = "8,512,4096";
+  std::string capacities = "64,1024,16384";
+  std::string cpus;
+  std::string output = "queue_benchmark.json";
+  size_t messages = 1000000;
+  size_t warmup_messages = 10000;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()("queue_types", bpo::value(&queue_types)->default_value(queue_types), "Queue types to measure")(
+    "producers", bpo::value(&producers)->default_value(producers), "Comma-separated producer thread counts")(
+    "consumers", bpo::value(&consumers)->default_value(consumers), "Comma-separated consumer thread counts")(
+    "payload_sizes",
+    bpo::value(&payload_sizes)->default_value(payload_sizes),
+    ("Comma-separated payload sizes in bytes, each one of " + join({ s_payload_sizes.begin(), s_payload_sizes.end() }))
+      .c_str())("capacities", bpo::value(&capacities)->default_value(capacities), "Comma-separated queue capacities")(
+    "messages", bpo::value(&messages)->default_value(messages), "Messages per measurement")(
+    "warmup_messages",
+    bpo::value(&warmup_messages)->default_value(warmup_messages),
+    "Messages sent through each queue before measuring")(
+    "cpus",
+    bpo::value(&cpus),
+    "Comma-separated CPUs to pin producers, then consumers, to in turn (default: no pinning)")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")("help,h",
+                                                                                               "produce help message");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, desc), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+
+  Case base;
+  base.messages = messages;
+  base.warmup_messages = warmup_messages;
+  base.cpus = parse_list<int>(cpus);
+
+  nlohmann::json results;
+  results["benchmark"] = "queue";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+  results["skipped"] = nlohmann::json::array();
+
+  std::vector<std::string> types;
+  for (auto& type : parse_list<std::string>(queue_types)) {
+    if (std::find(s_queue_types.begin(), s_queue_types.end(), type) == s_queue_types.end()) {
+      std::cerr << "Unknown queue type " << type << "\n";
+      return 1;
+    }
+    types.push_back(type);
+  }
+  for (auto size : parse_list<size_t>(payload_sizes)) {
+    if (std::find(s_payload_sizes.begin(), s_payload_sizes.end(), size) == s_payload_sizes.end()) {
+      std::cerr << "Unsupported payload size " << size << ", supported sizes are "
+                << join({ s_payload_sizes.begin(), s_payload_sizes.end() }) << "\n";
+      return 1;
+    }
+  }
+
+  for (auto& type : types) {
+    for (auto producer_count : parse_list<size_t>(producers)) {
+      for (auto consumer_count : parse_list<size_t>(consumers)) {
+        if (producer_count == 0 || consumer_count == 0) {
+          continue;
+        }
+        // An SPSC queue is only correct with one thread on each side
+        if (type == "FollySPSCQueue" && (producer_count > 1 || consumer_count > 1)) {
+          results["skipped"].push_back(
+            { { "queue_type", type }, { "producers", producer_count }, { "consumers", consumer_count } });
+          continue;
+        }
+        for (auto size : parse_list<size_t>(payload_sizes)) {
+          for (auto capacity : parse_list<size_t>(capacities)) {
+            auto c = base;
+            c.queue_type = type;
+            c.producers = producer_count;
+            c.consumers = consumer_count;
+            c.payload_size = size;
+            c.capacity = capacity;
+            auto result = dispatch_case(c);
+            TLOG() << type << " producers=" << producer_count << " consumers=" << consumer_count
+                   << " payload=" << size << " capacity=" << capacity << ": "
+                   << result["messages_per_second"].get<double>() << " msg/s, p99 "
+                   << result["latency"]["p99_ns"].get<uint64_t>() << " ns";
+            results["results"].push_back(std::move(result));
+          }
+        }
+      }
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
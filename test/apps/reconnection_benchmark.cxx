@@ -0,0 +1,744 @@
+/**
+ * @file reconnection_benchmark.cxx
+ *
+ * Recovery of tcp send/recv and pub/sub connections when the receiving application is killed and
+ * restarted, with connections either preconfigured or looked up through a stand-in Connectivity
+ * Service. The receiver runs in a child process; each cycle kills it with SIGKILL, restarts it,
+ * and measures the time until messages flow again, the messages lost or delayed around the restart,
+ * and how long the sending thread stalls in send calls. Results are written as JSON.
+ *
+ * Run "reconnection_benchmark --help" to see options
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "BenchmarkConnectivityService.hpp"
+#include "BenchmarkUtilities.hpp"
+
+#include "iomanager/IOManager.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
+#include "logging/Logging.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+#include "serialization/Serialization.hpp"
+
+#include "boost/program_options.hpp"
+namespace bpo = boost::program_options;
+
+#include <fcntl.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager::benchmark {
+struct ReconnectMessage
+{
+  uint64_t sent_ns{ 0 };
+  uint64_t sequence{ 0 };
+  std::vector<uint8_t> payload;
+
+  DUNE_DAQ_SERIALIZE(ReconnectMessage, sent_ns, sequence, payload);
+};
+} // namespace iomanager::benchmark
+DUNE_DAQ_SERIALIZABLE(iomanager::benchmark::ReconnectMessage, "ReconnectMessage");
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq::iomanager::benchmark;
+using dunedaq::iomanager::test::SyntheticConfiguration;
+
+namespace {
+
+constexpr auto s_session = "reconnection_benchmark";
+constexpr auto s_data_type = "ReconnectMessage";
+constexpr auto s_poll = std::chrono::milliseconds(1);
+
+/**
+ * Written by the receiver process to its pipe for every message, and once with sequence
+ * s_ready_sequence when its callback is installed. steady_clock is CLOCK_MONOTONIC, so times
+ * taken in the two processes can be compared.
+ */
+struct DeliveryRecord
+{
+  uint64_t sequence;
+  uint64_t sent_ns;
+  uint64_t received_ns;
+};
+constexpr uint64_t s_ready_sequence = std::numeric_limits<uint64_t>::max();
+
+struct SendRecord
+{
+  uint64_t sequence;
+  uint64_t start_ns;
+  uint64_t duration_ns;
+  bool success;
+};
+
+struct Case
+{
+  size_t index;
+  std::string pattern; // sendrecv or pubsub
+  std::string lookup;  // preconfigured or connectivity_service
+  uint16_t port;
+  size_t cycles;
+  double rate_hz;
+  size_t message_size;
+  uint32_t publish_interval_ms;
+  Sender::timeout_t send_timeout;
+  std::chrono::milliseconds steady_time;
+  std::chrono::milliseconds down_time;
+  std::chrono::milliseconds recovery_timeout;
+  std::chrono::milliseconds connect_timeout;
+  std::chrono::milliseconds drain_time;
+  uint64_t delay_threshold_ns;
+  uint64_t stall_threshold_ns;
+};
+
+bool
+write_record(int fd, DeliveryRecord const& record)
+{
+  // Pipe writes of up to PIPE_BUF bytes are atomic
+  while (true) {
+    auto written = write(fd, &record, sizeof(record));
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    return written == static_cast<ssize_t>(sizeof(record));
+  }
+}
+
+bool
+read_record(int fd, DeliveryRecord& record)
+{
+  auto* data = reinterpret_cast<char*>(&record);
+  size_t done = 0;
+  while (done < sizeof(record)) {
+    auto count = read(fd, data + done, sizeof(record) - done);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    done += static_cast<size_t>(count);
+  }
+  return true;
+}
+
+template<typename Predicate>
+bool
+wait_until(Predicate predicate, std::chrono::milliseconds timeout)
+{
+  auto start = std::chrono::steady_clock::now();
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() - start >= timeout) {
+      return false;
+    }
+    std::this_thread::sleep_for(s_poll);
+  }
+  return true;
+}
+
+ReconnectMessage
+make_message(uint64_t sequence, size_t size)
+{
+  ReconnectMessage message;
+  message.sequence = sequence;
+  message.payload.resize(size);
+  message.sent_ns = now_ns();
+  return message;
+}
+
+void
+add_connection(SyntheticConfiguration& config, std::string const& uid, std::string const& pattern, uint16_t port)
+{
+  config.add_network_connection(uid, s_data_type, pattern == "pubsub" ? "kPubSub" : "kSendRecv", "tcp", uid, port);
+}
+
+/**
+ * Receiving side, run in the child process: reports every message to the parent through the pipe
+ * and then waits to be killed. The parent's death kills it too.
+ */
+int
+run_receiver(std::string const& uid,
+             std::string const& pattern,
+             uint16_t port,
+             uint16_t service_port,
+             uint32_t publish_interval_ms,
+             int fd)
+{
+  SyntheticConfiguration config;
+  add_connection(config, uid, pattern, port);
+  if (service_port != 0) {
+    config.set_connectivity_service("127.0.0.1", service_port, publish_interval_ms);
+  }
+  config.load();
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  IOManager::get()->configure(
+    s_session, config.get_queues(), config.get_connections(), config.get_connectivity_service(), opmgr);
+
+  auto receiver = IOManager::get()->get_receiver<ReconnectMessage>(ConnectionId{ uid, s_data_type });
+  receiver->add_callback([fd](ReconnectMessage& message) {
+    if (!write_record(fd, { message.sequence, message.sent_ns, now_ns() })) {
+      _exit(0);
+    }
+  });
+  write_record(fd, { s_ready_sequence, 0, now_ns() });
+
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+}
+
+/**
+ * A receiver process, started by re-executing this program, and the thread reading its pipe.
+ * Destroying it kills the process.
+ */
+class ReceiverProcess
+{
+public:
+  using Handler = std::function<void(DeliveryRecord const&)>;
+
+  ReceiverProcess(std::vector<std::string> arguments, Handler handler)
+  {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+      throw std::runtime_error("Cannot create pipe for receiver process");
+    }
+    arguments.push_back("--receiver_fd");
+    arguments.push_back(std::to_string(fds[1]));
+    std::vector<char*> argv;
+    for (auto& argument : arguments) {
+      argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    m_pid = fork();
+    if (m_pid == 0) {
+      // Only async-signal-safe calls until exec, since the parent has other threads
+      fcntl(fds[1], F_SETFD, 0);
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      execv("/proc/self/exe", argv.data());
+      _exit(127);
+    }
+    close(fds[1]);
+    if (m_pid < 0) {
+      close(fds[0]);
+      throw std::runtime_error("Cannot fork receiver process");
+    }
+    m_fd = fds[0];
+    m_reader = std::thread([this, handler]() {
+      DeliveryRecord record;
+      while (read_record(m_fd, record)) {
+        handler(record);
+      }
+    });
+  }
+
+  ~ReceiverProcess()
+  {
+    kill(m_pid, SIGKILL);
+    waitpid(m_pid, nullptr, 0);
+    // The pipe reaches end-of-file once the process is gone
+    m_reader.join();
+    close(m_fd);
+  }
+
+  ReceiverProcess(ReceiverProcess const&) = delete;
+  ReceiverProcess& operator=(ReceiverProcess const&) = delete;
+
+private:
+  pid_t m_pid{ -1 };
+  int m_fd{ -1 };
+  std::thread m_reader;
+};
+
+/**
+ * Deliveries reported by all generations of the receiver process in a case
+ */
+class DeliveryLog
+{
+public:
+  struct Delivery
+  {
+    DeliveryRecord record;
+    size_t generation;
+  };
+
+  void add(size_t generation, DeliveryRecord const& record)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& times = m_generations[generation];
+    if (record.sequence == s_ready_sequence) {
+      times.ready_ns = record.received_ns;
+      return;
+    }
+    if (times.first_delivery_ns == 0) {
+      times.first_delivery_ns = record.received_ns;
+    }
+    m_deliveries.push_back({ record, generation });
+  }
+
+  uint64_t get_ready_ns(size_t generation) const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_generations.find(generation);
+    return it == m_generations.end() ? 0 : it->second.ready_ns;
+  }
+
+  uint64_t get_first_delivery_ns(size_t generation) const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto it = m_generations.find(generation);
+    return it == m_generations.end() ? 0 : it->second.first_delivery_ns;
+  }
+
+  std::vector<Delivery> get_deliveries() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_deliveries;
+  }
+
+private:
+  struct GenerationTimes
+  {
+    uint64_t ready_ns{ 0 };
+    uint64_t first_delivery_ns{ 0 };
+  };
+
+  mutable std::mutex m_mutex;
+  std::map<size_t, GenerationTimes> m_generations;
+  std::vector<Delivery> m_deliveries;
+};
+
+struct Cycle
+{
+  size_t generation;
+  uint64_t start_ns;
+  uint64_t kill_ns;
+  uint64_t restart_ns;
+};
+
+// Milliseconds from start to end, or null if end never happened
+nlohmann::json
+milliseconds_between(uint64_t start_ns, uint64_t end_ns)
+{
+  if (end_ns == 0) {
+    return nullptr;
+  }
+  return static_cast<double>(static_cast<int64_t>(end_ns - start_ns)) * 1e-6;
+}
+
+/**
+ * Per-cycle results. A cycle's window runs from the start of its steady period to the start of the
+ * next cycle, so it covers the kill, the outage, the restart and the recovery; messages are
+ * attributed to the window in which they were sent.
+ */
+nlohmann::json
+analyse_cycles(Case const& c,
+               std::vector<Cycle> const& cycles,
+               uint64_t stop_ns,
+               std::vector<SendRecord> const& sends,
+               DeliveryLog const& log,
+               uint64_t first_sequence,
+               nlohmann::json& summary)
+{
+  struct Delivered
+  {
+    size_t count{ 0 };
+    uint64_t latency_ns{ 0 };
+    size_t generation{ 0 };
+  };
+  std::unordered_map<uint64_t, Delivered> delivered;
+  LatencyHistogram latency;
+  for (auto& delivery : log.get_deliveries()) {
+    if (delivery.record.sequence < first_sequence) {
+      continue;
+    }
+    auto& entry = delivered[delivery.record.sequence];
+    if (entry.count++ == 0) {
+      entry.latency_ns = delivery.record.received_ns - delivery.record.sent_ns;
+      entry.generation = delivery.generation;
+      latency.record(entry.latency_ns);
+    }
+  }
+
+  LatencyHistogram send_duration;
+  LatencyHistogram recovery;
+  size_t recovered = 0;
+  size_t total_sent = 0;
+  size_t total_lost = 0;
+  size_t total_delayed = 0;
+  uint64_t total_stall_ns = 0;
+  auto results = nlohmann::json::array();
+  auto send = sends.begin();
+  for (size_t ii = 0; ii < cycles.size(); ++ii) {
+    auto& cycle = cycles[ii];
+    auto end_ns = ii + 1 < cycles.size() ? cycles[ii + 1].start_ns : stop_ns;
+    size_t sent = 0, failed = 0, received = 0, duplicates = 0, lost = 0, delayed = 0, stalled = 0;
+    uint64_t blocked_ns = 0, stall_ns = 0, max_send_ns = 0;
+    uint64_t first_ok_send_ns = 0, first_delivered_send_ns = 0;
+    for (; send != sends.end() && send->start_ns < end_ns; ++send) {
+      ++sent;
+      send_duration.record(send->duration_ns);
+      blocked_ns += send->duration_ns;
+      max_send_ns = std::max(max_send_ns, send->duration_ns);
+      if (send->duration_ns > c.stall_threshold_ns) {
+        ++stalled;
+        stall_ns += send->duration_ns;
+      }
+      if (!send->success) {
+        ++failed;
+      } else if (first_ok_send_ns == 0 && send->start_ns >= cycle.restart_ns) {
+        first_ok_send_ns = send->start_ns;
+      }
+      auto entry = delivered.find(send->sequence);
+      if (entry == delivered.end()) {
+        lost += send->success ? 1 : 0;
+        continue;
+      }
+      ++received;
+      duplicates += entry->second.count - 1;
+      delayed += entry->second.latency_ns > c.delay_threshold_ns ? 1 : 0;
+      if (first_delivered_send_ns == 0 && send->start_ns >= cycle.restart_ns &&
+          entry->second.generation == cycle.generation) {
+        first_delivered_send_ns = send->start_ns;
+      }
+    }
+
+    auto ready_ns = log.get_ready_ns(cycle.generation);
+    auto first_delivery_ns = log.get_first_delivery_ns(cycle.generation);
+    if (first_delivery_ns != 0) {
+      ++recovered;
+      recovery.record(first_delivery_ns - cycle.restart_ns);
+    }
+    total_sent += sent;
+    total_lost += lost;
+    total_delayed += delayed;
+    total_stall_ns += stall_ns;
+    results.push_back({ { "cycle", ii },
+                        { "recovered", first_delivery_ns != 0 },
+                        { "receiver_ready_ms", milliseconds_between(cycle.restart_ns, ready_ns) },
+                        { "first_delivery_ms", milliseconds_between(cycle.restart_ns, first_delivery_ns) },
+                        { "first_successful_send_ms", milliseconds_between(cycle.restart_ns, first_ok_send_ns) },
+                        { "first_delivered_send_ms", milliseconds_between(cycle.restart_ns, first_delivered_send_ns) },
+                        { "down_ms", milliseconds_between(cycle.kill_ns, cycle.restart_ns) },
+                        { "sent", sent },
+                        { "send_failures", failed },
+                        { "received", received },
+                        { "lost", lost },
+                        { "duplicates", duplicates },
+                        { "delayed", delayed },
+                        { "stalled_sends", stalled },
+                        { "stall_ms", static_cast<double>(stall_ns) * 1e-6 },
+                        { "blocked_in_send_ms", static_cast<double>(blocked_ns) * 1e-6 },
+                        { "max_send_ms", static_cast<double>(max_send_ns) * 1e-6 } });
+  }
+
+  summary = { { "cycles", cycles.size() },
+              { "recovered", recovered },
+              { "sent", total_sent },
+              { "lost", total_lost },
+              { "delayed", total_delayed },
+              { "stall_ms", static_cast<double>(total_stall_ns) * 1e-6 },
+              { "recovery", recovery.to_json() },
+              { "send_duration", send_duration.to_json() },
+              { "latency", latency.to_json() } };
+  return results;
+}
+
+nlohmann::json
+run_case(Case const& c, StandInConnectivityService* service, std::string const& program)
+{
+  nlohmann::json result{ { "pattern", c.pattern },
+                         { "lookup", c.lookup },
+                         { "rate_hz", c.rate_hz },
+                         { "message_bytes", c.message_size },
+                         { "steady_ms", c.steady_time.count() },
+                         { "down_ms", c.down_time.count() } };
+
+  // With the Connectivity Service, the binding end takes any port and publishes the one it got
+  auto uid = "reconnection_benchmark_" + std::to_string(c.index);
+  uint16_t port = service == nullptr ? c.port : 0;
+  SyntheticConfiguration config;
+  add_connection(config, uid, c.pattern, port);
+  if (service != nullptr) {
+    service->clear();
+    config.set_connectivity_service("127.0.0.1", service->get_port(), c.publish_interval_ms);
+  }
+  config.load();
+
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+  IOManager::get()->configure(
+    s_session, config.get_queues(), config.get_connections(), config.get_connectivity_service(), opmgr);
+
+  std::vector<std::string> arguments{ program,
+                                      "--receiver_uid",
+                                      uid,
+                                      "--receiver_pattern",
+                                      c.pattern,
+                                      "--receiver_port",
+                                      std::to_string(port),
+                                      "--service_port",
+                                      std::to_string(service == nullptr ? 0 : service->get_port()),
+                                      "--publish_interval_ms",
+                                      std::to_string(c.publish_interval_ms) };
+  DeliveryLog log;
+  size_t generation = 0;
+  auto start_receiver = [&]() {
+    auto this_generation = generation++;
+    return std::make_unique<ReceiverProcess>(
+      arguments, [&log, this_generation](DeliveryRecord const& record) { log.add(this_generation, record); });
+  };
+
+  // Publishers bind, so they must exist before subscribers look them up; send/recv receivers bind
+  ConnectionId id{ uid, s_data_type };
+  std::shared_ptr<SenderConcept<ReconnectMessage>> sender;
+  if (c.pattern == "pubsub") {
+    sender = IOManager::get()->get_sender<ReconnectMessage>(id);
+  }
+  auto receiver = start_receiver();
+  auto connected = wait_until([&]() { return log.get_ready_ns(0) != 0; }, c.connect_timeout);
+  if (connected && c.pattern == "sendrecv" && service != nullptr) {
+    connected = wait_until([&]() { return service->get_registration_count() > 0; }, c.connect_timeout);
+  }
+  if (connected && sender == nullptr) {
+    sender = IOManager::get()->get_sender<ReconnectMessage>(id);
+  }
+
+  // Subscriptions and tcp connections are established asynchronously, so send until a message gets through
+  uint64_t sequence = 0;
+  if (connected) {
+    auto start = std::chrono::steady_clock::now();
+    while (log.get_first_delivery_ns(0) == 0 && std::chrono::steady_clock::now() - start < c.connect_timeout) {
+      sender->try_send(make_message(sequence++, c.message_size), c.send_timeout);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    connected = log.get_first_delivery_ns(0) != 0;
+  }
+  result["connected"] = connected;
+
+  if (connected) {
+    auto first_sequence = sequence;
+    std::vector<SendRecord> sends;
+    std::atomic<bool> sending{ true };
+    std::thread send_thread([&]() {
+      auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1. / c.rate_hz));
+      auto next = std::chrono::steady_clock::now();
+      auto send_sequence = first_sequence;
+      while (sending.load(std::memory_order_relaxed)) {
+        auto message = make_message(send_sequence, c.message_size);
+        SendRecord record{ send_sequence++, message.sent_ns, 0, false };
+        record.success = sender->try_send(std::move(message), c.send_timeout);
+        record.duration_ns = now_ns() - record.start_ns;
+        sends.push_back(record);
+        // Keep the rate, but do not send a burst to catch up after a stall
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+          next = now;
+        } else {
+          std::this_thread::sleep_until(next);
+        }
+      }
+    });
+
+    std::vector<Cycle> cycles;
+    for (size_t ii = 0; ii < c.cycles; ++ii) {
+      Cycle cycle;
+      cycle.start_ns = now_ns();
+      std::this_thread::sleep_for(c.steady_time);
+      cycle.kill_ns = now_ns();
+      receiver.reset();
+      std::this_thread::sleep_for(c.down_time);
+      cycle.restart_ns = now_ns();
+      cycle.generation = generation;
+      receiver = start_receiver();
+      wait_until([&]() { return log.get_first_delivery_ns(cycle.generation) != 0; }, c.recovery_timeout);
+      cycles.push_back(cycle);
+    }
+    // A steady period after the last restart, so that its recovery is seen in full
+    std::this_thread::sleep_for(c.steady_time);
+    auto stop_ns = now_ns();
+    sending = false;
+    send_thread.join();
+    std::this_thread::sleep_for(c.drain_time);
+
+    nlohmann::json summary;
+    result["cycles"] = analyse_cycles(c, cycles, stop_ns, sends, log, first_sequence, summary);
+    result["summary"] = std::move(summary);
+  }
+
+  receiver.reset();
+  sender.reset();
+  IOManager::get()->reset();
+  if (service != nullptr) {
+    result["connectivity_service_requests"] = service->get_request_counts();
+  }
+  return result;
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::string patterns = "sendrecv,pubsub";
+  std::string lookups = "preconfigured,connectivity_service";
+  std::string output = "reconnection_benchmark.json";
+  size_t cycles = 10;
+  double rate_hz = 1000.;
+  size_t message_size = 1024;
+  uint16_t port = 15900;
+  uint32_t publish_interval_ms = 100;
+  size_t send_timeout_ms = 100;
+  size_t steady_ms = 1000;
+  size_t down_ms = 500;
+  size_t recovery_timeout_ms = 10000;
+  size_t connect_timeout_ms = 10000;
+  size_t drain_ms = 1000;
+  size_t delay_threshold_ms = 100;
+  size_t stall_threshold_ms = 10;
+
+  bpo::options_description desc(std::string(argv[0]) + " known arguments"); // NOLINT
+  desc.add_options()(
+    "patterns",
+    bpo::value(&patterns)->default_value(patterns),
+    "Comma-separated connection types, sendrecv and/or pubsub")(
+    "lookups",
+    bpo::value(&lookups)->default_value(lookups),
+    "Comma-separated lookup modes, preconfigured and/or connectivity_service")(
+    "cycles", bpo::value(&cycles)->default_value(cycles), "Receiver kills and restarts per case")(
+    "rate_hz", bpo::value(&rate_hz)->default_value(rate_hz), "Messages sent per second")(
+    "message_size", bpo::value(&message_size)->default_value(message_size), "Payload size in bytes")(
+    "port", bpo::value(&port)->default_value(port), "First port of preconfigured cases; each case uses the next one")(
+    "publish_interval_ms",
+    bpo::value(&publish_interval_ms)->default_value(publish_interval_ms),
+    "Connectivity Service publish interval")(
+    "send_timeout_ms", bpo::value(&send_timeout_ms)->default_value(send_timeout_ms), "Timeout of each send")(
+    "steady_ms", bpo::value(&steady_ms)->default_value(steady_ms), "Time the receiver runs before each kill")(
+    "down_ms", bpo::value(&down_ms)->default_value(down_ms), "Time between killing and restarting the receiver")(
+    "recovery_timeout_ms",
+    bpo::value(&recovery_timeout_ms)->default_value(recovery_timeout_ms),
+    "Time allowed for messages to reach the restarted receiver")(
+    "connect_timeout_ms",
+    bpo::value(&connect_timeout_ms)->default_value(connect_timeout_ms),
+    "Time allowed for the first receiver to start and the first message to get through")(
+    "drain_ms",
+    bpo::value(&drain_ms)->default_value(drain_ms),
+    "Time allowed after sending stops for messages in flight to arrive")(
+    "delay_threshold_ms",
+    bpo::value(&delay_threshold_ms)->default_value(delay_threshold_ms),
+    "Latency above which a delivered message counts as delayed")(
+    "stall_threshold_ms",
+    bpo::value(&stall_threshold_ms)->default_value(stall_threshold_ms),
+    "Send duration above which the sending thread counts as stalled")(
+    "output,o", bpo::value(&output)->default_value(output), "JSON output file, - for stdout")(
+    "help,h", "produce help message");
+
+  // Used when the benchmark starts itself as the receiver process
+  std::string receiver_uid;
+  std::string receiver_pattern;
+  uint16_t receiver_port = 0;
+  uint16_t service_port = 0;
+  int receiver_fd = -1;
+  bpo::options_description hidden;
+  hidden.add_options()("receiver_uid", bpo::value(&receiver_uid))("receiver_pattern", bpo::value(&receiver_pattern))(
+    "receiver_port", bpo::value(&receiver_port))("service_port", bpo::value(&service_port))(
+    "receiver_fd", bpo::value(&receiver_fd));
+  bpo::options_description all;
+  all.add(desc).add(hidden);
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::parse_command_line(argc, argv, all), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& ex) {
+    std::cerr << ex.what() << "\n" << desc << "\n";
+    return 1;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << "\n"; // NOLINT
+    return 0;
+  }
+  if (vm.count("receiver_fd")) {
+    return run_receiver(receiver_uid, receiver_pattern, receiver_port, service_port, publish_interval_ms, receiver_fd);
+  }
+
+  if (!check_list_values("patterns", patterns, { "sendrecv", "pubsub" }) ||
+      !check_list_values("lookups", lookups, { "preconfigured", "connectivity_service" })) {
+    return 1;
+  }
+  if (rate_hz <= 0) {
+    std::cerr << "rate_hz must be positive\n";
+    return 1;
+  }
+
+  nlohmann::json results;
+  results["benchmark"] = "reconnection";
+  results["host"] = get_host_info();
+  results["results"] = nlohmann::json::array();
+
+  std::unique_ptr<StandInConnectivityService> service;
+  size_t index = 0;
+  for (auto& lookup : parse_list<std::string>(lookups)) {
+    if (lookup == "connectivity_service" && service == nullptr) {
+      service = std::make_unique<StandInConnectivityService>();
+    }
+    for (auto& pattern : parse_list<std::string>(patterns)) {
+      Case c{ index,
+              pattern,
+              lookup,
+              static_cast<uint16_t>(port + index),
+              cycles,
+              rate_hz,
+              message_size,
+              publish_interval_ms,
+              Sender::timeout_t(send_timeout_ms),
+              std::chrono::milliseconds(steady_ms),
+              std::chrono::milliseconds(down_ms),
+              std::chrono::milliseconds(recovery_timeout_ms),
+              std::chrono::milliseconds(connect_timeout_ms),
+              std::chrono::milliseconds(drain_ms),
+              delay_threshold_ms * 1000000,
+              stall_threshold_ms * 1000000 };
+      ++index;
+      auto result = run_case(c, lookup == "connectivity_service" ? service.get() : nullptr, argv[0]);
+      if (result["connected"].get<bool>()) {
+        auto& summary = result["summary"];
+        TLOG() << pattern << " " << lookup << ": recovered " << summary["recovered"].get<size_t>() << "/" << cycles
+               << ", p50 recovery " << summary["recovery"]["p50_ns"].get<uint64_t>() / 1000000 << " ms, lost "
+               << summary["lost"].get<size_t>() << ", stalled " << summary["stall_ms"].get<double>() << " ms";
+      } else {
+        TLOG() << pattern << " " << lookup << ": receiver did not connect";
+      }
+      results["results"].push_back(std::move(result));
+    }
+  }
+
+  write_json(results, output);
+  return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file Backoff_test.cxx ExponentialBackoff class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/Backoff.hpp"
+
+#define BOOST_TEST_MODULE Backoff_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(Backoff_test)
+
+BOOST_AUTO_TEST_CASE(DoublesUpToMax)
+{
+  ExponentialBackoff backoff(std::chrono::milliseconds(10), std::chrono::milliseconds(100), 0);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 10);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 20);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 40);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 80);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 100);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 100);
+  BOOST_REQUIRE_EQUAL(backoff.get_retries(), 6);
+
+  backoff.reset();
+  BOOST_REQUIRE_EQUAL(backoff.get_retries(), 0);
+  BOOST_REQUIRE_EQUAL(backoff.next().count(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(JitterStaysInRange)
+{
+  ExponentialBackoff backoff(std::chrono::milliseconds(1000), std::chrono::milliseconds(1000), 0.2);
+  bool varied = false;
+  auto first = backoff.next();
+  for (int ii = 0; ii < 100; ++ii) {
+    auto delay = backoff.next();
+    BOOST_REQUIRE(delay >= std::chrono::milliseconds(800));
+    BOOST_REQUIRE(delay <= std::chrono::milliseconds(1200));
+    varied = varied || delay != first;
+  }
+  BOOST_REQUIRE(varied);
+}
+
+BOOST_AUTO_TEST_CASE(NoOverflowNearMax)
+{
+  ExponentialBackoff backoff(std::chrono::hours(1), std::chrono::milliseconds::max(), 0);
+  for (int ii = 0; ii < 100; ++ii) {
+    BOOST_REQUIRE(backoff.next() > std::chrono::milliseconds(0));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
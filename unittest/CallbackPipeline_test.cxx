@@ -0,0 +1,208 @@
+/**
+ * @file CallbackPipeline_test.cxx CallbackPipeline class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/CallbackPipeline.hpp"
+#include "iomanager/network/NetworkIssues.hpp"
+
+#define BOOST_TEST_MODULE CallbackPipeline_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+namespace {
+constexpr int s_bad_message = -1;
+
+std::vector<uint8_t>
+encode(int value)
+{
+  std::vector<uint8_t> message(sizeof(value));
+  std::memcpy(message.data(), &value, sizeof(value));
+  return message;
+}
+
+// Decodes with a random delay, so that workers finish out of order
+int
+decode(std::vector<uint8_t>&& message)
+{
+  thread_local std::mt19937 gen(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  std::uniform_int_distribution<int> delay(0, 200);
+  std::this_thread::sleep_for(std::chrono::microseconds(delay(gen)));
+
+  int value = 0;
+  std::memcpy(&value, message.data(), sizeof(value));
+  if (value == s_bad_message) {
+    throw MessageDecodeFailed(ERS_HERE, "test", "bad message");
+  }
+  return value;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(CallbackPipeline_test)
+
+BOOST_AUTO_TEST_CASE(PreserveOrder)
+{
+  ReceivePipelineOptions options;
+  options.decode_threads = 4;
+  options.preserve_order = true;
+  options.max_in_flight = 16;
+
+  std::vector<int> received;
+  std::atomic<int> concurrent_callbacks{ 0 };
+  std::atomic<int> max_concurrent_callbacks{ 0 };
+  std::atomic<int> errors{ 0 };
+  {
+    CallbackPipeline<int> pipeline(
+      options,
+      decode,
+      [&](int& value) {
+        auto now = ++concurrent_callbacks;
+        max_concurrent_callbacks = std::max(max_concurrent_callbacks.load(), now);
+        received.push_back(value);
+        --concurrent_callbacks;
+      },
+      [&](ers::Issue const&) { ++errors; });
+
+    for (int ii = 0; ii < 1000; ++ii) {
+      pipeline.push(encode(ii % 100 == 50 ? s_bad_message : ii));
+    }
+    pipeline.stop();
+  }
+
+  // Messages which fail to decode are skipped, all others arrive in order, one at a time
+  BOOST_REQUIRE_EQUAL(errors.load(), 10);
+  BOOST_REQUIRE_EQUAL(received.size(), 990);
+  for (size_t ii = 1; ii < received.size(); ++ii) {
+    BOOST_REQUIRE_LT(received[ii - 1], received[ii]);
+  }
+  BOOST_REQUIRE_EQUAL(max_concurrent_callbacks.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Unordered)
+{
+  ReceivePipelineOptions options;
+  options.decode_threads = 4;
+  options.preserve_order = false;
+
+  std::mutex received_mutex;
+  std::vector<int> received;
+  CallbackPipeline<int> pipeline(
+    options,
+    decode,
+    [&](int& value) {
+      std::lock_guard<std::mutex> lk(received_mutex);
+      received.push_back(value);
+    },
+    [](ers::Issue const&) {});
+
+  for (int ii = 0; ii < 1000; ++ii) {
+    pipeline.push(encode(ii));
+  }
+  pipeline.stop();
+
+  std::sort(received.begin(), received.end());
+  BOOST_REQUIRE_EQUAL(received.size(), 1000);
+  for (int ii = 0; ii < 1000; ++ii) {
+    BOOST_REQUIRE_EQUAL(received[ii], ii);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MaxInFlight)
+{
+  ReceivePipelineOptions options;
+  options.decode_threads = 2;
+  options.max_in_flight = 4;
+
+  std::atomic<bool> blocked{ true };
+  std::atomic<int> pushed{ 0 };
+  std::atomic<int> delivered{ 0 };
+  CallbackPipeline<int> pipeline(
+    options,
+    decode,
+    [&](int&) {
+      while (blocked.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      ++delivered;
+    },
+    [](ers::Issue const&) {});
+
+  std::thread producer([&] {
+    for (int ii = 0; ii < 10; ++ii) {
+      pipeline.push(encode(ii));
+      ++pushed;
+    }
+  });
+
+  // Receiving stops while the callback holds up delivery
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_REQUIRE_EQUAL(pushed.load(), options.max_in_flight);
+
+  blocked = false;
+  producer.join();
+  pipeline.stop();
+  BOOST_REQUIRE_EQUAL(delivered.load(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(NonErsExceptions)
+{
+  for (bool preserve_order : { true, false }) {
+    ReceivePipelineOptions options;
+    options.decode_threads = 2;
+    options.preserve_order = preserve_order;
+    options.max_in_flight = 2;
+
+    std::atomic<int> delivered{ 0 };
+    std::atomic<int> decode_errors{ 0 };
+    std::atomic<int> callback_errors{ 0 };
+    CallbackPipeline<int> pipeline(
+      options,
+      [](std::vector<uint8_t>&& message) {
+        auto value = decode(std::move(message));
+        if (value % 3 == 1) {
+          throw std::runtime_error("decoder failure");
+        }
+        return value;
+      },
+      [&](int& value) {
+        if (value % 3 == 2) {
+          throw std::runtime_error("callback failure");
+        }
+        ++delivered;
+      },
+      [&](ers::Issue const& issue) {
+        if (dynamic_cast<MessageDecodeFailed const*>(&issue) != nullptr) {
+          ++decode_errors;
+        } else if (dynamic_cast<OperationFailed const*>(&issue) != nullptr) {
+          ++callback_errors;
+        }
+      });
+
+    // Failed messages must release their in-flight slots, or push would block once two have failed
+    for (int ii = 0; ii < 300; ++ii) {
+      pipeline.push(encode(ii));
+    }
+    pipeline.stop();
+
+    BOOST_REQUIRE_EQUAL(decode_errors.load(), 100);
+    BOOST_REQUIRE_EQUAL(callback_errors.load(), 100);
+    BOOST_REQUIRE_EQUAL(delivered.load(), 100);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
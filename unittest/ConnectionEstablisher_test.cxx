@@ -0,0 +1,170 @@
+/**
+ * @file ConnectionEstablisher_test.cxx ConnectionEstablisher class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/ConnectionEstablisher.hpp"
+
+#define BOOST_TEST_MODULE ConnectionEstablisher_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(ConnectionEstablisher_test)
+
+BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
+{
+  BOOST_REQUIRE(!std::is_copy_constructible_v<ConnectionEstablisher>);
+  BOOST_REQUIRE(!std::is_copy_assignable_v<ConnectionEstablisher>);
+  BOOST_REQUIRE(!std::is_move_constructible_v<ConnectionEstablisher>);
+  BOOST_REQUIRE(!std::is_move_assignable_v<ConnectionEstablisher>);
+}
+
+BOOST_AUTO_TEST_CASE(ImmediateSuccess)
+{
+  ConnectionEstablisher establisher(2);
+  BOOST_REQUIRE_EQUAL(establisher.get_worker_count(), 2);
+
+  std::promise<bool> promise;
+  auto future = promise.get_future();
+  establisher.submit(
+    "immediate",
+    [&]() {
+      promise.set_value(true);
+      return true;
+    },
+    [&]() { promise.set_value(false); },
+    std::chrono::milliseconds(1000));
+
+  BOOST_REQUIRE(future.wait_for(std::chrono::milliseconds(1000)) == std::future_status::ready);
+  BOOST_REQUIRE(future.get());
+}
+
+BOOST_AUTO_TEST_CASE(RetryUntilSuccess)
+{
+  ConnectionEstablisher establisher(1, std::chrono::milliseconds(1));
+
+  std::atomic<int> attempts{ 0 };
+  std::promise<int> promise;
+  auto future = promise.get_future();
+  establisher.submit(
+    "retry",
+    [&]() {
+      if (++attempts < 5) {
+        return false;
+      }
+      promise.set_value(attempts.load());
+      return true;
+    },
+    [&]() { promise.set_value(-1); },
+    std::chrono::milliseconds(5000));
+
+  BOOST_REQUIRE(future.wait_for(std::chrono::milliseconds(5000)) == std::future_status::ready);
+  BOOST_REQUIRE_EQUAL(future.get(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(AbandonAfterDeadline)
+{
+  ConnectionEstablisher establisher(1, std::chrono::milliseconds(1));
+
+  std::promise<bool> promise;
+  auto future = promise.get_future();
+  auto start = std::chrono::steady_clock::now();
+  establisher.submit(
+    "never", [&]() { return false; }, [&]() { promise.set_value(false); }, std::chrono::milliseconds(50));
+
+  BOOST_REQUIRE(future.wait_for(std::chrono::milliseconds(5000)) == std::future_status::ready);
+  BOOST_REQUIRE(!future.get());
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+BOOST_AUTO_TEST_CASE(DelayedFirstAttempt)
+{
+  ConnectionEstablisher establisher(1);
+
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  auto start = std::chrono::steady_clock::now();
+  establisher.submit(
+    "delayed",
+    [&]() {
+      promise.set_value();
+      return true;
+    },
+    []() {},
+    std::chrono::milliseconds(5000),
+    std::chrono::milliseconds(50));
+
+  BOOST_REQUIRE(future.wait_for(std::chrono::milliseconds(5000)) == std::future_status::ready);
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50));
+}
+
+BOOST_AUTO_TEST_CASE(RetriesBackOff)
+{
+  ConnectionEstablisher establisher(1, std::chrono::milliseconds(10), std::chrono::milliseconds(1000));
+
+  // Retrying every 10 ms would make about 30 attempts, backing off from 10 ms makes about 5
+  std::atomic<int> attempts{ 0 };
+  establisher.submit(
+    "backoff", [&]() { return ++attempts == 0; }, []() {}, std::chrono::milliseconds(300));
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  BOOST_REQUIRE(attempts.load() >= 2);
+  BOOST_REQUIRE(attempts.load() < 10);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentAttempts)
+{
+  // One slow connection must not hold up the others
+  const size_t n_intents = 4;
+  ConnectionEstablisher establisher(n_intents);
+
+  std::vector<std::promise<void>> promises(n_intents);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_intents; ++ii) {
+    establisher.submit(
+      "slow" + std::to_string(ii),
+      [&, ii]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        promises[ii].set_value();
+        return true;
+      },
+      []() {},
+      std::chrono::milliseconds(5000));
+  }
+  for (auto& promise : promises) {
+    promise.get_future().wait();
+  }
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200 * n_intents));
+}
+
+BOOST_AUTO_TEST_CASE(StopAbandonsOutstanding)
+{
+  auto establisher = std::make_unique<ConnectionEstablisher>(1, std::chrono::milliseconds(100));
+
+  std::atomic<bool> abandoned{ false };
+  establisher->submit(
+    "stopped", [&]() { return false; }, [&]() { abandoned = true; }, std::chrono::milliseconds::max());
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  establisher->stop();
+  BOOST_REQUIRE(abandoned.load());
+
+  // Submitting after stop abandons immediately
+  abandoned = false;
+  establisher->submit(
+    "late", [&]() { return true; }, [&]() { abandoned = true; }, std::chrono::milliseconds(1000));
+  BOOST_REQUIRE(abandoned.load());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
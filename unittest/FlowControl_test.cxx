@@ -0,0 +1,128 @@
+/**
+ * @file FlowControl_test.cxx CreditGrantor and CreditTracker class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/FlowControl.hpp"
+#include "iomanager/network/NetworkManager.hpp"
+#include "opmonlib/TestOpMonManager.hpp"
+
+#define BOOST_TEST_MODULE FlowControl_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+using namespace std::chrono_literals;
+
+BOOST_AUTO_TEST_SUITE(FlowControl_test)
+
+const std::string TEST_OKS_DB = "test/config/iomanager_test.data.xml";
+
+struct FlowControlTestFixture
+{
+  FlowControlTestFixture()
+  {
+    confdb = std::make_shared<dunedaq::conffwk::Configuration>("oksconflibs:" + TEST_OKS_DB);
+    confdb->get<dunedaq::confmodel::NetworkConnection>(connections);
+
+    // The credits for "network" travel on "network_credits"
+    conn_id.uid = "network";
+    conn_id.data_type = "data_t";
+    options.enabled = true;
+    options.window = 4;
+
+    dunedaq::opmonlib::TestOpMonManager opmgr;
+    NetworkManager::get().configure("FlowControl_t", connections, nullptr, opmgr); // Not using ConfigClient
+  }
+  ~FlowControlTestFixture() { NetworkManager::get().reset(); }
+
+  FlowControlTestFixture(FlowControlTestFixture const&) = default;
+  FlowControlTestFixture(FlowControlTestFixture&&) = default;
+  FlowControlTestFixture& operator=(FlowControlTestFixture const&) = default;
+  FlowControlTestFixture& operator=(FlowControlTestFixture&&) = default;
+
+  ConnectionId conn_id;
+  FlowControlOptions options;
+  std::shared_ptr<dunedaq::conffwk::Configuration> confdb;
+  std::vector<const dunedaq::confmodel::NetworkConnection*> connections;
+};
+
+namespace {
+// Grant until the tracker sees credit; the credit connection is established in the background
+bool
+grant_until_credit(CreditGrantor& grantor, CreditTracker& tracker)
+{
+  for (int ii = 0; ii < 100; ++ii) {
+    grantor.update();
+    if (tracker.wait_for_credit(10ms)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether wait_for_credit gives up after its timeout, and not much later
+bool
+times_out(CreditTracker& tracker, std::chrono::milliseconds timeout)
+{
+  auto start = std::chrono::steady_clock::now();
+  if (tracker.wait_for_credit(timeout)) {
+    return false;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed >= timeout && elapsed < timeout + 500ms;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(CumulativeGrants, FlowControlTestFixture)
+{
+  CreditTracker tracker(conn_id, options);
+  CreditGrantor grantor(conn_id, options);
+  BOOST_REQUIRE(tracker.is_enabled());
+  BOOST_REQUIRE(grantor.is_enabled());
+
+  // Nothing may be sent before the first grant
+  BOOST_REQUIRE_EQUAL(tracker.available(), 0);
+  BOOST_REQUIRE(times_out(tracker, 50ms));
+
+  BOOST_REQUIRE(grant_until_credit(grantor, tracker));
+  BOOST_REQUIRE_EQUAL(tracker.available(), 4);
+  tracker.on_sent(4);
+  BOOST_REQUIRE_EQUAL(tracker.available(), 0);
+  BOOST_REQUIRE(times_out(tracker, 50ms));
+
+  // A grant covers everything consumed so far, so two deliveries allow two more messages
+  grantor.on_delivered(2);
+  BOOST_REQUIRE(grant_until_credit(grantor, tracker));
+  BOOST_REQUIRE_EQUAL(tracker.available(), 2);
+  tracker.on_sent(2);
+  BOOST_REQUIRE_EQUAL(tracker.available(), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(EpochReset, FlowControlTestFixture)
+{
+  CreditTracker tracker(conn_id, options);
+  {
+    CreditGrantor grantor(conn_id, options);
+    grantor.on_delivered(10);
+    BOOST_REQUIRE(grant_until_credit(grantor, tracker));
+    BOOST_REQUIRE_EQUAL(tracker.available(), 4);
+    tracker.on_sent(4);
+    BOOST_REQUIRE_EQUAL(tracker.available(), 0);
+  }
+
+  // A restarted receiver counts from zero again, and messages sent to its predecessor no longer count
+  CreditGrantor restarted(conn_id, options);
+  BOOST_REQUIRE(grant_until_credit(restarted, tracker));
+  BOOST_REQUIRE_EQUAL(tracker.available(), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
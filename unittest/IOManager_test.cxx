@@ -7,6 +7,9 @@
  */
 
 #include "iomanager/IOManager.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/SharedBuffer.hpp"
+#include "iomanager/test/SyntheticConfiguration.hpp"
 
 #include "serialization/Serialization.hpp"
 #include "opmonlib/TestOpMonManager.hpp"
@@ -15,7 +18,15 @@
 
 #include "boost/test/unit_test.hpp"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <numeric>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -103,6 +114,15 @@ struct NonCopyableData
   DUNE_DAQ_SERIALIZE(NonCopyableData, d1, d2, d3);
 };
 
+// Payloads of 64 KiB or more are gathered in place on transports supporting vectored sends
+struct PayloadData
+{
+  int d1;
+  SharedBuffer payload;
+
+  DUNE_DAQ_SERIALIZE(PayloadData, d1, payload);
+};
+
 struct NonSerializableData
 {
   int d1;
@@ -150,6 +170,7 @@ DUNE_DAQ_SERIALIZABLE(iomanager::Data, "data_t");
 DUNE_DAQ_SERIALIZABLE(iomanager::Data2, "data2_t");
 DUNE_DAQ_SERIALIZABLE(iomanager::Data3, "data3_t");
 DUNE_DAQ_SERIALIZABLE(iomanager::NonCopyableData, "data_t");
+DUNE_DAQ_SERIALIZABLE(iomanager::PayloadData, "payload_t");
 
 // Note: Using the same data type string is bad, don't do it for real data types!
 template<>
@@ -213,6 +234,57 @@ struct ConfigurationTestFixture
   dunedaq::opmonlib::TestOpMonManager opmgr;
 };
 
+// Shared memory rings are visible to the whole host, so the ring is named after this process
+struct SharedMemoryTestFixture
+{
+  SharedMemoryTestFixture()
+  {
+    config.add_network_connection(
+      "network_shm", "data_t", "kSendRecv", "shm", "IOManager_test_" + std::to_string(getpid()));
+    config.add_network_connection(
+      "payload_shm", "payload_t", "kSendRecv", "shm", "IOManager_test_payload_" + std::to_string(getpid()));
+    config.load();
+
+    shm_id = ConnectionId{ "network_shm", "data_t" };
+    payload_shm_id = ConnectionId{ "payload_shm", "payload_t" };
+
+    IOManager::get()->configure("IOManager_t", config.get_queues(), config.get_connections(), nullptr, opmgr);
+  }
+  ~SharedMemoryTestFixture() { IOManager::get()->reset(); }
+
+  SharedMemoryTestFixture(SharedMemoryTestFixture const&) = delete;
+  SharedMemoryTestFixture(SharedMemoryTestFixture&&) = delete;
+  SharedMemoryTestFixture& operator=(SharedMemoryTestFixture const&) = delete;
+  SharedMemoryTestFixture& operator=(SharedMemoryTestFixture&&) = delete;
+
+  ConnectionId shm_id;
+  ConnectionId payload_shm_id;
+  dunedaq::iomanager::test::SyntheticConfiguration config;
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+};
+
+namespace {
+// Large payloads arrive intact, whether the transport gathers them (shm) or they are copied (inproc, tcp)
+void
+check_payload_send_receive(ConnectionId const& id)
+{
+  auto net_receiver = IOManager::get()->get_receiver<PayloadData>(id);
+  auto net_sender = IOManager::get()->get_sender<PayloadData>(id);
+
+  std::vector<uint8_t> bytes(1024 * 1024);
+  std::iota(bytes.begin(), bytes.end(), 0);
+  for (int ii = 0; ii < 3; ++ii) {
+    net_sender->send(PayloadData{ ii, SharedBuffer(bytes.data(), bytes.size()) }, std::chrono::milliseconds(1000));
+  }
+  for (int ii = 0; ii < 3; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(1000));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+    BOOST_REQUIRE_EQUAL(ret.payload.size(), bytes.size());
+    BOOST_CHECK(std::equal(ret.payload.begin(), ret.payload.end(), bytes.begin()));
+  }
+}
+} // namespace
+
 BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
 {
   BOOST_REQUIRE(!std::is_copy_constructible_v<IOManager>);
@@ -487,6 +559,90 @@ BOOST_FIXTURE_TEST_CASE(CallbackRegistration, ConfigurationTestFixture)
   IOManager::get()->remove_callback<Data>(queue_id);
 }
 
+BOOST_FIXTURE_TEST_CASE(AsyncSendReceive, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.async_send.enabled = true;
+  options.async_send.queue_capacity = 16;
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  const int n_messages = 100;
+  for (int ii = 0; ii < n_messages; ++ii) {
+    net_sender->send(Data(ii, 26.5, "test1"), std::chrono::milliseconds(1000));
+  }
+  BOOST_REQUIRE(net_sender->try_send(Data(n_messages, 26.5, "test1"), std::chrono::milliseconds(1000)));
+  net_sender->flush(std::chrono::milliseconds(1000));
+
+  for (int ii = 0; ii <= n_messages; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(PipelinedCallback, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.receive_pipeline.decode_threads = 4;
+  options.receive_pipeline.preserve_order = true;
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  std::mutex received_mutex;
+  std::vector<int> received;
+  std::function<void(Data&)> callback = [&](Data& d) {
+    std::lock_guard<std::mutex> lk(received_mutex);
+    received.push_back(d.d1);
+  };
+  IOManager::get()->add_callback<Data>(conn_id, callback);
+
+  const int n_messages = 100;
+  for (int ii = 0; ii < n_messages; ++ii) {
+    net_sender->send(Data(ii, 26.5, std::string(10000, 'x')), std::chrono::milliseconds(100));
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < deadline) {
+    {
+      std::lock_guard<std::mutex> lk(received_mutex);
+      if (received.size() == n_messages) {
+        break;
+      }
+    }
+    usleep(1000);
+  }
+  IOManager::get()->remove_callback<Data>(conn_id);
+
+  BOOST_REQUIRE_EQUAL(received.size(), n_messages);
+  for (int ii = 0; ii < n_messages; ++ii) {
+    BOOST_CHECK_EQUAL(received[ii], ii);
+  }
+}
+
+BOOST_FIXTURE_TEST_CASE(CallbackReceiveConflict, ConfigurationTestFixture)
+{
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+
+  std::function<void(Data&)> callback = [&](Data&) {};
+  IOManager::get()->add_callback<Data>(conn_id, callback);
+
+  // The callback loop owns the connection until the callback is removed
+  BOOST_REQUIRE_EXCEPTION(net_receiver->receive(std::chrono::milliseconds(10)),
+                          ReceiveCallbackConflict,
+                          [](ReceiveCallbackConflict const&) { return true; });
+  BOOST_REQUIRE(!net_receiver->try_receive(std::chrono::milliseconds(10)));
+
+  IOManager::get()->remove_callback<Data>(conn_id);
+
+  net_sender->send(Data(56, 26.5, "test1"), std::chrono::milliseconds(100));
+  auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret.d1, 56);
+}
+
 BOOST_FIXTURE_TEST_CASE(NonCopyableCallbackRegistration, ConfigurationTestFixture)
 {
   auto net_sender = IOManager::get()->get_sender<NonCopyableData>(conn_id);
@@ -622,6 +778,283 @@ BOOST_FIXTURE_TEST_CASE(GetDatatype, ConfigurationTestFixture)
   BOOST_REQUIRE_EQUAL(invalidDataTypes.size(), 0);
 }
 
+BOOST_FIXTURE_TEST_CASE(CoalescedSendReceive, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.coalescing.enabled = true;
+  options.coalescing.max_delay = std::chrono::milliseconds(500);
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  const int n_messages = 100;
+  for (int ii = 0; ii < n_messages; ++ii) {
+    net_sender->send(Data(ii, ii * 0.5, "coalesced"), Sender::s_no_block);
+  }
+
+  // Held back until the batch is flushed
+  BOOST_REQUIRE(!net_receiver->try_receive(std::chrono::milliseconds(10)));
+  net_sender->flush(std::chrono::milliseconds(100));
+  for (int ii = 0; ii < n_messages; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+    BOOST_CHECK_EQUAL(ret.d3, "coalesced");
+  }
+
+  // Flushed by the flush thread once max_delay has passed
+  net_sender->send(Data(n_messages, 0, "delayed"), Sender::s_no_block);
+  auto ret = net_receiver->receive(std::chrono::milliseconds(2000));
+  BOOST_CHECK_EQUAL(ret.d1, n_messages);
+  BOOST_CHECK_EQUAL(ret.d3, "delayed");
+}
+
+BOOST_FIXTURE_TEST_CASE(CompressedSendReceive, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.compression.algorithm = CompressionAlgorithm::kLZ4;
+  options.compression.min_size = 1024;
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  // Frames are read from the ipm Receiver, to check what was sent on the wire
+  auto raw_receiver = NetworkManager::get().get_receiver(conn_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  // One message above and one below the size threshold
+  std::string large(100000, 'x');
+  net_sender->send(Data(56, 26.5, large), Sender::s_no_block);
+  net_sender->send(Data(57, 27.5, "small"), Sender::s_no_block);
+
+  // Fails rather than passing uncompressed if LZ4 is not available in this build
+  std::deque<std::vector<uint8_t>> messages;
+  auto frame = raw_receiver->receive(std::chrono::milliseconds(100)).data;
+  BOOST_REQUIRE(!frame.empty());
+  BOOST_CHECK_EQUAL(frame[0], s_compressed_frame_type);
+  BOOST_CHECK_LT(frame.size(), large.size() / 10);
+  unpack_frame(std::move(frame), messages);
+  frame = raw_receiver->receive(std::chrono::milliseconds(100)).data;
+  BOOST_REQUIRE(!frame.empty());
+  BOOST_CHECK_NE(frame[0], s_compressed_frame_type);
+  unpack_frame(std::move(frame), messages);
+
+  BOOST_REQUIRE_EQUAL(messages.size(), 2);
+  auto ret = dunedaq::serialization::deserialize<Data>(messages[0]);
+  BOOST_CHECK_EQUAL(ret.d1, 56);
+  BOOST_CHECK_EQUAL(ret.d3, large);
+  ret = dunedaq::serialization::deserialize<Data>(messages[1]);
+  BOOST_CHECK_EQUAL(ret.d1, 57);
+  BOOST_CHECK_EQUAL(ret.d3, "small");
+}
+
+BOOST_FIXTURE_TEST_CASE(TracedSendReceive, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.tracing.sample_interval = 2;
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  // Every second message is traced, and the trace becomes current on the receiving thread
+  clear_current_trace();
+  for (int ii = 0; ii < 4; ++ii) {
+    net_sender->send(Data(ii, 26.5, "traced"), Sender::s_no_block);
+  }
+  for (int ii = 0; ii < 4; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+    BOOST_CHECK_EQUAL(get_current_trace().is_active(), ii % 2 == 1);
+  }
+  auto trace_id = get_current_trace().trace_id;
+  BOOST_CHECK_EQUAL(get_current_trace().hop_count, 1);
+
+  // A message sent while handling a traced one continues its trace
+  net_sender->send(Data(4, 26.5, "continued"), Sender::s_no_block);
+  auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret.d1, 4);
+  BOOST_CHECK_EQUAL(get_current_trace().trace_id, trace_id);
+  BOOST_CHECK_EQUAL(get_current_trace().hop_count, 2);
+  clear_current_trace();
+}
+
+BOOST_FIXTURE_TEST_CASE(FlowControlledSendReceive, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.flow_control.enabled = true;
+  options.flow_control.window = 10;
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+
+  // Credit is granted while the receiver is receiving
+  for (int ii = 0; ii < 100 && !net_sender->is_ready_for_sending(std::chrono::milliseconds(10)); ++ii) {
+    net_receiver->try_receive(std::chrono::milliseconds(10));
+  }
+  auto credit = net_sender->available_credit();
+  BOOST_REQUIRE(credit.has_value());
+  BOOST_REQUIRE_EQUAL(*credit, 10);
+
+  for (int ii = 0; ii < 10; ++ii) {
+    net_sender->send(Data(ii, 26.5, "credit"), std::chrono::milliseconds(100));
+  }
+  BOOST_REQUIRE_EQUAL(*net_sender->available_credit(), 0);
+  BOOST_REQUIRE(!net_sender->try_send(Data(10, 26.5, "credit"), std::chrono::milliseconds(10)));
+
+  for (int ii = 0; ii < 10; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+  }
+  BOOST_REQUIRE(net_sender->try_send(Data(10, 26.5, "credit"), std::chrono::milliseconds(1000)));
+  auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret.d1, 10);
+}
+
+BOOST_FIXTURE_TEST_CASE(SharedMemorySendReceive, SharedMemoryTestFixture)
+{
+  auto net_receiver = IOManager::get()->get_receiver<Data>(shm_id);
+  auto net_sender = IOManager::get()->get_sender<Data>(shm_id);
+
+  for (int ii = 0; ii < 100; ++ii) {
+    net_sender->send(Data(ii, 28.5, "shm"), std::chrono::milliseconds(100));
+  }
+  for (int ii = 0; ii < 100; ++ii) {
+    auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+    BOOST_CHECK_EQUAL(ret.d1, ii);
+    BOOST_CHECK_EQUAL(ret.d3, "shm");
+  }
+  BOOST_REQUIRE(!net_receiver->try_receive(std::chrono::milliseconds(10)).has_value());
+}
+
+BOOST_FIXTURE_TEST_CASE(SharedMemoryGatheredPayload, SharedMemoryTestFixture)
+{
+  check_payload_send_receive(payload_shm_id);
+}
+
+BOOST_FIXTURE_TEST_CASE(CopiedPayload, ConfigurationTestFixture)
+{
+  check_payload_send_receive(ConnectionId{ "payload", "payload_t" });
+}
+
+BOOST_FIXTURE_TEST_CASE(ReconnectAfterTimeout, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.reconnect.initial_backoff = std::chrono::milliseconds(100);
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  // Nobody is receiving, so the send times out and the connection is replaced in the background
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+  BOOST_REQUIRE_EXCEPTION(net_sender->send(Data(56, 26.5, "test1"), std::chrono::milliseconds(10)),
+                          TimeoutExpired,
+                          [](TimeoutExpired const&) { return true; });
+
+  // Until then, sends fail without waiting for their timeout
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EXCEPTION(net_sender->send(Data(57, 26.5, "test1"), std::chrono::milliseconds(1000)),
+                          ConnectionReconnecting,
+                          [](ConnectionReconnecting const&) { return true; });
+  BOOST_REQUIRE(!net_sender->try_send(Data(57, 26.5, "test1"), std::chrono::milliseconds(1000)));
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  BOOST_REQUIRE(net_sender->is_ready_for_sending(std::chrono::milliseconds(2000)));
+  net_sender->send(Data(58, 26.5, "test1"), std::chrono::milliseconds(100));
+  auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret.d1, 58);
+}
+
+BOOST_FIXTURE_TEST_CASE(ReadinessCheckDuringReconnect, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.reconnect.initial_backoff = std::chrono::milliseconds(100);
+  IOManager::get()->set_connection_options(conn_id, options);
+
+  auto net_sender = IOManager::get()->get_sender<Data>(conn_id);
+  BOOST_REQUIRE_EXCEPTION(net_sender->send(Data(56, 26.5, "test1"), std::chrono::milliseconds(10)),
+                          TimeoutExpired,
+                          [](TimeoutExpired const&) { return true; });
+
+  // Readiness checks and sends race for the replacement connection
+  std::atomic<bool> sending{ true };
+  std::atomic<size_t> sent{ 0 };
+  std::thread sender_thread([&]() {
+    while (sending) {
+      if (net_sender->try_send(Data(57, 26.5, "test1"), std::chrono::milliseconds(1))) {
+        ++sent;
+      }
+    }
+  });
+  for (int ii = 0; ii < 10; ++ii) {
+    net_sender->is_ready_for_sending(std::chrono::milliseconds(5));
+  }
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>(conn_id);
+  auto ready = net_sender->is_ready_for_sending(std::chrono::milliseconds(2000));
+  auto start = std::chrono::steady_clock::now();
+  while (sent == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  sending = false;
+  sender_thread.join();
+
+  BOOST_REQUIRE(ready);
+  BOOST_REQUIRE_GT(sent.load(), 0);
+  auto ret = net_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret.d1, 57);
+}
+
+BOOST_FIXTURE_TEST_CASE(SharedSubscriberPubSub, ConfigurationTestFixture)
+{
+  ConnectionOptions options;
+  options.shared_subscriber.enabled = true;
+  IOManager::get()->set_connection_options(ConnectionId{ "pub.*", "data2_t" }, options);
+
+  // Both patterns resolve to pub1 and pub2, so the receivers share one subscriber
+  auto other_id = ConnectionId{ "pub[12]", "data2_t" };
+  auto pub1_sender = IOManager::get()->get_sender<Data2>(pub1_id);
+  auto sub1_receiver = IOManager::get()->get_receiver<Data2>(sub1_id);
+  auto other_receiver = IOManager::get()->get_receiver<Data2>(other_id);
+
+  pub1_sender->send(Data2(56, 26.5), dunedaq::iomanager::Sender::s_no_block);
+  auto ret1 = sub1_receiver->receive(std::chrono::milliseconds(100));
+  auto ret2 = other_receiver->receive(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(ret1.d1, 56);
+  BOOST_CHECK_EQUAL(ret2.d1, 56);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectionWarmupAtConfigure)
+{
+  auto confdb = std::make_shared<dunedaq::conffwk::Configuration>("oksconflibs:" + TEST_OKS_DB);
+  std::vector<const dunedaq::confmodel::Queue*> queues;
+  std::vector<const dunedaq::confmodel::NetworkConnection*> connections;
+  confdb->get<dunedaq::confmodel::Queue>(queues);
+  confdb->get<dunedaq::confmodel::NetworkConnection>(connections);
+  dunedaq::opmonlib::TestOpMonManager opmgr;
+
+  ConnectionWarmup warmup;
+  warmup.receivers.push_back(ConnectionId{ "network", "data_t" });
+  warmup.senders.push_back(ConnectionId{ "network", "data_t" });
+  warmup.senders.push_back(ConnectionId{ "pub1", "data2_t" });
+  IOManager::get()->configure("IOManager_t", queues, connections, nullptr, opmgr, warmup);
+
+  auto results = IOManager::get()->get_warmup_results();
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+  for (auto& result : results) {
+    BOOST_REQUIRE(result.success);
+    BOOST_TEST_MESSAGE("Warm-up of " << to_string(result.id) << " took " << result.setup_time.count() << " us");
+  }
+
+  auto net_receiver = IOManager::get()->get_receiver<Data>("network");
+  auto net_sender = IOManager::get()->get_sender<Data>("network");
+  BOOST_REQUIRE(net_sender->is_ready_for_sending(Sender::s_no_block));
+
+  net_sender->send(Data(56, 26.5, "test1"), Sender::s_no_block);
+  auto ret = net_receiver->receive(std::chrono::milliseconds(10));
+  BOOST_CHECK_EQUAL(ret.d1, 56);
+
+  IOManager::get()->reset();
+}
+
 // TODO: Eric Flumerfelt <eflumerf@github.com>, June-16-2022: Reimplement this test for IOManager
 /*
 BOOST_FIXTURE_TEST_CASE(SendThreadSafety, NetworkManagerTestFixture)
@@ -0,0 +1,63 @@
+/**
+ * @file Instrumentation_test.cxx Instrumentation probe Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/Instrumentation.hpp"
+
+#define BOOST_TEST_MODULE Instrumentation_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(Instrumentation_test)
+
+BOOST_AUTO_TEST_CASE(ProbeIndex)
+{
+  static_assert(get_probe_index("queue_push") == 0);
+  static_assert(get_probe_index("callback_invoke") == s_probe_names.size() - 1);
+  static_assert(get_probe_index("unknown") == s_probe_names.size());
+}
+
+BOOST_AUTO_TEST_CASE(CountsFromManyThreads)
+{
+  constexpr size_t probe = get_probe_index("sender_send");
+  auto before = ProbeCounters::get()->get_hits(probe);
+  const size_t threads = 8;
+  const size_t count = 10000;
+  std::vector<std::thread> workers;
+  for (size_t ii = 0; ii < threads; ++ii) {
+    workers.emplace_back([&]() {
+      for (size_t jj = 0; jj < count; ++jj) {
+        ProbeCounters::get()->count<probe>(100);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  BOOST_REQUIRE_EQUAL(ProbeCounters::get()->get_hits(probe) - before, threads * count);
+}
+
+BOOST_AUTO_TEST_CASE(ProbeMacro)
+{
+  std::string uid = "conn";
+  int evaluated = 0;
+  auto before = ProbeCounters::get()->get_hits(get_probe_index("queue_pop"));
+  IOMANAGER_PROBE(queue_pop, uid, ++evaluated);
+
+  // The arguments are not even evaluated when the probes are compiled out
+  auto expected = s_instrumentation_level == InstrumentationLevel::kNone ? 0 : 1;
+  BOOST_REQUIRE_EQUAL(evaluated, expected);
+  BOOST_REQUIRE_EQUAL(ProbeCounters::get()->get_hits(get_probe_index("queue_pop")) - before, expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+/**
+ * @file MessageCompression_test.cxx MessageCompressor class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/MessageCompression.hpp"
+#include "iomanager/network/MessageFraming.hpp"
+
+#define BOOST_TEST_MODULE MessageCompression_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+namespace {
+std::vector<uint8_t>
+make_waveform(size_t size)
+{
+  // Slowly varying samples, compressible like real waveform data
+  std::vector<uint8_t> message(size);
+  message[0] = 'M';
+  for (size_t ii = 1; ii < size; ++ii) {
+    message[ii] = static_cast<uint8_t>((ii / 64) % 16);
+  }
+  return message;
+}
+
+std::vector<uint8_t>
+make_noise(size_t size)
+{
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<uint8_t> message(size);
+  message[0] = 'M';
+  for (size_t ii = 1; ii < size; ++ii) {
+    message[ii] = static_cast<uint8_t>(dist(gen));
+  }
+  return message;
+}
+
+void
+check_round_trip(CompressionAlgorithm algorithm)
+{
+  CompressionOptions options;
+  options.algorithm = algorithm;
+  MessageCompressor compressor("test", options);
+  if (!compressor.is_enabled()) {
+    BOOST_TEST_MESSAGE(to_string(algorithm) << " is not available, skipping");
+    return;
+  }
+
+  auto message = make_waveform(1024 * 1024);
+  SerializationBuffer frame;
+  BOOST_REQUIRE(compressor.compress(message.data(), message.size(), frame));
+  BOOST_REQUIRE_EQUAL(frame.data()[0], s_compressed_frame_type);
+  BOOST_REQUIRE_LT(frame.size(), message.size());
+  BOOST_TEST_MESSAGE(to_string(algorithm) << " compressed " << message.size() << " bytes to " << frame.size());
+
+  std::deque<std::vector<uint8_t>> received;
+  unpack_frame(std::vector<uint8_t>(frame.data(), frame.data() + frame.size()), received);
+  BOOST_REQUIRE_EQUAL(received.size(), 1);
+  BOOST_REQUIRE(received.front() == message);
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(MessageCompression_test)
+
+BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
+{
+  BOOST_REQUIRE(!std::is_copy_constructible_v<MessageCompressor>);
+  BOOST_REQUIRE(!std::is_copy_assignable_v<MessageCompressor>);
+  BOOST_REQUIRE(!std::is_move_constructible_v<MessageCompressor>);
+  BOOST_REQUIRE(!std::is_move_assignable_v<MessageCompressor>);
+}
+
+BOOST_AUTO_TEST_CASE(LZ4RoundTrip)
+{
+  check_round_trip(CompressionAlgorithm::kLZ4);
+}
+
+BOOST_AUTO_TEST_CASE(ZstdRoundTrip)
+{
+  check_round_trip(CompressionAlgorithm::kZstd);
+}
+
+BOOST_AUTO_TEST_CASE(Bypass)
+{
+  CompressionOptions options;
+  MessageCompressor disabled("test", options);
+  BOOST_REQUIRE(!disabled.is_enabled());
+
+  options.algorithm = CompressionAlgorithm::kLZ4;
+  options.min_size = 4096;
+  MessageCompressor compressor("test", options);
+  if (!compressor.is_enabled()) {
+    BOOST_TEST_MESSAGE("lz4 is not available, skipping");
+    return;
+  }
+
+  SerializationBuffer frame;
+  auto small = make_waveform(options.min_size - 1);
+  BOOST_REQUIRE(!compressor.compress(small.data(), small.size(), frame));
+  BOOST_REQUIRE(!disabled.compress(small.data(), small.size(), frame));
+
+  // Data which does not get smaller is sent as it is
+  auto noise = make_noise(64 * 1024);
+  BOOST_REQUIRE(!compressor.compress(noise.data(), noise.size(), frame));
+}
+
+BOOST_AUTO_TEST_CASE(CompressedBatch)
+{
+  CompressionOptions options;
+  options.algorithm = CompressionAlgorithm::kLZ4;
+  MessageCompressor compressor("test", options);
+  if (!compressor.is_enabled()) {
+    BOOST_TEST_MESSAGE("lz4 is not available, skipping");
+    return;
+  }
+
+  BatchFrameBuilder batch;
+  std::vector<std::vector<uint8_t>> sent;
+  for (size_t ii = 0; ii < 10; ++ii) {
+    sent.push_back(make_waveform(1000 + ii));
+    batch.append(sent.back().data(), sent.back().size());
+  }
+
+  SerializationBuffer frame;
+  BOOST_REQUIRE(compressor.compress(batch.data(), batch.size(), frame));
+
+  std::deque<std::vector<uint8_t>> received;
+  unpack_frame(std::vector<uint8_t>(frame.data(), frame.data() + frame.size()), received);
+  BOOST_REQUIRE_EQUAL(received.size(), sent.size());
+  for (size_t ii = 0; ii < sent.size(); ++ii) {
+    BOOST_REQUIRE(received[ii] == sent[ii]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CorruptFrame)
+{
+  std::deque<std::vector<uint8_t>> received;
+  std::vector<uint8_t> truncated{ s_compressed_frame_type, static_cast<uint8_t>(CompressionAlgorithm::kLZ4) };
+  BOOST_REQUIRE_EXCEPTION(
+    unpack_frame(std::move(truncated), received), MessageDecodeFailed, [](MessageDecodeFailed const&) { return true; });
+
+  std::vector<uint8_t> unknown(MessageCompressor::s_header_size + 10, 0);
+  unknown[0] = s_compressed_frame_type;
+  unknown[1] = 200;
+  BOOST_REQUIRE_EXCEPTION(
+    unpack_frame(std::move(unknown), received), MessageDecodeFailed, [](MessageDecodeFailed const&) { return true; });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+/**
+ * @file MessageFraming_test.cxx Message framing Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/MessageFraming.hpp"
+
+#define BOOST_TEST_MODULE MessageFraming_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+namespace {
+std::vector<uint8_t>
+make_message(size_t size, uint8_t fill)
+{
+  std::vector<uint8_t> message(size, fill);
+  message[0] = 'M';
+  return message;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(MessageFraming_test)
+
+BOOST_AUTO_TEST_CASE(PlainMessagePassesThrough)
+{
+  auto message = make_message(100, 1);
+  auto storage = message.data();
+
+  std::deque<std::vector<uint8_t>> messages;
+  unpack_frame(std::move(message), messages);
+  BOOST_REQUIRE_EQUAL(messages.size(), 1);
+  BOOST_REQUIRE(messages.front().data() == storage);
+}
+
+BOOST_AUTO_TEST_CASE(BatchRoundTrip)
+{
+  std::vector<std::vector<uint8_t>> sent;
+  BatchFrameBuilder builder;
+  BOOST_REQUIRE(builder.empty());
+  BOOST_REQUIRE_EQUAL(builder.size(), 0);
+
+  for (size_t ii = 0; ii < 10; ++ii) {
+    sent.push_back(make_message(10 + ii * 100, static_cast<uint8_t>(ii)));
+    builder.append(sent.back().data(), sent.back().size());
+  }
+  BOOST_REQUIRE_EQUAL(builder.message_count(), 10);
+
+  std::vector<uint8_t> frame(builder.data(), builder.data() + builder.size());
+  BOOST_REQUIRE_EQUAL(frame[0], s_batch_frame_type);
+
+  std::deque<std::vector<uint8_t>> received;
+  unpack_frame(std::move(frame), received);
+  BOOST_REQUIRE_EQUAL(received.size(), sent.size());
+  for (size_t ii = 0; ii < sent.size(); ++ii) {
+    BOOST_REQUIRE(received[ii] == sent[ii]);
+  }
+
+  // The builder can be reused after clearing
+  builder.clear();
+  BOOST_REQUIRE(builder.empty());
+  builder.append(sent[0].data(), sent[0].size());
+  BOOST_REQUIRE_EQUAL(builder.message_count(), 1);
+  BOOST_REQUIRE_EQUAL(builder.size(), BatchFrameBuilder::s_header_size + sizeof(uint32_t) + sent[0].size());
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedBatch)
+{
+  BatchFrameBuilder builder;
+  auto message = make_message(100, 2);
+  builder.append(message.data(), message.size());
+  builder.append(message.data(), message.size());
+
+  std::vector<uint8_t> frame(builder.data(), builder.data() + builder.size() - 1);
+  std::deque<std::vector<uint8_t>> received;
+  BOOST_REQUIRE_EXCEPTION(
+    unpack_frame(std::move(frame), received), MessageDecodeFailed, [](MessageDecodeFailed const&) { return true; });
+
+  std::vector<uint8_t> header_only{ s_batch_frame_type, 1 };
+  BOOST_REQUIRE_EXCEPTION(unpack_frame(std::move(header_only), received),
+                          MessageDecodeFailed,
+                          [](MessageDecodeFailed const&) { return true; });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,145 @@
+/**
+ * @file MessageTracing_test.cxx Message tracing Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/MessageFraming.hpp"
+#include "iomanager/network/MessageTracing.hpp"
+
+#define BOOST_TEST_MODULE MessageTracing_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <deque>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+namespace {
+struct Traced
+{
+  int value{ 0 };
+  TraceContext trace_context;
+};
+
+struct Untraced
+{
+  int value{ 0 };
+};
+
+SerializationBuffer
+make_message(size_t size)
+{
+  SerializationBuffer buffer;
+  std::vector<char> message(size, 1);
+  message[0] = 'M';
+  buffer.write(message.data(), message.size());
+  return buffer;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(MessageTracing_test)
+
+BOOST_AUTO_TEST_CASE(EnvelopeRoundTrip)
+{
+  auto context = TraceContext::start();
+  BOOST_REQUIRE(context.is_active());
+  context.add_hop(context.origin_ns + 10);
+  context.add_hop(context.origin_ns + 20);
+
+  auto message = make_message(100);
+  SerializationBuffer frame;
+  wrap_trace_envelope(context, message, frame);
+  BOOST_REQUIRE_EQUAL(frame.size(), s_trace_header_size + 2 * sizeof(uint64_t) + 100);
+  BOOST_REQUIRE_EQUAL(frame.data()[0], s_trace_frame_type);
+
+  std::vector<uint8_t> received(frame.data(), frame.data() + frame.size());
+  auto unwrapped = unwrap_trace_envelope(received);
+  BOOST_REQUIRE_EQUAL(unwrapped.trace_id, context.trace_id);
+  BOOST_REQUIRE_EQUAL(unwrapped.origin_ns, context.origin_ns);
+  BOOST_REQUIRE_EQUAL(unwrapped.hop_count, 2);
+  BOOST_REQUIRE_EQUAL(unwrapped.last_hop_ns(), context.origin_ns + 20);
+  BOOST_REQUIRE_EQUAL(received.size(), 100);
+  BOOST_REQUIRE_EQUAL(received[0], 'M');
+}
+
+BOOST_AUTO_TEST_CASE(UntracedMessageUnchanged)
+{
+  std::vector<uint8_t> message(10, 'M');
+  auto context = unwrap_trace_envelope(message);
+  BOOST_REQUIRE(!context.is_active());
+  BOOST_REQUIRE_EQUAL(message.size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedEnvelope)
+{
+  std::vector<uint8_t> message = { s_trace_frame_type, s_trace_envelope_version, 2, 0 };
+  BOOST_REQUIRE_THROW(unwrap_trace_envelope(message), MessageDecodeFailed);
+}
+
+BOOST_AUTO_TEST_CASE(EnvelopeInBatch)
+{
+  auto context = TraceContext::start();
+  context.add_hop(context.origin_ns);
+  auto message = make_message(50);
+  SerializationBuffer frame;
+  wrap_trace_envelope(context, message, frame);
+
+  BatchFrameBuilder batch;
+  batch.append(message.data(), message.size());
+  batch.append(frame.data(), frame.size());
+  std::deque<std::vector<uint8_t>> messages;
+  unpack_frame(std::vector<uint8_t>(batch.data(), batch.data() + batch.size()), messages);
+  BOOST_REQUIRE_EQUAL(messages.size(), 2);
+  BOOST_REQUIRE(!unwrap_trace_envelope(messages[0]).is_active());
+  BOOST_REQUIRE_EQUAL(unwrap_trace_envelope(messages[1]).trace_id, context.trace_id);
+  BOOST_REQUIRE_EQUAL(messages[1].size(), 50);
+}
+
+BOOST_AUTO_TEST_CASE(HopsBeyondLimit)
+{
+  TraceContext context = TraceContext::start();
+  for (uint64_t ii = 1; ii <= TraceContext::s_max_hops + 3; ++ii) {
+    context.add_hop(ii);
+  }
+  BOOST_REQUIRE_EQUAL(context.hop_count, TraceContext::s_max_hops);
+  BOOST_REQUIRE_EQUAL(context.hops[0], 4);
+  BOOST_REQUIRE_EQUAL(context.last_hop_ns(), TraceContext::s_max_hops + 3);
+}
+
+BOOST_AUTO_TEST_CASE(Statistics)
+{
+  TraceStatistics statistics;
+  TraceContext context;
+  context.trace_id = 1;
+  context.origin_ns = 1000;
+  context.add_hop(5000);
+  statistics.record(context, 8000);
+  statistics.record(context, 4000); // Clock offset
+  BOOST_REQUIRE_EQUAL(statistics.get_traced_message_count(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(CurrentTraceFollowsData)
+{
+  BOOST_REQUIRE(has_trace_context<Traced>::value);
+  BOOST_REQUIRE(!has_trace_context<Untraced>::value);
+
+  auto context = TraceContext::start();
+  Traced data;
+  {
+    ScopedTraceContext scope(context);
+    attach_current_trace(data);
+  }
+  BOOST_REQUIRE(!get_current_trace().is_active());
+  BOOST_REQUIRE_EQUAL(data.trace_context.trace_id, context.trace_id);
+
+  adopt_trace(data);
+  BOOST_REQUIRE_EQUAL(get_current_trace().trace_id, context.trace_id);
+  clear_current_trace();
+  BOOST_REQUIRE(!get_current_trace().is_active());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
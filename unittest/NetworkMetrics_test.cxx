@@ -0,0 +1,79 @@
+/**
+ * @file NetworkMetrics_test.cxx NetworkMetrics class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/NetworkMetrics.hpp"
+
+#define BOOST_TEST_MODULE NetworkMetrics_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(NetworkMetrics_test)
+
+BOOST_AUTO_TEST_CASE(Buckets)
+{
+  using std::chrono::microseconds;
+  using std::chrono::nanoseconds;
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(nanoseconds(0)), 0);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(nanoseconds(999)), 0);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(microseconds(1)), 1);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(microseconds(2)), 2);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(microseconds(3)), 2);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(microseconds(4)), 3);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(microseconds(1000)), 10);
+  BOOST_REQUIRE_EQUAL(NetworkMetrics::get_bucket(std::chrono::hours(1)), NetworkMetrics::s_histogram_buckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(CollectResets)
+{
+  NetworkMetrics metrics;
+  metrics.add(NetworkMetrics::kMessages);
+  metrics.add(NetworkMetrics::kBytes, 100);
+  metrics.add_time(NetworkMetrics::kTotalTimeNs, std::chrono::microseconds(5));
+  metrics.record(std::chrono::microseconds(5));
+
+  auto snapshot = metrics.collect();
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kMessages], 1);
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kBytes], 100);
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kTotalTimeNs], 5000);
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kFailures], 0);
+  BOOST_REQUIRE_EQUAL(snapshot.histogram[3], 1);
+
+  snapshot = metrics.collect();
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kMessages], 0);
+  BOOST_REQUIRE_EQUAL(snapshot.histogram[3], 0);
+}
+
+BOOST_AUTO_TEST_CASE(ManyThreads)
+{
+  NetworkMetrics metrics;
+  const size_t threads = 40;
+  const size_t count = 10000;
+  std::vector<std::thread> workers;
+  for (size_t ii = 0; ii < threads; ++ii) {
+    workers.emplace_back([&]() {
+      for (size_t jj = 0; jj < count; ++jj) {
+        metrics.add(NetworkMetrics::kMessages);
+        metrics.record(std::chrono::nanoseconds(10));
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto snapshot = metrics.collect();
+  BOOST_REQUIRE_EQUAL(snapshot.counters[NetworkMetrics::kMessages], threads * count);
+  BOOST_REQUIRE_EQUAL(snapshot.histogram[0], threads * count);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
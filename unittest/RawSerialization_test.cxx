@@ -0,0 +1,158 @@
+/**
+ * @file RawSerialization_test.cxx Raw serialization Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/RawSerialization.hpp"
+#include "iomanager/network/SharedBuffer.hpp"
+
+#define BOOST_TEST_MODULE RawSerialization_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager {
+struct RawHit
+{
+  uint64_t timestamp;
+  uint32_t channel;
+  uint16_t adc;
+  uint16_t flags;
+};
+
+struct RawHeader
+{
+  uint32_t run;
+  uint32_t sequence;
+};
+} // namespace iomanager
+
+// Must be in dunedaq namespace only
+DUNE_DAQ_SERIALIZABLE(iomanager::RawHit, "raw_hit_t");
+DUNE_DAQ_SERIALIZABLE(std::vector<iomanager::RawHit>, "raw_hits_t");
+DUNE_DAQ_SERIALIZABLE(iomanager::RawHeader, "raw_header_t");
+DUNE_DAQ_RAW_SERIALIZABLE(iomanager::RawHit, 1);
+DUNE_DAQ_RAW_SERIALIZABLE(iomanager::RawHeader, 1);
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+
+namespace {
+std::vector<uint8_t>
+to_vector(SerializationBuffer const& buffer)
+{
+  return std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.size());
+}
+
+std::vector<RawHit>
+make_hits(size_t count)
+{
+  std::vector<RawHit> hits(count);
+  for (size_t ii = 0; ii < count; ++ii) {
+    hits[ii] = { 1000 + ii, static_cast<uint32_t>(ii % 2560), static_cast<uint16_t>(ii), 0 };
+  }
+  return hits;
+}
+
+bool
+any_issue(MessageDecodeFailed const&)
+{
+  return true;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RawSerialization_test)
+
+BOOST_AUTO_TEST_CASE(Traits)
+{
+  BOOST_REQUIRE(is_raw_serializable<RawHit>::value);
+  BOOST_REQUIRE(is_raw_serializable<std::vector<RawHit>>::value);
+  BOOST_REQUIRE(!is_raw_serializable<std::string>::value);
+  BOOST_REQUIRE(!is_raw_serializable<std::vector<int>>::value);
+  BOOST_REQUIRE_EQUAL(raw_serialization_version<RawHit>::value, 1);
+}
+
+BOOST_AUTO_TEST_CASE(ScalarRoundTrip)
+{
+  RawHit hit{ 123456789, 42, 1000, 3 };
+  SerializationBuffer buffer;
+  serialize_raw(hit, buffer);
+  BOOST_REQUIRE_EQUAL(buffer.size(), detail::s_raw_header_size + sizeof(RawHit));
+  BOOST_REQUIRE_EQUAL(buffer.data()[0], s_raw_message_type);
+
+  auto received = deserialize_shared<RawHit>(to_vector(buffer));
+  BOOST_REQUIRE_EQUAL(received.timestamp, hit.timestamp);
+  BOOST_REQUIRE_EQUAL(received.channel, hit.channel);
+  BOOST_REQUIRE_EQUAL(received.adc, hit.adc);
+  BOOST_REQUIRE_EQUAL(received.flags, hit.flags);
+}
+
+BOOST_AUTO_TEST_CASE(ArrayRoundTrip)
+{
+  for (size_t count : { 0, 1, 1000 }) {
+    auto hits = make_hits(count);
+    SerializationBuffer buffer;
+    serialize_raw(hits, buffer);
+    BOOST_REQUIRE_EQUAL(buffer.size(), detail::s_raw_header_size + count * sizeof(RawHit));
+
+    auto received = deserialize_raw<std::vector<RawHit>>(to_vector(buffer));
+    BOOST_REQUIRE_EQUAL(received.size(), count);
+    BOOST_REQUIRE(count == 0 || std::memcmp(received.data(), hits.data(), count * sizeof(RawHit)) == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GatherArray)
+{
+  auto hits = make_hits(10000);
+  SerializationBuffer buffer;
+  buffer.set_gather_threshold(4096);
+  serialize_raw(hits, buffer);
+  BOOST_REQUIRE(buffer.has_external_segments());
+  BOOST_REQUIRE_EQUAL(buffer.size(), detail::s_raw_header_size);
+
+  auto segments = buffer.segments();
+  BOOST_REQUIRE_EQUAL(segments.size(), 2);
+  BOOST_REQUIRE(segments[1].data == reinterpret_cast<const uint8_t*>(hits.data())); // NOLINT
+  BOOST_REQUIRE_EQUAL(segments[1].size, hits.size() * sizeof(RawHit));
+}
+
+BOOST_AUTO_TEST_CASE(HeaderValidation)
+{
+  SerializationBuffer buffer;
+  serialize_raw(RawHit{ 1, 2, 3, 4 }, buffer);
+  auto message = to_vector(buffer);
+
+  // Different type, or a single element received as an array
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<RawHeader>(message), MessageDecodeFailed, any_issue);
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<std::vector<RawHit>>(message), MessageDecodeFailed, any_issue);
+
+  // Layout version changed on one side only
+  auto bumped = message;
+  bumped[2] = 2;
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<RawHit>(bumped), MessageDecodeFailed, any_issue);
+
+  auto truncated = message;
+  truncated.pop_back();
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<RawHit>(truncated), MessageDecodeFailed, any_issue);
+  truncated.resize(detail::s_raw_header_size - 1);
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<RawHit>(truncated), MessageDecodeFailed, any_issue);
+
+  // Element count which does not match the payload
+  serialize_raw(make_hits(10), buffer);
+  auto array = to_vector(buffer);
+  uint64_t count = 1ULL << 62;
+  std::memcpy(array.data() + 12, &count, sizeof(count));
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<std::vector<RawHit>>(array), MessageDecodeFailed, any_issue);
+
+  // msgpack message
+  std::vector<uint8_t> msgpack{ 'M', 0x90 };
+  BOOST_REQUIRE_EXCEPTION(deserialize_raw<RawHit>(msgpack), MessageDecodeFailed, any_issue);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,142 @@
+/**
+ * @file SerializationBuffer_test.cxx SerializationBuffer class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SerializationBuffer.hpp"
+
+#define BOOST_TEST_MODULE SerializationBuffer_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(SerializationBuffer_test)
+
+BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
+{
+  BOOST_REQUIRE(!std::is_copy_constructible_v<SerializationBuffer>);
+  BOOST_REQUIRE(!std::is_copy_assignable_v<SerializationBuffer>);
+  BOOST_REQUIRE(std::is_move_constructible_v<SerializationBuffer>);
+  BOOST_REQUIRE(std::is_move_assignable_v<SerializationBuffer>);
+}
+
+BOOST_AUTO_TEST_CASE(SameBytesAsSerialize)
+{
+  SerializationBuffer buffer;
+
+  std::string str = "The quick brown fox jumps over the lazy dog";
+  serialize_into(str, buffer);
+  auto expected = dunedaq::serialization::serialize(str, dunedaq::serialization::kMsgPack);
+  BOOST_REQUIRE_EQUAL(buffer.size(), expected.size());
+  BOOST_REQUIRE(std::equal(expected.begin(), expected.end(), buffer.data()));
+
+  std::vector<int> vec(1000, 42);
+  serialize_into(vec, buffer);
+  auto expected_vec = dunedaq::serialization::serialize(vec, dunedaq::serialization::kMsgPack);
+  BOOST_REQUIRE_EQUAL(buffer.size(), expected_vec.size());
+  BOOST_REQUIRE(std::equal(expected_vec.begin(), expected_vec.end(), buffer.data()));
+
+  auto roundtrip = dunedaq::serialization::deserialize<std::vector<int>>(
+    std::vector<uint8_t>(buffer.data(), buffer.data() + buffer.size()));
+  BOOST_REQUIRE(roundtrip == vec);
+}
+
+BOOST_AUTO_TEST_CASE(CapacityIsRetained)
+{
+  SerializationBuffer buffer;
+  BOOST_REQUIRE(buffer.empty());
+  BOOST_REQUIRE_EQUAL(buffer.capacity(), 0);
+
+  std::vector<char> payload(10000, 'x');
+  buffer.write(payload.data(), payload.size());
+  BOOST_REQUIRE_EQUAL(buffer.size(), payload.size());
+  auto capacity = buffer.capacity();
+  auto storage = buffer.data();
+  BOOST_REQUIRE_GE(capacity, payload.size());
+
+  buffer.clear();
+  BOOST_REQUIRE(buffer.empty());
+  BOOST_REQUIRE_EQUAL(buffer.capacity(), capacity);
+
+  buffer.write(payload.data(), payload.size() / 2);
+  BOOST_REQUIRE(buffer.data() == storage);
+}
+
+BOOST_AUTO_TEST_CASE(Resize)
+{
+  SerializationBuffer buffer;
+  buffer.write("abc", 3);
+
+  // Growing keeps the existing bytes, shrinking only drops the size
+  buffer.resize(10000);
+  BOOST_REQUIRE_EQUAL(buffer.size(), 10000);
+  BOOST_REQUIRE_GE(buffer.capacity(), 10000);
+  BOOST_REQUIRE(std::equal(buffer.data(), buffer.data() + 3, "abc"));
+  auto capacity = buffer.capacity();
+  buffer.resize(2);
+  BOOST_REQUIRE_EQUAL(buffer.size(), 2);
+  BOOST_REQUIRE_EQUAL(buffer.capacity(), capacity);
+}
+
+BOOST_AUTO_TEST_CASE(RetentionLimit)
+{
+  SerializationBuffer buffer(8192);
+
+  std::vector<char> small(1000, 's');
+  buffer.write(small.data(), small.size());
+  buffer.clear();
+  BOOST_REQUIRE_GT(buffer.capacity(), 0);
+
+  std::vector<char> large(100000, 'l');
+  buffer.write(large.data(), large.size());
+  BOOST_REQUIRE_GE(buffer.capacity(), large.size());
+  buffer.clear();
+  BOOST_REQUIRE_EQUAL(buffer.capacity(), 0);
+  BOOST_REQUIRE(buffer.data() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GatherSegments)
+{
+  SerializationBuffer buffer;
+  std::vector<uint8_t> payload(1000, 'p');
+
+  // Gathering is disabled by default
+  BOOST_REQUIRE(!buffer.write_external(payload.data(), payload.size()));
+  BOOST_REQUIRE_EQUAL(buffer.segments().size(), 1);
+
+  buffer.set_gather_threshold(100);
+  BOOST_REQUIRE(!buffer.write_external(payload.data(), 99));
+
+  buffer.write("head", 4);
+  BOOST_REQUIRE(buffer.write_external(payload.data(), payload.size()));
+  BOOST_REQUIRE(buffer.write_external(payload.data() + 500, 100));
+  buffer.write("tail", 4);
+  BOOST_REQUIRE(buffer.has_external_segments());
+  BOOST_REQUIRE_EQUAL(buffer.size(), 8);
+  BOOST_REQUIRE_EQUAL(buffer.external_size(), 1100);
+
+  auto segments = buffer.segments();
+  BOOST_REQUIRE_EQUAL(segments.size(), 4);
+  BOOST_REQUIRE(segments[0].data == buffer.data());
+  BOOST_REQUIRE_EQUAL(segments[0].size, 4);
+  BOOST_REQUIRE(segments[1].data == payload.data());
+  BOOST_REQUIRE_EQUAL(segments[1].size, 1000);
+  BOOST_REQUIRE(segments[2].data == payload.data() + 500);
+  BOOST_REQUIRE_EQUAL(segments[2].size, 100);
+  BOOST_REQUIRE(segments[3].data == buffer.data() + 4);
+  BOOST_REQUIRE_EQUAL(segments[3].size, 4);
+
+  buffer.clear();
+  BOOST_REQUIRE(!buffer.has_external_segments());
+  BOOST_REQUIRE_EQUAL(buffer.external_size(), 0);
+  BOOST_REQUIRE_EQUAL(buffer.segments().size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+/**
+ * @file SerializationProfile_test.cxx SerializationProfile class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SerializationProfile.hpp"
+
+#define BOOST_TEST_MODULE SerializationProfile_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <limits>
+
+using namespace dunedaq::iomanager;
+
+BOOST_AUTO_TEST_SUITE(SerializationProfile_test)
+
+BOOST_AUTO_TEST_CASE(Buckets)
+{
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(0), 0);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(1), 1);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(2), 2);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(3), 2);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(4), 3);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(1024), 11);
+  BOOST_REQUIRE_EQUAL(SerializationProfile::get_bucket(std::numeric_limits<uint64_t>::max()),
+                      SerializationProfile::s_histogram_buckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(CountsByDirection)
+{
+  SerializationProfile profile("data_t");
+  BOOST_REQUIRE_EQUAL(profile.get_data_type(), "data_t");
+  profile.record(SerializationProfile::kEncode, 100, std::chrono::microseconds(2));
+  profile.record(SerializationProfile::kEncode, 200, std::chrono::microseconds(3));
+  profile.record(SerializationProfile::kDecode, 100, std::chrono::microseconds(1));
+  BOOST_REQUIRE_EQUAL(profile.get_message_count(SerializationProfile::kEncode), 2);
+  BOOST_REQUIRE_EQUAL(profile.get_message_count(SerializationProfile::kDecode), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
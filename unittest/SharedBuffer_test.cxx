@@ -0,0 +1,164 @@
+/**
+ * @file SharedBuffer_test.cxx SharedBuffer class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SharedBuffer.hpp"
+
+#define BOOST_TEST_MODULE SharedBuffer_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace dunedaq {
+namespace iomanager {
+struct ZeroCopyFragment
+{
+  int id;
+  SharedBuffer payload;
+
+  DUNE_DAQ_SERIALIZE(ZeroCopyFragment, id, payload);
+};
+
+struct CopiedFragment
+{
+  int id;
+  SharedBuffer payload;
+
+  DUNE_DAQ_SERIALIZE(CopiedFragment, id, payload);
+};
+} // namespace iomanager
+
+// Must be in dunedaq namespace only
+DUNE_DAQ_SERIALIZABLE(iomanager::ZeroCopyFragment, "zero_copy_fragment_t");
+DUNE_DAQ_SERIALIZABLE(iomanager::CopiedFragment, "copied_fragment_t");
+DUNE_DAQ_ZERO_COPY_DESERIALIZABLE(iomanager::ZeroCopyFragment);
+} // namespace dunedaq
+
+using namespace dunedaq::iomanager;
+
+namespace {
+std::vector<uint8_t>
+make_payload(size_t size)
+{
+  std::vector<uint8_t> payload(size);
+  std::iota(payload.begin(), payload.end(), 0);
+  return payload;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SharedBuffer_test)
+
+BOOST_AUTO_TEST_CASE(Ownership)
+{
+  auto payload = make_payload(1024);
+  auto expected = payload;
+  auto storage = payload.data();
+
+  SharedBuffer buffer(std::move(payload));
+  BOOST_REQUIRE(buffer.data() == storage);
+  BOOST_REQUIRE_EQUAL(buffer.size(), 1024);
+  BOOST_REQUIRE_EQUAL(buffer.use_count(), 1);
+
+  {
+    auto copy = buffer;
+    BOOST_REQUIRE(copy.data() == storage);
+    BOOST_REQUIRE_EQUAL(buffer.use_count(), 2);
+    BOOST_REQUIRE(copy == buffer);
+  }
+  BOOST_REQUIRE_EQUAL(buffer.use_count(), 1);
+  BOOST_REQUIRE(buffer.to_vector() == expected);
+
+  SharedBuffer empty;
+  BOOST_REQUIRE(empty.empty());
+  BOOST_REQUIRE(empty != buffer);
+}
+
+BOOST_AUTO_TEST_CASE(Slice)
+{
+  SharedBuffer buffer(make_payload(256));
+
+  auto slice = buffer.slice(16, 32);
+  BOOST_REQUIRE(slice.data() == buffer.data() + 16);
+  BOOST_REQUIRE_EQUAL(slice.size(), 32);
+  BOOST_REQUIRE_EQUAL(slice.data()[0], 16);
+  BOOST_REQUIRE_EQUAL(buffer.use_count(), 2);
+  BOOST_REQUIRE(buffer.contains(slice.data(), slice.size()));
+  BOOST_REQUIRE(!slice.contains(buffer.data(), buffer.size()));
+
+  BOOST_REQUIRE_NO_THROW(buffer.slice(256, 0));
+  BOOST_REQUIRE_THROW(buffer.slice(250, 10), std::out_of_range);
+  BOOST_REQUIRE_THROW(buffer.slice(300, 0), std::out_of_range);
+
+  // The slice keeps the storage alive after the original view is gone
+  buffer = SharedBuffer();
+  BOOST_REQUIRE_EQUAL(slice.use_count(), 1);
+  BOOST_REQUIRE_EQUAL(slice.data()[31], 47);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyPayload)
+{
+  SharedBuffer sent(make_payload(1024 * 1024));
+  auto received = dunedaq::serialization::serialize(sent, dunedaq::serialization::kMsgPack);
+  auto received_begin = received.data();
+  auto received_end = received.data() + received.size();
+
+  auto delivered = deserialize_shared<SharedBuffer>(std::move(received));
+  BOOST_REQUIRE(delivered == sent);
+  BOOST_REQUIRE(delivered.data() > received_begin && delivered.end() <= received_end);
+}
+
+BOOST_AUTO_TEST_CASE(ZeroCopyMember)
+{
+  ZeroCopyFragment frag{ 42, SharedBuffer(make_payload(65536)) };
+  auto received = dunedaq::serialization::serialize(frag, dunedaq::serialization::kMsgPack);
+  auto received_begin = received.data();
+  auto received_end = received.data() + received.size();
+
+  auto delivered = deserialize_shared<ZeroCopyFragment>(std::move(received));
+  BOOST_REQUIRE_EQUAL(delivered.id, 42);
+  BOOST_REQUIRE(delivered.payload == frag.payload);
+  BOOST_REQUIRE(delivered.payload.data() > received_begin && delivered.payload.end() <= received_end);
+}
+
+BOOST_AUTO_TEST_CASE(CopiedMember)
+{
+  CopiedFragment frag{ 43, SharedBuffer(make_payload(65536)) };
+  auto received = dunedaq::serialization::serialize(frag, dunedaq::serialization::kMsgPack);
+  auto received_begin = received.data();
+  auto received_end = received.data() + received.size();
+
+  auto delivered = deserialize_shared<CopiedFragment>(std::move(received));
+  BOOST_REQUIRE_EQUAL(delivered.id, 43);
+  BOOST_REQUIRE(delivered.payload == frag.payload);
+  BOOST_REQUIRE(delivered.payload.end() <= received_begin || delivered.payload.data() >= received_end);
+}
+
+BOOST_AUTO_TEST_CASE(GatherPayload)
+{
+  ZeroCopyFragment frag{ 44, SharedBuffer(make_payload(65536)) };
+  auto expected = dunedaq::serialization::serialize(frag, dunedaq::serialization::kMsgPack);
+
+  SerializationBuffer buffer;
+  buffer.set_gather_threshold(4096);
+  serialize_into(frag, buffer);
+  BOOST_REQUIRE(buffer.has_external_segments());
+
+  // The payload is referenced in place, and the segments form exactly the contiguous serialization
+  std::vector<uint8_t> gathered;
+  bool payload_in_place = false;
+  for (auto& segment : buffer.segments()) {
+    payload_in_place |= (segment.data == frag.payload.data() && segment.size == frag.payload.size());
+    gathered.insert(gathered.end(), segment.data, segment.data + segment.size);
+  }
+  BOOST_REQUIRE(payload_in_place);
+  BOOST_REQUIRE(gathered == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
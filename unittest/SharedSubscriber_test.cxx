@@ -0,0 +1,178 @@
+/**
+ * @file SharedSubscriber_test.cxx SharedSubscriber class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/SharedSubscriber.hpp"
+
+#define BOOST_TEST_MODULE SharedSubscriber_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq;
+
+namespace {
+
+// In-memory subscriber: messages published to it are received by the SharedSubscriber
+class FakeSubscriber : public ipm::Subscriber
+{
+public:
+  std::string connect_for_receives(const nlohmann::json&) override { return ""; }
+  bool can_receive() const noexcept override { return true; }
+  void subscribe(std::string const& topic) override
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_topics.insert(topic);
+  }
+  void unsubscribe(std::string const& topic) override
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_topics.erase(topic);
+  }
+
+  void publish(std::string const& topic, uint8_t value)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (m_topics.count(topic) == 0) {
+        return;
+      }
+      m_queue.push_back({ std::vector<uint8_t>{ value }, topic });
+    }
+    m_cv.notify_all();
+  }
+
+  std::set<std::string> get_topics()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_topics;
+  }
+
+protected:
+  Response receive_(const duration_t& timeout, bool) override
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (!m_cv.wait_for(lk, timeout, [&] { return !m_queue.empty(); })) {
+      return Response();
+    }
+    auto response = std::move(m_queue.front());
+    m_queue.pop_front();
+    return response;
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::set<std::string> m_topics;
+  std::deque<Response> m_queue;
+};
+
+const std::chrono::milliseconds s_timeout{ 1000 };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(SharedSubscriber_test)
+
+BOOST_AUTO_TEST_CASE(RoutesByTopic)
+{
+  auto fake = std::make_shared<FakeSubscriber>();
+  auto shared = std::make_shared<SharedSubscriber>(fake, std::vector<std::string>{ "inproc://foo" });
+  SubscriberChannel channel_a(shared, "a", 10);
+  SubscriberChannel channel_b(shared, "b", 10);
+  channel_a.subscribe("topic_a");
+  channel_b.subscribe("topic_b");
+  BOOST_REQUIRE_EQUAL(fake->get_topics().size(), 2);
+  BOOST_REQUIRE_EQUAL(shared->get_route_count(), 2);
+
+  fake->publish("topic_a", 1);
+  fake->publish("topic_b", 2);
+  fake->publish("topic_a", 3);
+
+  auto response = channel_a.receive(s_timeout);
+  BOOST_REQUIRE_EQUAL(response.data[0], 1);
+  BOOST_REQUIRE_EQUAL(response.metadata, "topic_a");
+  response = channel_a.receive(s_timeout);
+  BOOST_REQUIRE_EQUAL(response.data[0], 3);
+  response = channel_b.receive(s_timeout);
+  BOOST_REQUIRE_EQUAL(response.data[0], 2);
+  BOOST_REQUIRE(channel_b.receive(std::chrono::milliseconds(10), ipm::Receiver::s_any_size, true).data.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SameTopicFansOut)
+{
+  auto fake = std::make_shared<FakeSubscriber>();
+  auto shared = std::make_shared<SharedSubscriber>(fake, std::vector<std::string>{ "inproc://foo" });
+  SubscriberChannel channel_1(shared, "1", 10);
+  SubscriberChannel channel_2(shared, "2", 10);
+  channel_1.subscribe("topic");
+  channel_2.subscribe("topic");
+  BOOST_REQUIRE_EQUAL(shared->get_route_count(), 1);
+
+  fake->publish("topic", 42);
+  BOOST_REQUIRE_EQUAL(channel_1.receive(s_timeout).data[0], 42);
+  BOOST_REQUIRE_EQUAL(channel_2.receive(s_timeout).data[0], 42);
+}
+
+BOOST_AUTO_TEST_CASE(UnsubscribesWithLastChannel)
+{
+  auto fake = std::make_shared<FakeSubscriber>();
+  auto shared = std::make_shared<SharedSubscriber>(fake, std::vector<std::string>{ "inproc://foo" });
+  auto channel_1 = std::make_unique<SubscriberChannel>(shared, "1", 10);
+  SubscriberChannel channel_2(shared, "2", 10);
+  channel_1->subscribe("topic");
+  channel_2.subscribe("topic");
+  channel_2.subscribe("other");
+
+  channel_1.reset();
+  BOOST_REQUIRE_EQUAL(fake->get_topics().count("topic"), 1);
+  channel_2.unsubscribe("topic");
+  BOOST_REQUIRE_EQUAL(fake->get_topics().count("topic"), 0);
+  BOOST_REQUIRE_EQUAL(fake->get_topics().count("other"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FullQueueDrops)
+{
+  auto fake = std::make_shared<FakeSubscriber>();
+  auto shared = std::make_shared<SharedSubscriber>(fake, std::vector<std::string>{ "inproc://foo" });
+  SubscriberChannel channel(shared, "full", 2);
+  channel.subscribe("topic");
+
+  for (uint8_t ii = 0; ii < 5; ++ii) {
+    fake->publish("topic", ii);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (channel.get_dropped_count() < 3 && std::chrono::steady_clock::now() - start < s_timeout) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(channel.get_dropped_count(), 3);
+  BOOST_REQUIRE_EQUAL(channel.receive(s_timeout).data[0], 0);
+  BOOST_REQUIRE_EQUAL(channel.receive(s_timeout).data[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(ReceiveTimeout)
+{
+  auto fake = std::make_shared<FakeSubscriber>();
+  auto shared = std::make_shared<SharedSubscriber>(fake, std::vector<std::string>{ "inproc://foo" });
+  SubscriberChannel channel(shared, "idle", 10);
+  channel.subscribe("topic");
+
+  BOOST_REQUIRE_EXCEPTION(channel.receive(std::chrono::milliseconds(10)),
+                          ipm::ReceiveTimeoutExpired,
+                          [](ipm::ReceiveTimeoutExpired const&) { return true; });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,218 @@
+/**
+ * @file ShmTransport_test.cxx ShmSender and ShmReceiver class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "iomanager/network/NetworkIssues.hpp"
+#include "iomanager/network/ShmTransport.hpp"
+
+#define BOOST_TEST_MODULE ShmTransport_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::iomanager;
+using namespace dunedaq;
+
+namespace {
+
+const std::chrono::milliseconds s_timeout{ 1000 };
+
+std::string
+get_test_uri(std::string const& name)
+{
+  return std::string(s_shm_scheme) + "ShmTransport_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+std::vector<uint8_t>
+make_message(size_t size, uint8_t seed)
+{
+  std::vector<uint8_t> message(size);
+  for (size_t ii = 0; ii < size; ++ii) {
+    message[ii] = static_cast<uint8_t>(seed + ii);
+  }
+  return message;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ShmTransport_test)
+
+BOOST_AUTO_TEST_CASE(ParsesScheme)
+{
+  BOOST_REQUIRE(is_shm_uri("shm://foo"));
+  BOOST_REQUIRE(!is_shm_uri("tcp://127.0.0.1:5000"));
+  BOOST_REQUIRE(!is_shm_uri("inproc://foo"));
+}
+
+BOOST_AUTO_TEST_CASE(SendReceive)
+{
+  auto uri = get_test_uri("roundtrip");
+  ShmReceiver receiver(64 * 1024);
+  BOOST_REQUIRE(!receiver.can_receive());
+  BOOST_REQUIRE_EQUAL(receiver.connect_for_receives({ { "connection_string", uri } }), uri);
+  BOOST_REQUIRE(receiver.can_receive());
+
+  ShmSender sender;
+  sender.connect_for_sends({ { "connection_string", uri } });
+  BOOST_REQUIRE(sender.can_send());
+
+  auto message = make_message(100, 1);
+  BOOST_REQUIRE(sender.send(message.data(), message.size(), s_timeout));
+  BOOST_REQUIRE(sender.send(message.data(), 0, s_timeout));
+
+  auto response = receiver.receive(s_timeout);
+  BOOST_REQUIRE(response.data == message);
+  BOOST_REQUIRE(receiver.receive(s_timeout).data.empty());
+}
+
+BOOST_AUTO_TEST_CASE(SendSegments)
+{
+  auto uri = get_test_uri("segments");
+  ShmReceiver receiver(64 * 1024);
+  receiver.connect_for_receives({ { "connection_string", uri } });
+  ShmSender sender;
+  sender.connect_for_sends({ { "connection_string", uri } });
+
+  auto first = make_message(10, 1);
+  auto second = make_message(1000, 50);
+  BOOST_REQUIRE(sender.send_segments({ { first.data(), first.size() }, { second.data(), second.size() } }, s_timeout));
+
+  auto expected = first;
+  expected.insert(expected.end(), second.begin(), second.end());
+  BOOST_REQUIRE(receiver.receive(s_timeout).data == expected);
+}
+
+BOOST_AUTO_TEST_CASE(WrapsAround)
+{
+  auto uri = get_test_uri("wrap");
+  ShmReceiver receiver(64 * 1024);
+  receiver.connect_for_receives({ { "connection_string", uri } });
+  ShmSender sender;
+  sender.connect_for_sends({ { "connection_string", uri } });
+
+  // Many times the ring's capacity, with sizes which do not divide it
+  const size_t count = 2000;
+  std::thread consumer([&]() {
+    for (size_t ii = 0; ii < count; ++ii) {
+      auto response = receiver.receive(s_timeout);
+      BOOST_REQUIRE(response.data == make_message(ii * 37 % 5000, static_cast<uint8_t>(ii)));
+    }
+  });
+  for (size_t ii = 0; ii < count; ++ii) {
+    auto message = make_message(ii * 37 % 5000, static_cast<uint8_t>(ii));
+    sender.send(message.data(), message.size(), s_timeout);
+  }
+  consumer.join();
+}
+
+BOOST_AUTO_TEST_CASE(Timeouts)
+{
+  auto uri = get_test_uri("timeouts");
+  ShmReceiver receiver(64 * 1024);
+  receiver.connect_for_receives({ { "connection_string", uri } });
+
+  BOOST_REQUIRE_EXCEPTION(receiver.receive(std::chrono::milliseconds(10)),
+                          ipm::ReceiveTimeoutExpired,
+                          [](ipm::ReceiveTimeoutExpired const&) { return true; });
+  BOOST_REQUIRE(receiver.receive(std::chrono::milliseconds(10), ipm::Receiver::s_any_size, true).data.empty());
+
+  // Fill the ring, then a further send times out
+  ShmSender sender;
+  sender.connect_for_sends({ { "connection_string", uri } });
+  auto message = make_message(16 * 1024, 0);
+  size_t sent = 0;
+  while (sender.send(message.data(), message.size(), ipm::Sender::s_no_block, "", true)) {
+    ++sent;
+  }
+  BOOST_REQUIRE(sent > 0);
+  BOOST_REQUIRE_EXCEPTION(sender.send(message.data(), message.size(), std::chrono::milliseconds(10)),
+                          ipm::SendTimeoutExpired,
+                          [](ipm::SendTimeoutExpired const&) { return true; });
+
+  receiver.receive(s_timeout);
+  BOOST_REQUIRE(sender.send(message.data(), message.size(), s_timeout));
+}
+
+BOOST_AUTO_TEST_CASE(MessageTooLarge)
+{
+  auto uri = get_test_uri("large");
+  ShmReceiver receiver(64 * 1024);
+  receiver.connect_for_receives({ { "connection_string", uri } });
+  ShmSender sender;
+  sender.connect_for_sends({ { "connection_string", uri } });
+
+  auto message = make_message(40 * 1024, 0);
+  BOOST_REQUIRE_EXCEPTION(sender.send(message.data(), message.size(), s_timeout),
+                          SharedMemoryFailure,
+                          [](SharedMemoryFailure const&) { return true; });
+}
+
+BOOST_AUTO_TEST_CASE(ReceiverGone)
+{
+  auto uri = get_test_uri("gone");
+  ShmSender sender;
+  BOOST_REQUIRE_EXCEPTION(sender.connect_for_sends({ { "connection_string", uri } }),
+                          SharedMemoryFailure,
+                          [](SharedMemoryFailure const&) { return true; });
+
+  auto receiver = std::make_unique<ShmReceiver>(64 * 1024);
+  receiver->connect_for_receives({ { "connection_string", uri } });
+  sender.connect_for_sends({ { "connection_string", uri } });
+  receiver.reset();
+
+  auto message = make_message(10, 0);
+  BOOST_REQUIRE_EXCEPTION(sender.send(message.data(), message.size(), s_timeout),
+                          ipm::SendTimeoutExpired,
+                          [](ipm::SendTimeoutExpired const&) { return true; });
+  BOOST_REQUIRE_EXCEPTION(ShmSender().connect_for_sends({ { "connection_string", uri } }),
+                          SharedMemoryFailure,
+                          [](SharedMemoryFailure const&) { return true; });
+}
+
+BOOST_AUTO_TEST_CASE(CrossProcess)
+{
+  auto uri = get_test_uri("fork");
+  ShmReceiver receiver(64 * 1024);
+  receiver.connect_for_receives({ { "connection_string", uri } });
+
+  const size_t count = 1000;
+  auto pid = fork();
+  BOOST_REQUIRE(pid >= 0);
+  if (pid == 0) {
+    int status = 0;
+    try {
+      ShmSender sender;
+      sender.connect_for_sends({ { "connection_string", uri } });
+      for (size_t ii = 0; ii < count; ++ii) {
+        auto message = make_message(ii % 3000, static_cast<uint8_t>(ii));
+        sender.send(message.data(), message.size(), s_timeout);
+      }
+    } catch (...) {
+      status = 1;
+    }
+    _exit(status);
+  }
+
+  for (size_t ii = 0; ii < count; ++ii) {
+    BOOST_REQUIRE(receiver.receive(s_timeout).data == make_message(ii % 3000, static_cast<uint8_t>(ii)));
+  }
+  int status = -1;
+  waitpid(pid, &status, 0);
+  BOOST_REQUIRE(WIFEXITED(status));
+  BOOST_REQUIRE_EQUAL(WEXITSTATUS(status), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()